@@ -15,8 +15,10 @@ namespace modelMethod{
  * @brief Constructor
  */
 Method::Method(ConstructionData const*mcd){
-  modelData.load(mcd->modelFile);
+  modelData.load(mcd->modelFile,mcd->loadOptions);
   model = modelData.getModel();
+  buildScene(scene,model);
+  drawSettings = mcd->drawSettings;
 }
 
 
@@ -29,9 +31,11 @@ Method::Method(ConstructionData const*mcd){
  * @param camera camera position
  */
 void Method::onDraw(Frame&frame,glm::mat4 const&proj,glm::mat4 const&view,glm::vec3 const&light,glm::vec3 const&camera){
+  modelData.updateTextures(model); // textures decoded in background since the last frame
+  modelData.streamTextures(model,scene.textureLevels); // levels requested by the previous frame
   ctx.frame = frame;
   clear(ctx,.5,.5,1,0);
-  drawModel(ctx,model,proj,view,light,camera);
+  drawScene(ctx,model,scene,proj,view,light,camera,drawSettings);
 }
 
 /**
@@ -9,13 +9,17 @@
 
 #include <framework/method.hpp>
 #include <framework/model.hpp>
+#include <student/scene.hpp>
+#include <student/drawModel.hpp>
 
 namespace modelMethod{
 
 class ConstructionData: public MethodConstructionData{
   public:
-    ConstructionData(std::string const&modelFile):modelFile(modelFile){}
-    std::string modelFile;
+    ConstructionData(std::string const&modelFile,DrawSettings const&drawSettings = DrawSettings{},ModelLoadOptions const&loadOptions = ModelLoadOptions{}):modelFile(modelFile),drawSettings(drawSettings),loadOptions(loadOptions){}
+    std::string      modelFile;
+    DrawSettings     drawSettings;///< optional stages of model rendering
+    ModelLoadOptions loadOptions ;///< optional processing of loaded model
 };
 
 /**
@@ -29,6 +33,8 @@ class Method: public ::Method{
     virtual void onDraw(Frame&frame,glm::mat4 const&proj,glm::mat4 const&view,glm::vec3 const&light,glm::vec3 const&camera) override;
     ModelData modelData;
     Model     model;
+    Scene     scene;///< flattened node tree of model
+    DrawSettings drawSettings;///< optional stages of model rendering
     GPUContext ctx;///< gpu context
 };
 
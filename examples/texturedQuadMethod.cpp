@@ -53,7 +53,9 @@ Method::Method(ConstructionData const*cd){
   ctx.prg.vertexShader   = vertexShader  ; 
   ctx.prg.fragmentShader = fragmentShader;
   ctx.prg.vs2fs[0]       = AttributeType::VEC2;//tex coords
-  tex = loadTexture(cd->imageFile);
+  TextureLoadOptions options;
+  options.expandToRGBA = true; // 4 byte aligned texels
+  tex = loadTexture(cd->imageFile,options);
   ctx.prg.uniforms.textures[0] = tex.getTexture();
 }
 
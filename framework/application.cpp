@@ -7,20 +7,7 @@
 
 #include <assert.h>
 #include <framework/application.hpp>
-
-void defaultSceneParameters(
-    basicCamera::OrbitCamera&orbit,
-    basicCamera::PerspectiveCamera&proj,
-    glm::vec3&light,
-    uint32_t w,uint32_t h){
-  orbit.addDistance(35.f);
-  orbit.addYAngle(glm::radians(-20.f));
-  proj.setNear(0.1f);
-  proj.setFar(glm::half_pi<float>());
-  auto const aspect = static_cast<float>(w) / static_cast<float>(h);
-  proj.setAspect(aspect);
-  light  = glm::vec3(100.f,100.f,100.f);
-}
+#include <framework/trace.hpp>
 
 /**
  * @brief Constructor
@@ -34,13 +21,17 @@ Application::Application(int32_t width,int32_t height):Window(width,height,"izgP
   setCallback      (SDL_MOUSEMOTION        ,[&](SDL_Event const&event){mouseMotion(event);});
   setCallback      (SDL_KEYDOWN            ,[&](SDL_Event const&event){keyDown    (event);});
   defaultSceneParameters(orbitCamera,perspectiveCamera,light,width,height);
+  presentThread.add([]{setTraceThreadName("present");});
   timer.reset();
 }
 
 /**
- * @brief Destructor
+ * @brief Destructor, reports distribution of frame times
  */
-Application::~Application(){}
+Application::~Application(){
+  presentThread.wait();
+  frameTimes.report(std::cerr,"frame time");
+}
 
     
 /**
@@ -61,16 +52,32 @@ void Application::setMethod(uint32_t m){
   selectedMethod = m;
 }
 
+/**
+ * @brief This function enables or disables pipelined present.
+ * Pipelined present shows frames with one frame of latency,
+ * but copying of the previous frame into the window overlaps with rendering.
+ *
+ * @param pipelined present previous frame on present thread during rendering
+ */
+void Application::setPipelinedPresent(bool pipelined){
+  this->pipelined = pipelined;
+  pending = nullptr;
+}
+
 void Application::createMethodIfItDoesNotExist(){
   if(method)return;
   method = methodFactories[selectedMethod](&*methodConstructData[selectedMethod]);
   int w,h;
   SDL_GetWindowSize(getWindow(),&w,&h);
-  framebuffer = std::make_shared<Framebuffer>(w,h);
+  for(auto&fb:framebuffers)
+    fb = std::make_shared<Framebuffer>(w,h);
+  pending = nullptr;
   SDL_SetWindowTitle(getWindow(),methodName.at(selectedMethod).c_str());
 }
 
 void Application::idle(){
+  traceNextFrame();
+  IZG_TRACE_ZONE("frame");
   createMethodIfItDoesNotExist();
 
   method->onUpdate(timer.elapsedFromLast());
@@ -79,11 +86,60 @@ void Application::idle(){
   auto const view = orbitCamera      .getView      ();
   auto const camera = glm::vec3(glm::inverse(view)*glm::vec4(0.f,0.f,0.f,1.f));
 
-  auto frame = framebuffer->getFrame();
+  // previous frame is copied into the window surface while this one is rendered,
+  // surface is locked by main loop for the whole idle call, so present has to finish before return
+  auto const target = framebuffers[current];
+  if(pending)
+    presentThread.add([this,fb = pending]{swap(*fb);});
+
+  auto frame = target->getFrame();
+
+  {
+    IZG_TRACE_ZONE("onDraw");
+    Timer<float>drawTimer;
+    gpuCounters = GPUCounters{};
+    method->onDraw(frame,proj,view,light,camera);
+    if(showHud)drawHud(*target,drawTimer.elapsedFromStart());
+  }
 
-  method->onDraw(frame,proj,view,light,camera);
+  IZG_TRACE_ZONE("waitForPresent");
+  presentThread.wait();
+  if(!pending)swap(*target); // nothing to overlap with after start, resize or method change
+  if(pipelined){
+    pending = target;
+    current = (current+1)%2;
+  }
 
-  swap();
+  lastFrameTime = frameTimer.elapsedFromLast();
+  frameTimes.add(lastFrameTime);
+}
+
+/**
+ * @brief This function draws performance overlay over rendered frame.
+ * Frame time and thread utilization are measured in the previous frame,
+ * because this frame is presented before it ends.
+ *
+ * @param fb rendered framebuffer
+ * @param drawTime duration of onDraw
+ */
+void Application::drawHud(Framebuffer&fb,float drawTime){
+  IZG_TRACE_ZONE("drawHud");
+  double const presentNow = presentThread.getBusyTime();
+  double const poolNow    = presentPool  .getBusyTime();
+  HudSample sample;
+  sample.frameTime   = lastFrameTime;
+  sample.drawTime    = drawTime;
+  sample.triangles   = gpuCounters.triangles;
+  sample.fragments   = gpuCounters.fragments;
+  sample.poolThreads = presentPool.size();
+  if(lastFrameTime > 0.f){
+    sample.presentUtilization = std::min((float)(presentNow-presentBusy)/lastFrameTime,1.f);
+    sample.poolUtilization    = std::min((float)(poolNow-presentPoolBusy)/(lastFrameTime*(float)presentPool.size()),1.f);
+  }
+  presentBusy     = presentNow;
+  presentPoolBusy = poolNow;
+  hud.add(sample);
+  hud.draw(fb);
 }
 
 void Application::resize(SDL_Event const&event){
@@ -92,7 +148,9 @@ void Application::resize(SDL_Event const&event){
   auto const aspect = static_cast<float>(width) / static_cast<float>(height);
   perspectiveCamera.setAspect(aspect);
   if(method)
-    framebuffer->resize(event.window.data1,event.window.data2);
+    for(auto&fb:framebuffers)
+      fb->resize(event.window.data1,event.window.data2);
+  pending = nullptr; // content of resized framebuffer is lost
   reInitRenderer();
 }
 
@@ -145,40 +203,24 @@ void Application::quit      (uint32_t key){
   running = false;
 }
 
+void Application::toggleHud (uint32_t key){
+  if (key != SDLK_h)return;
+  showHud = !showHud;
+}
+
 void Application::keyDown(SDL_Event const&event){
   auto key = event.key.keysym.sym;
   nextMethod(key);
   prevMethod(key);
   quit      (key);
+  toggleHud (key);
 }
 
-void Application::swap(){
-  auto       frame = framebuffer->color.data();
-  auto const w     = framebuffer->width;
-  auto const h     = framebuffer->height; 
-
-  copyToSDLSurface(surface,frame,w,h);
-}
-
-void copyToSDLSurface(SDL_Surface*surface,uint8_t const*const frame,uint32_t width,uint32_t height){
-  uint32_t const bitsPerByte    = 8;
-  uint32_t const swizzleTable[] = {
-      surface->format->Rshift / bitsPerByte,
-      surface->format->Gshift / bitsPerByte,
-      surface->format->Bshift / bitsPerByte,
-  };
+void Application::swap(Framebuffer const&fb){
+  IZG_TRACE_ZONE("swap");
+  auto       frame = fb.color.data();
+  auto const w     = fb.width;
+  auto const h     = fb.height; 
 
-  uint8_t* const  pixels      = (uint8_t*)surface->pixels;
-  for (size_t y = 0; y < height; ++y) {
-    size_t const reversedY = height - y - 1;
-    for (size_t x = 0; x < width; ++x) {
-      auto const color    = frame + (y*width+x)*4;
-      auto const dstPixel = pixels + reversedY * surface->pitch + x * surface->format->BytesPerPixel;
-      for (uint32_t c = 0; c < 3; ++c)
-        dstPixel[swizzleTable[c]] = color[c];
-    }
-  }
+  copyToSDLSurface(surface,frame,w,h,&presentPool);
 }
-
-void drawTrianglesImpl(GPUContext&,uint32_t);
-void(*drawTriangles)(GPUContext&,uint32_t) = drawTrianglesImpl;
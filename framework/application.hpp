@@ -8,6 +8,7 @@
 #pragma once
 
 #include <memory>
+#include <thread>
 #include <vector>
 
 #include <BasicCamera/OrbitCamera.h>
@@ -15,8 +16,13 @@
 
 #include <student/gpu.hpp>
 #include <framework/framebuffer.hpp>
+#include <framework/offscreenRenderer.hpp>
 #include <framework/window.hpp>
+#include <framework/surface.hpp>
 #include <framework/method.hpp>
+#include <framework/frameTimes.hpp>
+#include <framework/hud.hpp>
+#include <framework/threadPool.hpp>
 #include <framework/timer.hpp>
 
 /**
@@ -30,6 +36,7 @@ class Application: protected Window{
     void registerMethod(std::string const&name,std::shared_ptr<MethodConstructionData>const&mcd = nullptr);
     void start();
     void setMethod(uint32_t m);
+    void setPipelinedPresent(bool pipelined);
   private:
     void idle();
     void resize(SDL_Event const&event);
@@ -41,8 +48,10 @@ class Application: protected Window{
     void nextMethod(uint32_t key);
     void prevMethod(uint32_t key);
     void quit      (uint32_t key);
+    void toggleHud (uint32_t key);
+    void drawHud(Framebuffer&fb,float drawTime);
     void createMethodIfItDoesNotExist();
-    void swap();
+    void swap(Framebuffer const&fb);
 
     using MethodFactory = std::function<std::shared_ptr<Method>(MethodConstructionData const*)>;
 
@@ -62,33 +71,22 @@ class Application: protected Window{
 
     Timer<float>                   timer                                        ;
 
-    std::shared_ptr<Framebuffer>framebuffer;///< framebuffer
-};
+    Timer<float>                   frameTimer                                   ;
+    FrameTimes                     frameTimes        = FrameTimes(1<<16)        ;///< the last frames, about 18 minutes at 60 fps
+    float                          lastFrameTime     = 0.f                      ;
 
-/**
- * @brief This function sets default scene parameters for rendering
- *
- * @param orbit output orbit camera
- * @param proj output projection camera
- * @param light output light position
- * @param width width of the window
- * @param height height of the window
- */
-void defaultSceneParameters(
-    basicCamera::OrbitCamera&orbit,
-    basicCamera::PerspectiveCamera&proj,
-    glm::vec3&light,
-    uint32_t width,uint32_t height);
+    Hud                            hud                                          ;
+    bool                           showHud           = false                    ;
+    double                         presentBusy       = 0.                       ;///< busy time of present thread at the end of the previous frame
+    double                         presentPoolBusy   = 0.                       ;///< busy time of present pool at the end of the previous frame
 
-/**
- * @brief This function swaps color buffer with SDL_Surface
- *
- * @param surface sdl surface
- * @param color color buffer (RGBA8UI)
- * @param width width of color buffer
- * @param height height of color buffer
- */
-void copyToSDLSurface(SDL_Surface*surface,uint8_t const*const color,uint32_t width,uint32_t height);
+    std::shared_ptr<Framebuffer>framebuffers[2];///< ring of framebuffers, one is rendered while the other one is presented
+    std::shared_ptr<Framebuffer>pending        ;///< framebuffer rendered in the previous frame that waits for present
+    uint32_t                    current = 0    ;///< framebuffer that is rendered in this frame
+    bool                        pipelined = std::thread::hardware_concurrency() > 1;///< present previous frame while the next one is rendered
+    ThreadPool                  presentPool    ;///< threads that copy rows of framebuffer into window surface
+    ThreadPool                  presentThread{1};///< thread that presents previous frame during rendering
+};
 
 /**
  * @brief This method registers new rendering method into applicaion
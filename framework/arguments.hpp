@@ -8,6 +8,10 @@
 #pragma once
 
 #include <ArgumentViewer/ArgumentViewer.h>
+#include <framework/imageWriter.hpp>
+#include <framework/model.hpp>
+#include <student/drawModel.hpp>
+#include <tests/benchmark.hpp>
 #include <iostream>
 #include <string>
 
@@ -38,11 +42,48 @@ class Arguments{
       selectedTest        = args->geti32   ("--test"      ,-1,"run only this selected test");
       takeScreenShot      = args->isPresent("-s"          ,"takes screenshot of app");
       upToTest            = args->isPresent("--up-to-test","run all tests up to selected test by --test argument");
+      testJobs            = args->getu32   ("--test-jobs" ,0,"conformance scenarios run in this many worker processes, 0 = number of hardware threads");
       method              = args->getu32   ("--method"    ,0,"selects a rendering method");
+      syncPresent         = args->isPresent("--sync-present","presents frame before the next one is rendered (no pipelining, no frame of latency)");
       groundTruthFile     = args->gets     ("-g"          ,std::string(CMAKE_ROOT_DIR)+"/resources/images/output.png"                      ,"specify groundTruth image"    );
       modelFile           = args->gets     ("--model"     ,std::string(CMAKE_ROOT_DIR)+"/resources/models/china.glb"                       ,"model file in gltf/glb format");
       imageFile           = args->gets     ("--img"       ,std::string(CMAKE_ROOT_DIR)+"/resources/images/you_will_not_find_this_image.png","texture file for texturedQuadMethod"                 );
       perfTests           = args->getu32   ("-f"          ,10,"number of frames that are tests during performance tests");
+      perfCounters        = args->isPresent("--perf-counters","reports hardware counters (IPC, cache and branch misses, instructions per triangle and fragment) in performance tests, Linux only");
+      runBenchmark        = args->isPresent("--bench"     ,"runs benchmark scenarios (models x sizes x camera paths) and reports median/p95/stddev");
+      benchmark.models    = args->getsv    ("--bench-models",{},"benchmarked models: model files, bunny or sphere:N (procedural sphere with N segments), e.g. --bench-models { bunny a.glb }");
+      benchmark.sizes     = args->getsv    ("--bench-sizes" ,{},"benchmarked framebuffer sizes, e.g. --bench-sizes { 256x256 3840x2160 }");
+      benchmark.paths     = args->getsv    ("--bench-paths" ,{},"camera paths: static, orbit, zoom");
+      benchmark.frames    = args->getu32   ("--bench-frames",20,"measured frames per scenario");
+      benchmark.warmup    = args->getu32   ("--bench-warmup",3 ,"frames rendered before measurement of each scenario");
+      benchmark.jsonFile  = args->gets     ("--bench-json"  ,"","stores benchmark results into JSON file");
+      traceFile           = args->gets     ("--trace"       ,"","records trace zones and stores the last frames into Chrome trace_event JSON file (chrome://tracing, ui.perfetto.dev)");
+      traceFrames         = args->getu32   ("--trace-frames",30,"number of the last frames stored by --trace, 0 stores all recorded zones");
+      batchFile           = args->gets     ("--batch"       ,"","renders all views of all models listed in JSON job file (see tests/batchRender.hpp)");
+      imageOptions.pngLevel   = args->geti32   ("--png-level"     ,8,"deflate level of written PNG images, 0 stores them uncompressed");
+      imageOptions.pngFilters = !args->isPresent("--png-no-filters","does not choose the best filter of PNG rows (faster, larger files)");
+      // lists given on command line replace defaults instead of overwriting their first items
+      if(benchmark.models.empty())benchmark.models = {"bunny","sphere:256","sphere:1024",modelFile};
+      if(benchmark.sizes .empty())benchmark.sizes  = {"256x256","512x512","1920x1080","3840x2160"};
+      if(benchmark.paths .empty())benchmark.paths  = {"static","orbit","zoom"};
+      drawSettings.sortDrawCalls    = args->isPresent("--sort-draws"       ,"sorts draw calls of model loader by texture and front-to-back depth");
+      drawSettings.frustumCulling   = args->isPresent("--frustum-culling"  ,"skips meshes of model loader outside of view frustum");
+      drawSettings.occlusionCulling = args->isPresent("--occlusion-culling","skips meshes of model loader hidden behind large meshes");
+      drawSettings.lodSelection     = args->isPresent("--lods"             ,"generates simplified levels of detail of model meshes and draws them for distant meshes");
+      drawSettings.lodErrorThreshold= args->getf32   ("--lod-error"        ,1.f,"maximal projected error of selected level of detail in pixels");
+      drawSettings.meshletCulling   = args->isPresent("--meshlets"         ,"splits model meshes into meshlets and skips invisible meshlets");
+      loadOptions.parallelImages    = args->isPresent("--parallel-images"  ,"decodes model images on thread pool and reports load phases");
+      loadOptions.lazyImages        = args->isPresent("--lazy-images"      ,"decodes model images in background, model is drawn untextured until they are ready");
+      loadOptions.loaderThreads     = args->getu32   ("--loader-threads"   ,0,"number of image decoding threads (0 = number of hardware threads)");
+      loadOptions.mapFile           = args->isPresent("--mmap"             ,"maps .glb model into memory and draws geometry directly from the mapping");
+      loadOptions.sceneCache        = args->isPresent("--scene-cache"      ,"loads preprocessed model from .izgscene cache, creates the cache on the first run");
+      loadOptions.compressTextures  = args->isPresent("--compress-textures","stores model textures as BC1/BC3 blocks that are decoded when sampled");
+      loadOptions.textureBudget     = (size_t)args->getu32("--texture-budget",0,"streams texture mip levels under given budget in MB (0 = no streaming)")<<20;
+      drawSettings.textureStreaming = loadOptions.textureBudget > 0;
+      loadOptions.parallelImages   |= loadOptions.lazyImages;
+      loadOptions.generateLods      = drawSettings.lodSelection;
+      loadOptions.buildMeshlets     = drawSettings.meshletCulling;
+      loadOptions.optimizeMeshes    = args->isPresent("--optimize-meshes"  ,"reorders model indices and vertices for vertex cache, overdraw and vertex fetch");
 
       auto printHelp  = args->isPresent("-h"    ,"prints help");
       printHelp |= args->isPresent("--help","prints help");
@@ -59,12 +100,23 @@ class Arguments{
   std::string modelFile       = "../tests/model.glb";///< models file
   std::string imageFile       = "../test/image.jpg";///< image file
   uint32_t method = 0;///< start with this method
+  bool syncPresent = false;///< do not overlap present with rendering of the next frame
   bool runPerformanceTests;///< should we run performance tests
+  bool runBenchmark;///< should we run benchmark
+  BenchmarkSettings benchmark;///< benchmark scenarios
+  std::string traceFile;///< Chrome trace of the last frames, empty = no tracing
+  uint32_t    traceFrames;///< number of frames stored in trace
+  std::string batchFile;///< job file of batch rendering, empty = no batch rendering
+  ImageWriterOptions imageOptions;///< encoding of screenshots and batch images
   bool runConformanceTests;///< sould we run conformance tests
   bool takeScreenShot;///< should we take a screnshot
   bool stop = false; ///< should we immediately stop
   uint32_t perfTests; ///< number of frames in performance tests
+  bool     perfCounters; ///< report hardware counters in performance tests
   int      selectedTest; ///< selected conformance test
   bool     upToTest; ///< run tests up to selected test
+  uint32_t testJobs; ///< worker processes of conformance tests, 0 = number of hardware threads
+  DrawSettings drawSettings; ///< optional stages of model rendering
+  ModelLoadOptions loadOptions; ///< optional processing of loaded model
 };
 
@@ -0,0 +1,126 @@
+/*!
+ * @file
+ * @brief This file contains collection of frame times with percentiles
+ *
+ * @author Martin Zmitko, xzmitk01@stud.fit.vutbr.cz
+ */
+
+#pragma once
+
+#include<algorithm>
+#include<cmath>
+#include<iomanip>
+#include<ostream>
+#include<string>
+#include<vector>
+
+/**
+ * @brief This class collects durations of frames and reports their distribution.
+ * With limited capacity only the last frames are kept in a ring, so long interactive sessions do not grow memory.
+ */
+class FrameTimes{
+  public:
+    /**
+     * @brief Constructor
+     *
+     * @param capacity maximal number of kept frames, 0 = unlimited
+     */
+    explicit FrameTimes(size_t capacity = 0):capacity(capacity){
+      times.reserve(capacity);
+    }
+    /**
+     * @brief This function adds duration of one frame.
+     * The oldest frame is overwritten when capacity is reached.
+     *
+     * @param seconds duration of frame
+     */
+    void add(float seconds){
+      ++added;
+      if(!capacity || times.size() < capacity){
+        times.push_back(seconds);
+        return;
+      }
+      times[next] = seconds;
+      next = (next+1)%capacity;
+    }
+    /**
+     * @brief This function returns number of kept frames.
+     *
+     * @return number of frames that statistics are computed from
+     */
+    size_t size()const{
+      return times.size();
+    }
+    /**
+     * @brief This function returns number of all added frames.
+     *
+     * @return number of added frames including overwritten ones
+     */
+    size_t total()const{
+      return added;
+    }
+    /**
+     * @brief This function returns mean duration.
+     *
+     * @return mean in seconds, 0 if there are no frames
+     */
+    float mean()const{
+      if(times.empty())return 0.f;
+      double sum = 0.;
+      for(auto const&t:times)sum += t;
+      return (float)(sum/times.size());
+    }
+    /**
+     * @brief This function returns standard deviation of durations.
+     *
+     * @return sample standard deviation in seconds, 0 if there are less than 2 frames
+     */
+    float stddev()const{
+      if(times.size() < 2)return 0.f;
+      double const m = mean();
+      double sum = 0.;
+      for(auto const&t:times)sum += (t-m)*(t-m);
+      return (float)std::sqrt(sum/(times.size()-1));
+    }
+    /**
+     * @brief This function returns durations of kept frames.
+     *
+     * @return durations in seconds in order of addition, rotated once capacity was reached
+     */
+    std::vector<float>const&getTimes()const{
+      return times;
+    }
+    /**
+     * @brief This function returns percentile of durations (nearest rank).
+     *
+     * @param p percentile in range [0,100]
+     *
+     * @return duration in seconds, 0 if there are no frames
+     */
+    float percentile(float p)const{
+      if(times.empty())return 0.f;
+      std::vector<float>sorted = times;
+      size_t const rank = std::min(sorted.size()-1,(size_t)(p/100.f*(float)sorted.size()));
+      std::nth_element(sorted.begin(),sorted.begin()+rank,sorted.end());
+      return sorted[rank];
+    }
+    /**
+     * @brief This function prints mean and 50th, 95th and 99th percentile in milliseconds.
+     *
+     * @param out output stream
+     * @param name what was measured
+     */
+    void report(std::ostream&out,std::string const&name)const{
+      if(times.empty())return;
+      out << name << ": " << added << " frames";
+      if(added > times.size())out << " (last " << times.size() << ")";
+      out << ", mean " << std::fixed << std::setprecision(2) << mean()*1000.f
+          << " ms, p50 " << percentile(50.f)*1000.f << " ms, p95 " << percentile(95.f)*1000.f
+          << " ms, p99 " << percentile(99.f)*1000.f << " ms" << std::endl;
+    }
+  protected:
+    std::vector<float>times       ;///< durations of frames in seconds
+    size_t            capacity = 0;///< maximal number of kept frames, 0 = unlimited
+    size_t            next     = 0;///< position in ring that is overwritten next
+    size_t            added    = 0;///< number of all added frames
+};
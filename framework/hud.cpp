@@ -0,0 +1,185 @@
+/*!
+ * @file
+ * @brief This file contains performance overlay drawn into framebuffer
+ *
+ * @author Martin Zmitko, xzmitk01@stud.fit.vutbr.cz
+ */
+
+#include <algorithm>
+#include <cstdio>
+
+#include <framework/hud.hpp>
+
+namespace hud{
+
+/**
+ * @brief 5x7 glyphs of characters ' ' to '_', one byte per row from top, bit 4 is the left column
+ */
+uint8_t const font[64][7] = {
+  {0x00,0x00,0x00,0x00,0x00,0x00,0x00},{0x04,0x04,0x04,0x04,0x04,0x00,0x04},{0x0A,0x0A,0x00,0x00,0x00,0x00,0x00},{0x0A,0x0A,0x1F,0x0A,0x1F,0x0A,0x0A},
+  {0x04,0x0F,0x14,0x0E,0x05,0x1E,0x04},{0x18,0x19,0x02,0x04,0x08,0x13,0x03},{0x0C,0x12,0x14,0x08,0x15,0x12,0x0D},{0x04,0x04,0x00,0x00,0x00,0x00,0x00},
+  {0x02,0x04,0x08,0x08,0x08,0x04,0x02},{0x08,0x04,0x02,0x02,0x02,0x04,0x08},{0x00,0x04,0x15,0x0E,0x15,0x04,0x00},{0x00,0x04,0x04,0x1F,0x04,0x04,0x00},
+  {0x00,0x00,0x00,0x00,0x0C,0x04,0x08},{0x00,0x00,0x00,0x1F,0x00,0x00,0x00},{0x00,0x00,0x00,0x00,0x00,0x0C,0x0C},{0x00,0x01,0x02,0x04,0x08,0x10,0x00},
+  {0x0E,0x11,0x13,0x15,0x19,0x11,0x0E},{0x04,0x0C,0x04,0x04,0x04,0x04,0x0E},{0x0E,0x11,0x01,0x02,0x04,0x08,0x1F},{0x1F,0x02,0x04,0x02,0x01,0x11,0x0E},
+  {0x02,0x06,0x0A,0x12,0x1F,0x02,0x02},{0x1F,0x10,0x1E,0x01,0x01,0x11,0x0E},{0x06,0x08,0x10,0x1E,0x11,0x11,0x0E},{0x1F,0x01,0x02,0x04,0x08,0x08,0x08},
+  {0x0E,0x11,0x11,0x0E,0x11,0x11,0x0E},{0x0E,0x11,0x11,0x0F,0x01,0x02,0x0C},{0x00,0x0C,0x0C,0x00,0x0C,0x0C,0x00},{0x00,0x0C,0x0C,0x00,0x0C,0x04,0x08},
+  {0x02,0x04,0x08,0x10,0x08,0x04,0x02},{0x00,0x00,0x1F,0x00,0x1F,0x00,0x00},{0x08,0x04,0x02,0x01,0x02,0x04,0x08},{0x0E,0x11,0x01,0x02,0x04,0x00,0x04},
+  {0x0E,0x11,0x01,0x0D,0x15,0x15,0x0E},{0x0E,0x11,0x11,0x11,0x1F,0x11,0x11},{0x1E,0x11,0x11,0x1E,0x11,0x11,0x1E},{0x0E,0x11,0x10,0x10,0x10,0x11,0x0E},
+  {0x1C,0x12,0x11,0x11,0x11,0x12,0x1C},{0x1F,0x10,0x10,0x1E,0x10,0x10,0x1F},{0x1F,0x10,0x10,0x1E,0x10,0x10,0x10},{0x0E,0x11,0x10,0x17,0x11,0x11,0x0F},
+  {0x11,0x11,0x11,0x1F,0x11,0x11,0x11},{0x0E,0x04,0x04,0x04,0x04,0x04,0x0E},{0x07,0x02,0x02,0x02,0x02,0x12,0x0C},{0x11,0x12,0x14,0x18,0x14,0x12,0x11},
+  {0x10,0x10,0x10,0x10,0x10,0x10,0x1F},{0x11,0x1B,0x15,0x15,0x11,0x11,0x11},{0x11,0x11,0x19,0x15,0x13,0x11,0x11},{0x0E,0x11,0x11,0x11,0x11,0x11,0x0E},
+  {0x1E,0x11,0x11,0x1E,0x10,0x10,0x10},{0x0E,0x11,0x11,0x11,0x15,0x12,0x0D},{0x1E,0x11,0x11,0x1E,0x14,0x12,0x11},{0x0F,0x10,0x10,0x0E,0x01,0x01,0x1E},
+  {0x1F,0x04,0x04,0x04,0x04,0x04,0x04},{0x11,0x11,0x11,0x11,0x11,0x11,0x0E},{0x11,0x11,0x11,0x11,0x11,0x0A,0x04},{0x11,0x11,0x11,0x15,0x15,0x15,0x0A},
+  {0x11,0x11,0x0A,0x04,0x0A,0x11,0x11},{0x11,0x11,0x11,0x0A,0x04,0x04,0x04},{0x1F,0x01,0x02,0x04,0x08,0x10,0x1F},{0x0E,0x08,0x08,0x08,0x08,0x08,0x0E},
+  {0x00,0x10,0x08,0x04,0x02,0x01,0x00},{0x0E,0x02,0x02,0x02,0x02,0x02,0x0E},{0x04,0x0A,0x11,0x00,0x00,0x00,0x00},{0x00,0x00,0x00,0x00,0x00,0x00,0x1F},
+};
+
+int32_t const glyphWidth  = 6;///< advance of character in pixels
+int32_t const glyphHeight = 9;///< advance of line in pixels
+
+/**
+ * @brief This function writes pixel, y goes from the top of framebuffer (framebuffer rows go from the bottom).
+ *
+ * @param color 0xRRGGBB
+ */
+void putPixel(Framebuffer&fb,int32_t x,int32_t y,uint32_t color){
+  if(x < 0 || y < 0 || x >= (int32_t)fb.width || y >= (int32_t)fb.height)return;
+  uint8_t*p = fb.color.data()+((size_t)(fb.height-1-y)*fb.width+x)*4;
+  p[0] = (uint8_t)(color>>16);
+  p[1] = (uint8_t)(color>> 8);
+  p[2] = (uint8_t)(color    );
+}
+
+void fillRect(Framebuffer&fb,int32_t x,int32_t y,int32_t w,int32_t h,uint32_t color){
+  for(int32_t j=y;j<y+h;++j)
+    for(int32_t i=x;i<x+w;++i)putPixel(fb,i,j,color);
+}
+
+/**
+ * @brief This function darkens rectangle, so that overlay is readable over any scene.
+ */
+void darkenRect(Framebuffer&fb,int32_t x,int32_t y,int32_t w,int32_t h){
+  int32_t const x0 = std::max(x,0),x1 = std::min(x+w,(int32_t)fb.width);
+  int32_t const y0 = std::max(y,0),y1 = std::min(y+h,(int32_t)fb.height);
+  for(int32_t j=y0;j<y1;++j){
+    uint8_t*p = fb.color.data()+((size_t)(fb.height-1-j)*fb.width+x0)*4;
+    for(int32_t i=x0;i<x1;++i,p+=4)
+      for(int c=0;c<3;++c)p[c] = (uint8_t)(p[c]*3/8);
+  }
+}
+
+std::string formatCount(uint64_t n){
+  char buffer[32];
+  if(n >= 10000000)std::snprintf(buffer,sizeof(buffer),"%.1fM",(double)n*1e-6);
+  else if(n >= 1000000)std::snprintf(buffer,sizeof(buffer),"%.2fM",(double)n*1e-6);
+  else if(n >= 10000)std::snprintf(buffer,sizeof(buffer),"%.1fK",(double)n*1e-3);
+  else std::snprintf(buffer,sizeof(buffer),"%llu",(unsigned long long)n);
+  return buffer;
+}
+
+uint32_t frameColor(float seconds){
+  if(seconds <= 1.f/60.f)return 0x40e040;
+  if(seconds <= 1.f/30.f)return 0xe0e040;
+  return 0xe04040;
+}
+
+}
+
+using namespace hud;
+
+/**
+ * @brief This function draws text with built-in 5x7 font, lower case letters are drawn as upper case.
+ *
+ * @param fb framebuffer
+ * @param x left edge in pixels
+ * @param y top edge in pixels (from the top of framebuffer)
+ * @param text text
+ * @param color 0xRRGGBB
+ * @param scale size of font pixel
+ */
+void drawHudText(Framebuffer&fb,int32_t x,int32_t y,std::string const&text,uint32_t color,int32_t scale){
+  for(char c:text){
+    if(c >= 'a' && c <= 'z')c = (char)(c-'a'+'A');
+    if(c < ' ' || c > '_')c = '?';
+    auto const&glyph = font[c-' '];
+    for(int32_t row=0;row<7;++row)
+      for(int32_t col=0;col<5;++col)
+        if(glyph[row]>>(4-col)&1)fillRect(fb,x+col*scale,y+row*scale,scale,scale,color);
+    x += glyphWidth*scale;
+  }
+}
+
+/**
+ * @brief This function adds measurements of frame into history.
+ *
+ * @param sample measurements
+ */
+void Hud::add(HudSample const&sample){
+  if(history.size() < historySize){
+    history.push_back(sample);
+    next = history.size()%historySize;
+    return;
+  }
+  history[next] = sample;
+  next = (next+1)%historySize;
+}
+
+/**
+ * @brief This function draws overlay into the top left corner of framebuffer.
+ *
+ * @param fb framebuffer
+ */
+void Hud::draw(Framebuffer&fb)const{
+  if(history.empty())return;
+  int32_t const scale = fb.width >= 1200 ? 2 : 1;
+  auto const&last = history[(next+history.size()-1)%history.size()];
+
+  std::vector<float>times;
+  float mean = 0.f;
+  for(auto const&s:history){
+    times.push_back(s.frameTime);
+    mean += s.frameTime;
+  }
+  mean /= (float)times.size();
+  std::sort(times.begin(),times.end());
+  float const p95 = times[std::min(times.size()-1,times.size()*95/100)];
+
+  char buffer[4][64];
+  std::snprintf(buffer[0],sizeof(buffer[0]),"FRAME %6.1f MS %6.1f FPS",last.frameTime*1e3f,last.frameTime > 0.f ? 1.f/last.frameTime : 0.f);
+  std::snprintf(buffer[1],sizeof(buffer[1]),"AVG   %6.1f MS P95 %5.1f",mean*1e3f,p95*1e3f);
+  std::snprintf(buffer[2],sizeof(buffer[2]),"DRAW %3.0f%% PRESENT %3.0f%%",last.frameTime > 0.f ? 100.f*last.drawTime/last.frameTime : 0.f,100.f*last.presentUtilization);
+  std::snprintf(buffer[3],sizeof(buffer[3]),"COPY %3.0f%% OF %u THREADS",100.f*last.poolUtilization,last.poolThreads);
+  std::vector<std::string>lines = {
+    buffer[0],buffer[1],
+    "TRIS "+formatCount(last.triangles)+" FRAGS "+formatCount(last.fragments),
+    buffer[2],buffer[3],
+  };
+
+  int32_t const margin = 4*scale;
+  int32_t const graphHeight = 40*scale;
+  size_t columns = 0;
+  for(auto const&l:lines)columns = std::max(columns,l.size());
+  int32_t const width  = std::max((int32_t)columns*glyphWidth*scale,(int32_t)historySize*scale)+2*margin;
+  int32_t const height = (int32_t)lines.size()*glyphHeight*scale+graphHeight+3*margin;
+  darkenRect(fb,0,0,width,height);
+
+  for(size_t i=0;i<lines.size();++i)
+    drawHudText(fb,margin,margin+(int32_t)i*glyphHeight*scale,lines[i],i == 0 ? frameColor(last.frameTime) : 0xffffff,scale);
+
+  // bars of frame times from the oldest to the newest, lower part of bar is time of onDraw
+  int32_t const graphTop = height-margin-graphHeight;
+  float const range = std::max(times.back(),1.f/30.f);
+  for(size_t i=0;i<history.size();++i){
+    auto const&s = history[(next+i)%history.size()];
+    int32_t const frameHeight = std::min((int32_t)(s.frameTime/range*graphHeight+.5f),graphHeight);
+    int32_t const drawHeight  = std::min((int32_t)(s.drawTime /range*graphHeight+.5f),frameHeight);
+    int32_t const x = margin+(int32_t)i*scale;
+    uint32_t const color = frameColor(s.frameTime);
+    fillRect(fb,x,graphTop+graphHeight-frameHeight,scale,frameHeight-drawHeight,color);
+    fillRect(fb,x,graphTop+graphHeight-drawHeight ,scale,drawHeight            ,(color>>1)&0x7f7f7f);
+  }
+  for(float target:{1.f/60.f,1.f/30.f}){
+    int32_t const y = graphTop+graphHeight-(int32_t)(target/range*graphHeight+.5f);
+    for(int32_t x=margin;x<margin+(int32_t)historySize*scale;x+=2*scale)fillRect(fb,x,y,scale,scale,0xa0a0a0);
+  }
+}
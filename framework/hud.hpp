@@ -0,0 +1,44 @@
+/*!
+ * @file
+ * @brief This file contains performance overlay drawn into framebuffer
+ *
+ * @author Martin Zmitko, xzmitk01@stud.fit.vutbr.cz
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <framework/framebuffer.hpp>
+
+//! [HudSample]
+/**
+ * @brief This struct holds measurements of one frame shown by overlay
+ */
+struct HudSample{
+  float    frameTime          = 0.f;///< duration of frame in seconds
+  float    drawTime           = 0.f;///< duration of onDraw in seconds
+  uint64_t triangles          = 0  ;///< triangles sent to drawTriangles
+  uint64_t fragments          = 0  ;///< rasterized fragments
+  float    presentUtilization = 0.f;///< busy part of present thread
+  float    poolUtilization    = 0.f;///< busy part of threads that copy rows into window
+  uint32_t poolThreads        = 0  ;///< number of threads that copy rows into window
+};
+//! [HudSample]
+
+/**
+ * @brief This class keeps history of frames and draws it as text and graph with built-in 5x7 bitmap font
+ */
+class Hud{
+  public:
+    void add(HudSample const&sample);
+    void draw(Framebuffer&fb)const;
+  protected:
+    static uint32_t const historySize = 120;///< number of frames in graph
+    std::vector<HudSample>history   ;///< ring of the last frames
+    size_t                next   = 0;///< position of the next frame in ring
+};
+
+void drawHudText(Framebuffer&fb,int32_t x,int32_t y,std::string const&text,uint32_t color,int32_t scale = 1);
@@ -0,0 +1,300 @@
+/*!
+ * @file
+ * @brief This file contains comparison of images (MSE, PSNR, SSIM, per tile error map and heatmap)
+ *
+ * @author Martin Zmitko, xzmitk01@stud.fit.vutbr.cz
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <thread>
+
+#include <framework/imageDiff.hpp>
+#include <framework/imageWriter.hpp>
+#include <framework/threadPool.hpp>
+
+#include <glm/glm.hpp>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+/**
+ * @brief This function returns sum of squared differences of masked bytes.
+ *
+ * @param a the first row segment
+ * @param b the second row segment
+ * @param n number of bytes
+ * @param mask mask of compared bytes, repeats every 4 bytes (channel 3 of RGBA can be excluded)
+ *
+ * @return sum of squared differences
+ */
+uint64_t squaredErrorBytes(uint8_t const*a,uint8_t const*b,size_t n,uint8_t const*mask){
+  uint64_t sum = 0;
+  size_t i = 0;
+#ifdef __SSE2__
+  __m128i const m    = _mm_loadu_si128((__m128i const*)mask);
+  __m128i const zero = _mm_setzero_si128();
+  while(i+16 <= n){
+    // 32 bit lanes cannot overflow within 4096 bytes
+    size_t const end = std::min(n&~(size_t)15,i+4096);
+    __m128i acc = _mm_setzero_si128();
+    for(;i<end;i+=16){
+      __m128i const va = _mm_and_si128(_mm_loadu_si128((__m128i const*)(a+i)),m);
+      __m128i const vb = _mm_and_si128(_mm_loadu_si128((__m128i const*)(b+i)),m);
+      __m128i const lo = _mm_sub_epi16(_mm_unpacklo_epi8(va,zero),_mm_unpacklo_epi8(vb,zero));
+      __m128i const hi = _mm_sub_epi16(_mm_unpackhi_epi8(va,zero),_mm_unpackhi_epi8(vb,zero));
+      acc = _mm_add_epi32(acc,_mm_add_epi32(_mm_madd_epi16(lo,lo),_mm_madd_epi16(hi,hi)));
+    }
+    uint32_t lanes[4];
+    _mm_storeu_si128((__m128i*)lanes,acc);
+    sum += (uint64_t)lanes[0]+lanes[1]+lanes[2]+lanes[3];
+  }
+#endif
+  for(;i<n;++i){
+    int32_t const d = mask[i&15] ? (int32_t)a[i]-(int32_t)b[i] : 0;
+    sum += (uint64_t)(d*d);
+  }
+  return sum;
+}
+
+/**
+ * @brief This function returns sum of squared differences of compared channels of pixels.
+ *
+ * @param a the first row segment
+ * @param b the second row segment
+ * @param pixels number of pixels
+ * @param channelsA channels of the first image
+ * @param channelsB channels of the second image
+ * @param compared number of compared channels
+ *
+ * @return sum of squared differences
+ */
+uint64_t squaredErrorPixels(uint8_t const*a,uint8_t const*b,uint32_t pixels,uint32_t channelsA,uint32_t channelsB,uint32_t compared){
+  if(channelsA == channelsB && (compared >= channelsA || channelsA == 4)){
+    uint8_t mask[16];
+    for(uint32_t i=0;i<16;++i)mask[i] = i%channelsA < compared ? 0xff : 0x00;
+    if(channelsA != 4)std::memset(mask,0xff,sizeof(mask));
+    return squaredErrorBytes(a,b,(size_t)pixels*channelsA,mask);
+  }
+  uint64_t sum = 0;
+  for(uint32_t x=0;x<pixels;++x)
+    for(uint32_t c=0;c<compared;++c){
+      int32_t const d = (int32_t)a[x*channelsA+c]-(int32_t)b[x*channelsB+c];
+      sum += (uint64_t)(d*d);
+    }
+  return sum;
+}
+
+bool pixelDiffers(uint8_t const*a,uint8_t const*b,uint32_t compared){
+  for(uint32_t c=0;c<compared;++c)
+    if(a[c] != b[c])return true;
+  return false;
+}
+
+/**
+ * @brief This function converts image to luminance.
+ *
+ * @param t image
+ * @param firstRow the first converted row
+ * @param endRow row after the last converted row
+ * @param out luminance of whole image
+ */
+void luminance(Texture const&t,uint32_t firstRow,uint32_t endRow,float*out){
+  for(uint32_t y=firstRow;y<endRow;++y)
+    for(uint32_t x=0;x<t.width;++x){
+      uint8_t const*p = t.data+((size_t)y*t.width+x)*t.channels;
+      out[(size_t)y*t.width+x] = t.channels < 3 ? (float)p[0] : .299f*p[0]+.587f*p[1]+.114f*p[2];
+    }
+}
+
+/**
+ * @brief This function returns sum of SSIM of 8x8 windows (stride 4) whose top row is in given range.
+ *
+ * @param la luminance of the first image
+ * @param lb luminance of the second image
+ * @param width width of images
+ * @param firstRow the first row of windows
+ * @param endRow end of range of rows of windows
+ * @param windows output number of windows
+ *
+ * @return sum of SSIM
+ */
+double ssimWindows(float const*la,float const*lb,uint32_t width,uint32_t firstRow,uint32_t endRow,size_t&windows){
+  double const c1 = (.01*255.)*(.01*255.),c2 = (.03*255.)*(.03*255.);
+  double sum = 0.;
+  windows = 0;
+  for(uint32_t y=firstRow;y<endRow;y+=4)
+    for(uint32_t x=0;x+8<=width;x+=4){
+      double sa = 0.,sb = 0.,saa = 0.,sbb = 0.,sab = 0.;
+      for(uint32_t j=0;j<8;++j){
+        float const*ra = la+(size_t)(y+j)*width+x;
+        float const*rb = lb+(size_t)(y+j)*width+x;
+        for(uint32_t i=0;i<8;++i){
+          sa  += ra[i];      sb  += rb[i];
+          saa += ra[i]*ra[i];sbb += rb[i]*rb[i];sab += ra[i]*rb[i];
+        }
+      }
+      double const ma = sa/64.,mb = sb/64.;
+      double const va = saa/64.-ma*ma,vb = sbb/64.-mb*mb,cov = sab/64.-ma*mb;
+      sum += (2.*ma*mb+c1)*(2.*cov+c2)/((ma*ma+mb*mb+c1)*(va+vb+c2));
+      ++windows;
+    }
+  return sum;
+}
+
+/**
+ * @brief This function compares two images of the same size.
+ * Bands of tile rows are compared on threads, squared differences use SSE2 when available.
+ *
+ * @param a the first image (raw texture, e.g. color buffer with 4 channels)
+ * @param b the second image
+ * @param options settings
+ *
+ * @return result, empty error map if images do not have the same size
+ */
+ImageDiff compareImages(Texture const&a,Texture const&b,ImageDiffOptions const&options){
+  ImageDiff res;
+  if(!a.data || !b.data || a.width != b.width || a.height != b.height || !a.width || !a.height){
+    res.mse  = std::numeric_limits<double>::infinity();
+    res.ssim = 0.;
+    return res;
+  }
+  uint32_t const width = a.width,height = a.height;
+  uint32_t const compared = std::max(std::min({options.channels,a.channels,b.channels}),1u);
+  res.tileSize = std::max(options.tileSize,1u);
+  res.tilesX   = (width +res.tileSize-1)/res.tileSize;
+  res.tilesY   = (height+res.tileSize-1)/res.tileSize;
+  res.tileMse.assign((size_t)res.tilesX*res.tilesY,0.f);
+
+  std::vector<uint64_t>tileError(res.tileMse.size(),0);
+  std::vector<size_t  >tileDifferent(res.tileMse.size(),0);
+  auto const compareTileRow = [&](uint32_t ty){
+    for(uint32_t y=ty*res.tileSize;y<std::min((ty+1)*res.tileSize,height);++y){
+      uint8_t const*ra = a.data+(size_t)y*width*a.channels;
+      uint8_t const*rb = b.data+(size_t)y*width*b.channels;
+      for(uint32_t tx=0;tx<res.tilesX;++tx){
+        uint32_t const x0 = tx*res.tileSize,x1 = std::min(x0+res.tileSize,width);
+        uint64_t const e = squaredErrorPixels(ra+x0*a.channels,rb+x0*b.channels,x1-x0,a.channels,b.channels,compared);
+        if(!e)continue;
+        tileError[(size_t)ty*res.tilesX+tx] += e;
+        for(uint32_t x=x0;x<x1;++x)
+          tileDifferent[(size_t)ty*res.tilesX+tx] += pixelDiffers(ra+x*a.channels,rb+x*b.channels,compared);
+      }
+    }
+  };
+
+  std::vector<float>la,lb;
+  double ssimSum = 0.;
+  size_t ssimWindowCount = 0;
+  if(options.ssim && width >= 8 && height >= 8){
+    la.resize((size_t)width*height);
+    lb.resize((size_t)width*height);
+  }
+  uint32_t const windowRows = height >= 8 ? (height-8)/4+1 : 0;
+
+  uint32_t const parallelPixels = 1<<18;
+  uint32_t const nofThreads = options.threads ? options.threads : std::max(std::thread::hardware_concurrency(),1u);
+  if(nofThreads < 2 || (size_t)width*height < parallelPixels){
+    for(uint32_t ty=0;ty<res.tilesY;++ty)compareTileRow(ty);
+    if(!la.empty()){
+      luminance(a,0,height,la.data());
+      luminance(b,0,height,lb.data());
+      ssimSum = ssimWindows(la.data(),lb.data(),width,0,windowRows*4,ssimWindowCount);
+    }
+  }else{
+    ThreadPool pool(nofThreads);
+    for(uint32_t ty=0;ty<res.tilesY;++ty)
+      pool.add([&,ty]{compareTileRow(ty);});
+    if(!la.empty()){
+      uint32_t const rows = (height+nofThreads-1)/nofThreads;
+      for(uint32_t y=0;y<height;y+=rows)
+        pool.add([&,y]{
+          luminance(a,y,std::min(y+rows,height),la.data());
+          luminance(b,y,std::min(y+rows,height),lb.data());
+        });
+      pool.wait();
+      uint32_t const bands = std::min(nofThreads*4,std::max(windowRows,1u));
+      uint32_t const bandRows = (windowRows+bands-1)/bands;
+      std::vector<double>sums(bands,0.);
+      std::vector<size_t>counts(bands,0);
+      for(uint32_t i=0;i<bands;++i)
+        pool.add([&,i]{
+          uint32_t const first = i*bandRows*4,end = std::min((i+1)*bandRows,windowRows)*4;
+          if(first < end)sums[i] = ssimWindows(la.data(),lb.data(),width,first,end,counts[i]);
+        });
+      pool.wait();
+      for(uint32_t i=0;i<bands;++i){
+        ssimSum         += sums  [i];
+        ssimWindowCount += counts[i];
+      }
+    }
+    pool.wait();
+  }
+
+  uint64_t totalError = 0;
+  for(size_t t=0;t<tileError.size();++t){
+    uint32_t const tx = (uint32_t)(t%res.tilesX),ty = (uint32_t)(t/res.tilesX);
+    size_t const pixels = (size_t)(std::min((tx+1)*res.tileSize,width)-tx*res.tileSize)*(std::min((ty+1)*res.tileSize,height)-ty*res.tileSize);
+    res.tileMse[t] = (float)((double)tileError[t]/(double)(pixels*compared));
+    if(res.tileMse[t] > res.tileMse[res.worstTile])res.worstTile = (uint32_t)t;
+    totalError          += tileError[t];
+    res.differentPixels += tileDifferent[t];
+  }
+  res.mse  = (double)totalError/((double)width*height*compared);
+  res.psnr = res.mse > 0. ? 10.*std::log10(255.*255./res.mse) : std::numeric_limits<double>::infinity();
+  res.ssim = ssimWindowCount ? ssimSum/(double)ssimWindowCount : 1.;
+  return res;
+}
+
+/**
+ * @brief This function writes heatmap of differences.
+ * Dimmed luminance of the first image is overlaid by error of pixels (red -> yellow -> white),
+ * the tile with the largest error is outlined in cyan.
+ *
+ * @param file output file (format by extension, see ImageWriter)
+ * @param a the first image
+ * @param b the second image
+ * @param diff result of compareImages
+ * @param options settings used by compareImages
+ *
+ * @return true if heatmap was written
+ */
+bool writeDiffHeatmap(std::string const&file,Texture const&a,Texture const&b,ImageDiff const&diff,ImageDiffOptions const&options){
+  if(!a.data || !b.data || a.width != b.width || a.height != b.height || !diff.tilesX)return false;
+  uint32_t const width = a.width,height = a.height;
+  uint32_t const compared = std::max(std::min({options.channels,a.channels,b.channels}),1u);
+  std::vector<uint8_t>rgba((size_t)width*height*4);
+  for(uint32_t y=0;y<height;++y)
+    for(uint32_t x=0;x<width;++x){
+      uint8_t const*pa = a.data+((size_t)y*width+x)*a.channels;
+      uint8_t const*pb = b.data+((size_t)y*width+x)*b.channels;
+      int32_t error = 0;
+      for(uint32_t c=0;c<compared;++c)error = std::max(error,std::abs((int32_t)pa[c]-(int32_t)pb[c]));
+      float const gray = (a.channels < 3 ? pa[0] : .299f*pa[0]+.587f*pa[1]+.114f*pa[2])*.3f;
+      float const t = std::min(error/64.f,1.f); // errors of 64 and more are white
+      uint8_t*out = rgba.data()+((size_t)y*width+x)*4;
+      if(error){
+        out[0] = (uint8_t)(128.f+127.f*std::min(t*3.f,1.f));
+        out[1] = (uint8_t)(255.f*glm::clamp(t*3.f-1.f,0.f,1.f));
+        out[2] = (uint8_t)(255.f*glm::clamp(t*3.f-2.f,0.f,1.f));
+      }else{
+        out[0] = out[1] = out[2] = (uint8_t)gray;
+      }
+      out[3] = 255;
+    }
+  if(diff.tileMse[diff.worstTile] > 0.f){
+    uint32_t const x0 = diff.worstTile%diff.tilesX*diff.tileSize,y0 = diff.worstTile/diff.tilesX*diff.tileSize;
+    uint32_t const x1 = std::min(x0+diff.tileSize,width)-1,y1 = std::min(y0+diff.tileSize,height)-1;
+    auto const cyan = [&](uint32_t x,uint32_t y){
+      uint8_t*out = rgba.data()+((size_t)y*width+x)*4;
+      out[0] = 0;out[1] = 255;out[2] = 255;
+    };
+    for(uint32_t x=x0;x<=x1;++x){cyan(x,y0);cyan(x,y1);}
+    for(uint32_t y=y0;y<=y1;++y){cyan(x0,y);cyan(x1,y);}
+  }
+  return writeImage(file,rgba.data(),width,height,true,ImageWriterOptions{});
+}
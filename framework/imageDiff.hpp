@@ -0,0 +1,47 @@
+/*!
+ * @file
+ * @brief This file contains comparison of images (MSE, PSNR, SSIM, per tile error map and heatmap)
+ *
+ * @author Martin Zmitko, xzmitk01@stud.fit.vutbr.cz
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <student/fwd.hpp>
+
+//! [ImageDiffOptions]
+/**
+ * @brief This struct holds settings of image comparison
+ */
+struct ImageDiffOptions{
+  uint32_t channels = 3   ;///< number of compared channels, alpha is ignored by default
+  uint32_t tileSize = 32  ;///< size of tiles of error map in pixels
+  bool     ssim     = true;///< compute structural similarity of luminance
+  uint32_t threads  = 0   ;///< threads that compare bands of large images, 0 selects number of hardware threads
+};
+//! [ImageDiffOptions]
+
+//! [ImageDiff]
+/**
+ * @brief This struct holds result of image comparison
+ */
+struct ImageDiff{
+  double            mse             = 0.;///< mean square error over pixels and compared channels
+  double            psnr            = 0.;///< peak signal to noise ratio in dB, infinity for equal images
+  double            ssim            = 1.;///< mean structural similarity of 8x8 windows of luminance
+  size_t            differentPixels = 0 ;///< number of pixels that differ in any compared channel
+  uint32_t          tileSize        = 0 ;///< size of tiles in pixels
+  uint32_t          tilesX          = 0 ;///< number of tile columns
+  uint32_t          tilesY          = 0 ;///< number of tile rows
+  std::vector<float>tileMse            ;///< mean square error of tiles, tiles are in the same row order as pixels
+  uint32_t          worstTile       = 0 ;///< index of tile with the largest error
+};
+//! [ImageDiff]
+
+ImageDiff compareImages(Texture const&a,Texture const&b,ImageDiffOptions const&options = ImageDiffOptions{});
+
+bool writeDiffHeatmap(std::string const&file,Texture const&a,Texture const&b,ImageDiff const&diff,ImageDiffOptions const&options = ImageDiffOptions{});
@@ -0,0 +1,307 @@
+/*!
+ * @file
+ * @brief This file contains queue of images that are encoded and written on worker threads
+ *
+ * @author Martin Zmitko, xzmitk01@stud.fit.vutbr.cz
+ */
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <fstream>
+
+#include <framework/imageWriter.hpp>
+
+#include <libs/stb_image/stb_image_write.h>
+
+/**
+ * @brief This function selects format of image by extension of file.
+ *
+ * @param file file name
+ *
+ * @return format, PNG if extension is not known
+ */
+ImageFormat imageFormatFromFile(std::string const&file){
+  auto const dot = file.find_last_of('.');
+  if(dot == std::string::npos)return ImageFormat::PNG;
+  std::string ext = file.substr(dot+1);
+  std::transform(ext.begin(),ext.end(),ext.begin(),[](unsigned char c){return (char)std::tolower(c);});
+  if(ext == "ppm")return ImageFormat::PPM;
+  if(ext == "qoi")return ImageFormat::QOI;
+  if(ext == "raw" || ext == "rgba")return ImageFormat::RAW;
+  return ImageFormat::PNG;
+}
+
+uint32_t pngCrc32(uint32_t crc,uint8_t const*data,size_t size){
+  static uint32_t const*const table = []{
+    static uint32_t t[256];
+    for(uint32_t n=0;n<256;++n){
+      uint32_t c = n;
+      for(int k=0;k<8;++k)c = c&1 ? 0xEDB88320u^(c>>1) : c>>1;
+      t[n] = c;
+    }
+    return t;
+  }();
+  crc = ~crc;
+  for(size_t i=0;i<size;++i)crc = table[(crc^data[i])&0xff]^(crc>>8);
+  return ~crc;
+}
+
+void putBE32(std::vector<uint8_t>&out,uint32_t v){
+  out.insert(out.end(),{(uint8_t)(v>>24),(uint8_t)(v>>16),(uint8_t)(v>>8),(uint8_t)v});
+}
+
+void pngChunk(std::ofstream&file,char const*type,std::vector<uint8_t>const&data){
+  std::vector<uint8_t>head;
+  putBE32(head,(uint32_t)data.size());
+  head.insert(head.end(),type,type+4);
+  uint32_t crc = pngCrc32(pngCrc32(0,head.data()+4,4),data.data(),data.size());
+  std::vector<uint8_t>tail;
+  putBE32(tail,crc);
+  file.write((char const*)head.data(),head.size());
+  file.write((char const*)data.data(),data.size());
+  file.write((char const*)tail.data(),tail.size());
+}
+
+/**
+ * @brief This function writes PNG whose rows are stored in deflate blocks without compression.
+ *
+ * @param file output file
+ * @param row pointer to row of image (rows from top to bottom)
+ *
+ * @return true if image was written
+ */
+template<typename ROW>
+bool writeStoredPng(std::string const&file,ROW const&row,uint32_t width,uint32_t height){
+  std::ofstream out(file,std::ios::binary);
+  if(!out.is_open())return false;
+  uint8_t const signature[] = {0x89,'P','N','G','\r','\n',0x1a,'\n'};
+  out.write((char const*)signature,sizeof(signature));
+  std::vector<uint8_t>header;
+  putBE32(header,width);
+  putBE32(header,height);
+  header.insert(header.end(),{8,6,0,0,0}); // 8 bits, RGBA, deflate, adaptive filters, no interlace
+  pngChunk(out,"IHDR",header);
+
+  size_t const rowSize = (size_t)width*4+1; // filter byte + pixels
+  size_t const rawSize = rowSize*height;
+  std::vector<uint8_t>zlib = {0x78,0x01};
+  zlib.reserve(rawSize+rawSize/65535*5+16);
+  uint32_t a = 1,b = 0;
+  size_t blockLeft = 0;
+  size_t remaining = rawSize;
+  auto const put = [&](uint8_t const*data,size_t size){
+    while(size){
+      if(!blockLeft){
+        blockLeft = std::min(remaining,(size_t)65535);
+        remaining -= blockLeft;
+        uint16_t const len = (uint16_t)blockLeft;
+        zlib.insert(zlib.end(),{(uint8_t)(remaining == 0),(uint8_t)len,(uint8_t)(len>>8),(uint8_t)~len,(uint8_t)(~len>>8)});
+      }
+      size_t const n = std::min(size,blockLeft);
+      zlib.insert(zlib.end(),data,data+n);
+      for(size_t i=0;i<n;++i){
+        a = (a+data[i])%65521;
+        b = (b+a)%65521;
+      }
+      data += n;size -= n;blockLeft -= n;
+    }
+  };
+  uint8_t const filter = 0;
+  for(uint32_t y=0;y<height;++y){
+    put(&filter,1);
+    put(row(y),(size_t)width*4);
+  }
+  putBE32(zlib,b<<16|a);
+  pngChunk(out,"IDAT",zlib);
+  pngChunk(out,"IEND",{});
+  return out.good();
+}
+
+template<typename ROW>
+bool writePpm(std::string const&file,ROW const&row,uint32_t width,uint32_t height){
+  std::ofstream out(file,std::ios::binary);
+  if(!out.is_open())return false;
+  out << "P6\n" << width << " " << height << "\n255\n";
+  std::vector<uint8_t>rgb((size_t)width*3);
+  for(uint32_t y=0;y<height;++y){
+    uint8_t const*src = row(y);
+    for(uint32_t x=0;x<width;++x)
+      for(int c=0;c<3;++c)rgb[x*3+c] = src[x*4+c];
+    out.write((char const*)rgb.data(),rgb.size());
+  }
+  return out.good();
+}
+
+template<typename ROW>
+bool writeRaw(std::string const&file,ROW const&row,uint32_t width,uint32_t height){
+  std::ofstream out(file,std::ios::binary);
+  if(!out.is_open())return false;
+  for(uint32_t y=0;y<height;++y)
+    out.write((char const*)row(y),(size_t)width*4);
+  return out.good();
+}
+
+/**
+ * @brief This function writes image in QOI format (qoiformat.org).
+ *
+ * @param file output file
+ * @param row pointer to row of image (rows from top to bottom)
+ * @param channels 3 if alpha is opaque, 4 otherwise (only stored in header)
+ *
+ * @return true if image was written
+ */
+template<typename ROW>
+bool writeQoi(std::string const&file,ROW const&row,uint32_t width,uint32_t height,uint8_t channels){
+  std::ofstream out(file,std::ios::binary);
+  if(!out.is_open())return false;
+  std::vector<uint8_t>data = {'q','o','i','f'};
+  putBE32(data,width);
+  putBE32(data,height);
+  data.push_back(channels);
+  data.push_back(0);
+  data.reserve((size_t)width*height*2);
+
+  uint8_t index[64][4] = {};
+  uint8_t prev[4] = {0,0,0,255};
+  uint32_t run = 0;
+  size_t const nofPixels = (size_t)width*height;
+  size_t p = 0;
+  for(uint32_t y=0;y<height;++y){
+    uint8_t const*src = row(y);
+    for(uint32_t x=0;x<width;++x,++p){
+      uint8_t const*px = src+x*4;
+      if(std::memcmp(px,prev,4) == 0){
+        ++run;
+        if(run == 62 || p+1 == nofPixels){
+          data.push_back((uint8_t)(0xc0|(run-1)));
+          run = 0;
+        }
+        continue;
+      }
+      if(run){
+        data.push_back((uint8_t)(0xc0|(run-1)));
+        run = 0;
+      }
+      uint32_t const hash = (px[0]*3+px[1]*5+px[2]*7+px[3]*11)%64;
+      if(std::memcmp(index[hash],px,4) == 0){
+        data.push_back((uint8_t)hash);
+      }else{
+        std::memcpy(index[hash],px,4);
+        if(px[3] == prev[3]){
+          int8_t const dr = (int8_t)(px[0]-prev[0]),dg = (int8_t)(px[1]-prev[1]),db = (int8_t)(px[2]-prev[2]);
+          int8_t const drg = (int8_t)(dr-dg),dbg = (int8_t)(db-dg);
+          if(dr >= -2 && dr <= 1 && dg >= -2 && dg <= 1 && db >= -2 && db <= 1)
+            data.push_back((uint8_t)(0x40|(dr+2)<<4|(dg+2)<<2|(db+2)));
+          else if(dg >= -32 && dg <= 31 && drg >= -8 && drg <= 7 && dbg >= -8 && dbg <= 7)
+            data.insert(data.end(),{(uint8_t)(0x80|(dg+32)),(uint8_t)((drg+8)<<4|(dbg+8))});
+          else
+            data.insert(data.end(),{0xfe,px[0],px[1],px[2]});
+        }else{
+          data.insert(data.end(),{0xff,px[0],px[1],px[2],px[3]});
+        }
+      }
+      std::memcpy(prev,px,4);
+    }
+  }
+  data.insert(data.end(),{0,0,0,0,0,0,0,1});
+  out.write((char const*)data.data(),data.size());
+  return out.good();
+}
+
+/**
+ * @brief This function encodes and writes image on calling thread.
+ * Rows are addressed through pointers, so bottom up images are written without flipped copy.
+ *
+ * @param file output file, format is selected by extension (png, ppm, qoi, raw/rgba)
+ * @param rgba RGBA8 pixels, alpha is overwritten if options.opaque is set
+ * @param width width of image
+ * @param height height of image
+ * @param bottomUp rows are stored from bottom to top (framebuffer)
+ * @param options settings
+ *
+ * @return true if image was written
+ */
+bool writeImage(std::string const&file,uint8_t*rgba,uint32_t width,uint32_t height,bool bottomUp,ImageWriterOptions const&options){
+  if(!width || !height)return false;
+  if(options.opaque)
+    for(size_t i=3;i<(size_t)width*height*4;i+=4)rgba[i] = 255;
+  size_t const stride = (size_t)width*4;
+  auto const row = [&](uint32_t y){return rgba+(bottomUp ? height-1-y : y)*stride;};
+  switch(imageFormatFromFile(file)){
+    case ImageFormat::PPM:return writePpm(file,row,width,height);
+    case ImageFormat::QOI:return writeQoi(file,row,width,height,options.opaque ? 3 : 4);
+    case ImageFormat::RAW:return writeRaw(file,row,width,height);
+    case ImageFormat::PNG:break;
+  }
+  if(options.pngLevel <= 0)return writeStoredPng(file,row,width,height);
+  return stbi_write_png(file.c_str(),width,height,4,row(0),bottomUp ? -(int)stride : (int)stride) != 0;
+}
+
+/**
+ * @brief Constructor, starts encoding threads
+ *
+ * @param options settings
+ */
+ImageWriter::ImageWriter(ImageWriterOptions const&options):options(options),pool(options.threads){
+  stbi_write_png_compression_level = std::max(options.pngLevel,1);
+  stbi_write_force_png_filter      = options.pngFilters ? -1 : 0;
+}
+
+/**
+ * @brief Destructor, waits until all images are written
+ */
+ImageWriter::~ImageWriter(){
+  wait();
+}
+
+/**
+ * @brief This function queues image, it blocks while too many images wait for encoding.
+ *
+ * @param file output file, format is selected by extension (png, ppm, qoi, raw/rgba)
+ * @param rgba RGBA8 pixels, writer takes ownership
+ * @param width width of image
+ * @param height height of image
+ * @param bottomUp rows are stored from bottom to top (framebuffer)
+ */
+void ImageWriter::write(std::string const&file,std::vector<uint8_t>&&rgba,uint32_t width,uint32_t height,bool bottomUp){
+  {
+    std::unique_lock<std::mutex>lock(mutex);
+    finished.wait(lock,[&]{return pending < std::max(options.maxPending,1u);});
+    ++pending;
+  }
+  auto image = std::make_shared<std::vector<uint8_t>>(std::move(rgba));
+  pool.add([this,file,image,width,height,bottomUp]{
+    bool const ok = image->size() >= (size_t)width*height*4 && writeImage(file,image->data(),width,height,bottomUp,options);
+    (ok ? written : failed)++;
+    std::lock_guard<std::mutex>lock(mutex);
+    --pending;
+    finished.notify_all();
+  });
+}
+
+/**
+ * @brief This function blocks until all queued images are written.
+ */
+void ImageWriter::wait(){
+  std::unique_lock<std::mutex>lock(mutex);
+  finished.wait(lock,[&]{return pending == 0;});
+}
+
+/**
+ * @brief This function returns number of written images.
+ *
+ * @return number of images
+ */
+size_t ImageWriter::getWritten()const{
+  return written;
+}
+
+/**
+ * @brief This function returns number of images that could not be written.
+ *
+ * @return number of images
+ */
+size_t ImageWriter::getFailed()const{
+  return failed;
+}
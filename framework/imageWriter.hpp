@@ -0,0 +1,66 @@
+/*!
+ * @file
+ * @brief This file contains queue of images that are encoded and written on worker threads
+ *
+ * @author Martin Zmitko, xzmitk01@stud.fit.vutbr.cz
+ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <framework/threadPool.hpp>
+
+/**
+ * @brief This enum represents format of written image
+ */
+enum class ImageFormat{
+  PNG, ///< deflate compressed or stored PNG
+  PPM, ///< binary portable pixmap (RGB)
+  QOI, ///< quite ok image format, fast lossless compression
+  RAW, ///< RGBA8 pixels without header, rows from top to bottom
+};
+
+ImageFormat imageFormatFromFile(std::string const&file);
+
+//! [ImageWriterOptions]
+/**
+ * @brief This struct holds settings of image writer
+ */
+struct ImageWriterOptions{
+  uint32_t threads    = 0   ;///< encoding threads, 0 selects number of hardware threads
+  int32_t  pngLevel   = 8   ;///< deflate level of PNG, 0 stores rows without compression (stb compresses 1-4 as 5)
+  bool     pngFilters = true;///< choose the best filter of every PNG row, false skips filtering (faster)
+  bool     opaque     = true;///< store alpha as 255
+  uint32_t maxPending = 64  ;///< write blocks while this many images wait for encoding
+};
+//! [ImageWriterOptions]
+
+bool writeImage(std::string const&file,uint8_t*rgba,uint32_t width,uint32_t height,bool bottomUp,ImageWriterOptions const&options);
+
+/**
+ * @brief This class encodes and writes images on worker threads.
+ * PNG level and filtering are process wide settings of stb, the last constructed writer selects them.
+ */
+class ImageWriter{
+  public:
+    ImageWriter(ImageWriterOptions const&options = ImageWriterOptions{});
+    ~ImageWriter();
+    void write(std::string const&file,std::vector<uint8_t>&&rgba,uint32_t width,uint32_t height,bool bottomUp = true);
+    void wait();
+    size_t getWritten()const;
+    size_t getFailed()const;
+  protected:
+    ImageWriterOptions      options       ;///< settings
+    std::mutex              mutex         ;///< guards pending
+    std::condition_variable finished      ;///< signaled when image is written
+    uint32_t                pending = 0   ;///< queued images that are not written yet
+    std::atomic<size_t>     written{0}    ;///< number of written images
+    std::atomic<size_t>     failed {0}    ;///< number of images that could not be written
+    ThreadPool              pool          ;///< encoding threads, joined before the other members are destroyed
+};
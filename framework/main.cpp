@@ -15,9 +15,12 @@
 #include<examples/modelMethod.hpp>
 #include<tests/conformanceTests.hpp>
 #include<tests/performanceTest.hpp>
+#include<tests/benchmark.hpp>
+#include<tests/batchRender.hpp>
 #include<tests/takeScreenShot.hpp>
 
 #include<framework/arguments.hpp>
+#include<framework/trace.hpp>
 
 #ifdef _MSC_VER
 #include "windows.h"
@@ -36,18 +39,30 @@ int main(int argc,char*argv[]){
     if(args.stop)
       return 0;
 
+    TraceRecording const trace(args.traceFile,args.traceFrames);
+
     if(args.runConformanceTests){
-      runConformanceTests(args.groundTruthFile,args.modelFile,args.selectedTest,args.upToTest);
+      runConformanceTests(args.groundTruthFile,args.modelFile,args.selectedTest,args.upToTest,args.testJobs);
       return 0;
     }
 
     if(args.runPerformanceTests){
-      runPerformanceTest(args.modelFile,args.perfTests);
+      runPerformanceTest(args.modelFile,args.perfTests,args.drawSettings,args.loadOptions,args.perfCounters);
+      return 0;
+    }
+
+    if(args.runBenchmark){
+      runBenchmark(args.benchmark,args.drawSettings,args.loadOptions);
+      return 0;
+    }
+
+    if(!args.batchFile.empty()){
+      runBatchRender(args.batchFile,args.drawSettings,args.loadOptions,args.imageOptions);
       return 0;
     }
 
     if(args.takeScreenShot){
-      takeScreenShot(args.groundTruthFile,args.modelFile);
+      takeScreenShot(args.groundTruthFile,args.modelFile,args.drawSettings,args.loadOptions,args.imageOptions);
       return 0;
     }
 
@@ -62,8 +77,9 @@ int main(int argc,char*argv[]){
     app.registerMethod<phongMethod         ::Method>("phong bunny"                                             );
     app.registerMethod<texturedQuad        ::Method>("textured quad"                                           ,std::make_shared<texturedQuad::ConstructionData>(args.imageFile));
     app.registerMethod<SKFlagMethod                >("South Korean flag"                                       );
-    app.registerMethod<modelMethod         ::Method>("model loader"                                            ,std::make_shared<modelMethod ::ConstructionData>(args.modelFile));
+    app.registerMethod<modelMethod         ::Method>("model loader"                                            ,std::make_shared<modelMethod ::ConstructionData>(args.modelFile,args.drawSettings,args.loadOptions));
     app.setMethod(args.method);
+    if(args.syncPresent)app.setPipelinedPresent(false);
     app.start();
 
   }catch(std::exception&e){
@@ -0,0 +1,63 @@
+/*!
+ * @file
+ * @brief This file contains read only memory mapped file
+ *
+ * @author Martin Zmitko, xzmitk01@stud.fit.vutbr.cz
+ */
+
+#include<framework/mappedFile.hpp>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include<windows.h>
+#else
+#include<fcntl.h>
+#include<sys/mman.h>
+#include<sys/stat.h>
+#include<unistd.h>
+#endif
+
+/**
+ * @brief Constructor, maps file, isValid returns false if file cannot be mapped
+ *
+ * @param fileName file name
+ */
+MappedFile::MappedFile(std::string const&fileName){
+#if defined(_WIN32)
+  HANDLE f = CreateFileA(fileName.c_str(),GENERIC_READ,FILE_SHARE_READ,nullptr,OPEN_EXISTING,FILE_ATTRIBUTE_NORMAL,nullptr);
+  if(f == INVALID_HANDLE_VALUE)return;
+  file = f;
+  LARGE_INTEGER fileSize;
+  if(!GetFileSizeEx(f,&fileSize) || fileSize.QuadPart == 0)return;
+  mapping = CreateFileMappingA(f,nullptr,PAGE_READONLY,0,0,nullptr);
+  if(!mapping)return;
+  ptr = (uint8_t const*)MapViewOfFile(mapping,FILE_MAP_READ,0,0,0);
+  if(ptr)length = (size_t)fileSize.QuadPart;
+#else
+  int fd = open(fileName.c_str(),O_RDONLY);
+  if(fd < 0)return;
+  struct stat st;
+  if(fstat(fd,&st) == 0 && st.st_size > 0){
+    void*p = mmap(nullptr,(size_t)st.st_size,PROT_READ,MAP_PRIVATE,fd,0);
+    if(p != MAP_FAILED){
+      ptr    = (uint8_t const*)p;
+      length = (size_t)st.st_size;
+    }
+  }
+  close(fd); // mapping stays valid after the descriptor is closed
+#endif
+}
+
+/**
+ * @brief Destructor, unmaps file
+ */
+MappedFile::~MappedFile(){
+#if defined(_WIN32)
+  if(ptr    )UnmapViewOfFile(ptr);
+  if(mapping)CloseHandle(mapping);
+  if(file   )CloseHandle(file);
+#else
+  if(ptr)munmap((void*)ptr,length);
+#endif
+}
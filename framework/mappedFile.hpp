@@ -0,0 +1,49 @@
+/*!
+ * @file
+ * @brief This file contains read only memory mapped file
+ *
+ * @author Martin Zmitko, xzmitk01@stud.fit.vutbr.cz
+ */
+
+#pragma once
+
+#include<cstddef>
+#include<cstdint>
+#include<string>
+
+/**
+ * @brief This class maps whole file into memory for reading.
+ * Pages are loaded by the operating system when they are touched.
+ */
+class MappedFile{
+  public:
+    MappedFile(std::string const&fileName);
+    ~MappedFile();
+    MappedFile(MappedFile const&) = delete;
+    MappedFile&operator=(MappedFile const&) = delete;
+    /**
+     * @brief This function returns mapped data
+     *
+     * @return pointer to the first byte of the file, nullptr if file was not mapped
+     */
+    uint8_t const*data()const{return ptr;}
+    /**
+     * @brief This function returns size of mapped file
+     *
+     * @return size in bytes
+     */
+    size_t size()const{return length;}
+    /**
+     * @brief This function returns whether file was mapped
+     *
+     * @return true if mapping succeeded
+     */
+    bool isValid()const{return ptr != nullptr;}
+  protected:
+    uint8_t const*ptr    = nullptr;///< mapped data
+    size_t        length = 0      ;///< size of mapped data
+#if defined(_WIN32)
+    void*         file    = nullptr;///< file handle
+    void*         mapping = nullptr;///< file mapping handle
+#endif
+};
@@ -1,10 +1,25 @@
+#include <atomic>
+#include <cstring>
+#include <iomanip>
 #include <iostream>
+#include <memory>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/quaternion.hpp>
 #include <glm/gtx/quaternion.hpp>
 
+#include <framework/mappedFile.hpp>
 #include <framework/model.hpp>
+#include <framework/sceneCache.hpp>
+#include <framework/textureStreamer.hpp>
+#include <framework/threadPool.hpp>
+#include <framework/timer.hpp>
+#include <student/culling.hpp>
+#include <student/meshOptimizer.hpp>
+#include <student/meshlet.hpp>
+#include <student/simplify.hpp>
+#include <student/textureCompression.hpp>
 #include <libs/tiny_gltf/tiny_gltf.h>
+#include <json.hpp>
 
 namespace tests{
 void printModel(Model const&model);
@@ -39,31 +54,400 @@ std::string accesstorType2Str(int i){
 class ModelDataImpl{
   public:
     ModelDataImpl();
-    void load(std::string const&fileName);
+    void load(std::string const&fileName,ModelLoadOptions const&options);
+    bool loadMappedBinary(std::string const&fileName,std::string&err,std::string&warn);
+    bool loadSceneCache(std::string const&fileName);
+    void storeSceneCache();
+    uint8_t const*bufferData(int buffer)const;
     ~ModelDataImpl();
     Model getModel();
+    Model buildModel();
+    void decodeImages();
+    bool isImageReady(size_t i)const;
+    Texture getTexture(size_t i)const;
+    bool updateTextures(Model&model)const;
+    void startTextureStreaming();
+    void compressImage(size_t i);
     bool ret = false;
     tinygltf::Model model;
     tinygltf::TinyGLTF loader;
+    ModelLoadOptions options;
+    BufferStorage bufferStorage;///< generated index and vertex buffers (levels of detail, optimized meshes)
+    MeshOptimizationStats optimizationStats;
+    Model builtModel;
+    bool  modelBuilt = false;
+    std::unique_ptr<std::atomic<bool>[]>imageReady;///< image is decoded (only used with parallel image decoding)
+    std::atomic<uint32_t>remainingImages{0};///< number of images that are not decoded yet
+    Timer<float>imageTimer;///< measures time from start of image decoding
+    std::unique_ptr<MappedFile>mappedFile;///< mapped .glb file, model buffers point into it
+    std::vector<uint8_t const*>mappedBuffers;///< mapped data of each buffer, nullptr if buffer is stored in model.buffers
+    std::unique_ptr<MappedFile>mappedCache;///< mapped .izgscene file, cached model points into it
+    std::string cacheFile;///< .izgscene file that should be written after the model is built, empty if not
+    SceneCacheKey cacheKey;///< key of loaded model file
+    std::vector<TextureFormat>imageFormats;///< format of stored image data, RAW if image is not compressed
+    std::unique_ptr<TextureStreamer>streamer;///< resident levels of textures, nullptr if streaming is disabled
+    std::unique_ptr<ThreadPool>pool;///< image decoding threads, destroyed first, so tasks do not outlive the model
 };
 
 ModelDataImpl::ModelDataImpl(){
 }
 
-void ModelDataImpl::load(std::string const&fileName){
+/**
+ * @brief Image loader callback of tinygltf that only keeps encoded image.
+ * Decoding is done later by ModelDataImpl::decodeImages.
+ */
+bool storeEncodedImage(tinygltf::Image*image,int const,std::string*,std::string*,int,int,unsigned char const*bytes,int size,void*){
+  image->image.assign(bytes,bytes+size);
+  image->as_is = true;
+  return true;
+}
+
+void ModelDataImpl::load(std::string const&fileName,ModelLoadOptions const&opt){
+  if(pool)pool->wait(); // tasks of previous model write into it
+  imageReady.reset();
+  options = opt;
+  modelBuilt = false;
+  bufferStorage.clear();
+  optimizationStats = MeshOptimizationStats{};
+  mappedBuffers.clear();
+  mappedFile.reset();
+  mappedCache.reset();
+  cacheFile.clear();
+  streamer.reset();
+  imageFormats.clear();
+  // cache stores full resolution textures, streaming keeps encoded images instead
+  if(options.sceneCache && !options.textureBudget && loadSceneCache(fileName))return;
   std::string err;
   std::string warn;
-  if(fileName.find(".glb")==fileName.length()-4)
-    ret = loader.LoadBinaryFromFile(&model, &err, &warn, fileName.c_str());
+  if(options.parallelImages || options.textureBudget)
+    loader.SetImageLoader(storeEncodedImage,nullptr);
+  else
+    loader.RemoveImageLoader();
+
+  Timer<float>timer;
+  if(fileName.find(".glb")==fileName.length()-4){
+    if(options.mapFile)
+      ret = loadMappedBinary(fileName,err,warn);
+    else
+      ret = loader.LoadBinaryFromFile(&model, &err, &warn, fileName.c_str());
+  }
 
   if(fileName.find(".gltf")==fileName.length()-5)
     ret = loader.LoadASCIIFromFile(&model, &err, &warn, fileName.c_str());
 
   if(!ret)
     std::cerr << "model: " << fileName << "was not be loaded" << std::endl;
+
+  imageFormats.assign(model.images.size(),TextureFormat::RAW);
+  if(ret && options.textureBudget){
+    startTextureStreaming();
+    return;
+  }
+  if(ret && !options.parallelImages && options.compressTextures){
+    Timer<float>compressionTimer;
+    size_t rawBytes = 0,compressedBytes = 0;
+    for(size_t i=0;i<model.images.size();++i){
+      rawBytes += model.images[i].image.size();
+      compressImage(i);
+      compressedBytes += model.images[i].image.size();
+    }
+    std::cerr << "model load: textures compressed from " << std::fixed << std::setprecision(1) << rawBytes/1048576.f
+              << " MB to " << compressedBytes/1048576.f << " MB in " << compressionTimer.elapsedFromStart()*1000.f << " ms" << std::endl;
+  }
+  if(!ret || !options.parallelImages)return;
+  std::cerr << std::fixed << std::setprecision(1);
+  std::cerr << "model load: json and buffers " << timer.elapsedFromStart()*1000.f << " ms" << std::endl;
+  decodeImages();
+  if(options.lazyImages)return;
+  pool->wait();
+  std::cerr << "model load: " << model.images.size() << " images decoded in " << imageTimer.elapsedFromStart()*1000.f
+            << " ms on " << pool->size() << " threads" << std::endl;
+}
+
+/**
+ * @brief This struct tells image loader where embedded images are stored in mapped binary chunk
+ */
+struct MappedImages{
+  uint8_t const*                       bin         = nullptr;///< binary chunk in mapped file
+  std::vector<std::pair<size_t,size_t>>ranges               ;///< offset and length of image in binary chunk, zero length if image is not embedded
+  bool                                 keepEncoded = false  ;///< only keep encoded images, they are decoded later
+};
+
+/**
+ * @brief Image loader callback of tinygltf for mapped .glb files.
+ * Embedded images only have empty placeholder in data given to tinygltf, they are read from the mapping instead.
+ */
+bool loadMappedImage(tinygltf::Image*image,int const index,std::string*err,std::string*warn,int width,int height,unsigned char const*bytes,int size,void*user){
+  auto const&mapped = *(MappedImages const*)user;
+  if((size_t)index < mapped.ranges.size() && mapped.ranges[index].second){
+    bytes = mapped.bin + mapped.ranges[index].first;
+    size  = (int)mapped.ranges[index].second;
+  }
+  if(mapped.keepEncoded)return storeEncodedImage(image,index,err,warn,width,height,bytes,size,nullptr);
+  return tinygltf::LoadImageData(image,index,err,warn,width,height,bytes,size,nullptr);
+}
+
+/**
+ * @brief This function loads .glb file from memory mapping.
+ * tinygltf copies whole binary chunk into model buffers. To avoid it, json chunk is rewritten
+ * so that embedded buffer is empty and embedded images point to empty buffer view,
+ * tinygltf gets only this json and the image loader decodes (or keeps encoded) images directly from the mapping.
+ * Meshes point directly into the mapping through the original buffer views,
+ * geometry is then paged in by the operating system when it is read.
+ *
+ * @param fileName file name
+ * @param err errors
+ * @param warn warnings
+ *
+ * @return true if model was loaded
+ */
+bool ModelDataImpl::loadMappedBinary(std::string const&fileName,std::string&err,std::string&warn){
+  auto loadFromFile = [&]{
+    mappedFile.reset();
+    return loader.LoadBinaryFromFile(&model, &err, &warn, fileName.c_str());
+  };
+  mappedFile = std::make_unique<MappedFile>(fileName);
+  if(!mappedFile->isValid() || mappedFile->size() > UINT32_MAX)return loadFromFile();
+  uint8_t const*bytes = mappedFile->data();
+  size_t  const size  = mappedFile->size();
+
+  // 12 B file header, 8 B header of json chunk, json, 8 B header of binary chunk, binary data
+  uint32_t jsonLength = 0,binLength = 0;
+  if(size >= 20)memcpy(&jsonLength,bytes+12,sizeof(jsonLength));
+  size_t const binChunk = 20 + (size_t)jsonLength;
+  if(size < 20 || memcmp(bytes,"glTF",4) || binChunk + 8 > size)return loadFromFile(); // nothing to map
+  memcpy(&binLength,bytes+binChunk,sizeof(binLength));
+  uint8_t const*bin = bytes + binChunk + 8;
+  if(binChunk + 8 + binLength > size)return loadFromFile();
+
+  nlohmann::json json = nlohmann::json::parse(bytes+20,bytes+binChunk,nullptr,false);
+  if(json.is_discarded() || !json.count("buffers"))return loadFromFile();
+
+  MappedImages mapped;
+  mapped.bin         = bin;
+  mapped.keepEncoded = options.parallelImages || options.textureBudget;
+  uint32_t const binBytes = 4;
+  try{
+    for(size_t i=1;i<json["buffers"].size();++i)
+      if(!json["buffers"][i].count("uri"))return loadFromFile(); // only the first buffer can be binary chunk
+    bool const embedded = !json["buffers"].at(0).count("uri");
+    if(embedded && json.count("images")){
+      auto&views = json["bufferViews"];
+      size_t const placeholder = views.size();
+      views.push_back({{"buffer",0},{"byteLength",0}});
+      auto&images = json["images"];
+      mapped.ranges.resize(images.size());
+      for(size_t i=0;i<images.size();++i){
+        if(!images[i].count("bufferView"))continue;
+        auto const&view = views.at(images[i]["bufferView"].get<size_t>());
+        if(view.value("buffer",size_t(0)) != 0)continue;
+        size_t const offset = view.value("byteOffset",size_t(0));
+        size_t const length = view.value("byteLength",size_t(0));
+        if(offset + length > binLength)return loadFromFile();
+        mapped.ranges[i] = {offset,length};
+        images[i]["bufferView"] = placeholder;
+      }
+    }
+    if(embedded)json["buffers"][0]["byteLength"] = binBytes;
+  }catch(nlohmann::json::exception const&){
+    return loadFromFile(); // tinygltf reports what is wrong
+  }
+
+  std::string jsonChunk = json.dump();
+  jsonChunk.resize((jsonChunk.size() + 3) & ~size_t(3),' ');
+  std::vector<uint8_t>glb(28 + jsonChunk.size() + binBytes);
+  uint32_t const header[] = {
+    0x46546C67u,2u,(uint32_t)glb.size(),               // "glTF", version, length
+    (uint32_t)jsonChunk.size(),0x4E4F534Au};          // "JSON"
+  uint32_t const binHeader[] = {binBytes,0x004E4942u}; // "BIN"
+  memcpy(glb.data(),header,sizeof(header));
+  memcpy(glb.data()+20,jsonChunk.data(),jsonChunk.size());
+  memcpy(glb.data()+20+jsonChunk.size(),binHeader,sizeof(binHeader));
+
+  loader.SetImageLoader(loadMappedImage,&mapped);
+  std::string const baseDir = fileName.substr(0,fileName.find_last_of("/\\")+1);
+  bool const loaded = loader.LoadBinaryFromMemory(&model, &err, &warn, glb.data(), (unsigned int)glb.size(), baseDir);
+  if(mapped.keepEncoded)loader.SetImageLoader(storeEncodedImage,nullptr);
+  else                  loader.RemoveImageLoader();
+  if(!loaded)return false;
+
+  mappedBuffers.assign(model.buffers.size(),nullptr);
+  for(size_t i=0;i<model.buffers.size();++i){
+    if(!model.buffers[i].uri.empty())continue;
+    mappedBuffers[i] = bin;
+    std::vector<unsigned char>().swap(model.buffers[i].data); // images are already decoded or stored
+  }
+  return true;
+}
+
+/**
+ * @brief This function loads model from .izgscene cache.
+ * If the cache is missing or stale, it is written after the model is built.
+ *
+ * @param fileName model file
+ *
+ * @return true if cache was used
+ */
+bool ModelDataImpl::loadSceneCache(std::string const&fileName){
+  if(!sceneCacheKey(cacheKey,fileName,options))return false;
+  Timer<float>timer;
+  std::string const file = sceneCacheFile(fileName);
+  if(!readSceneCache(builtModel,mappedCache,file,cacheKey)){
+    cacheFile = file;
+    return false;
+  }
+  model      = tinygltf::Model{};
+  ret        = true;
+  modelBuilt = true;
+  std::cerr << "model load: scene cache " << file << " loaded in " << std::fixed << std::setprecision(1)
+            << timer.elapsedFromStart()*1000.f << " ms" << std::endl;
+  return true;
+}
+
+/**
+ * @brief This function writes built model into .izgscene cache.
+ * Images that are decoded in background are awaited first.
+ */
+void ModelDataImpl::storeSceneCache(){
+  if(cacheFile.empty() || !ret)return;
+  if(pool)pool->wait();
+  updateTextures(builtModel);
+  if(writeSceneCache(cacheFile,builtModel,cacheKey))
+    std::cerr << "model load: scene cache written to " << cacheFile << std::endl;
+  else
+    std::cerr << "model load: scene cache " << cacheFile << " could not be written" << std::endl;
+  cacheFile.clear();
+}
+
+/**
+ * @brief This function returns data of model buffer.
+ *
+ * @param buffer buffer id
+ *
+ * @return pointer into mapped file or into buffer copy of tinygltf
+ */
+uint8_t const*ModelDataImpl::bufferData(int buffer)const{
+  if((size_t)buffer < mappedBuffers.size() && mappedBuffers[buffer])
+    return mappedBuffers[buffer];
+  return model.buffers.at(buffer).data.data();
+}
+
+/**
+ * @brief This function hands encoded images over to texture streamer.
+ * Each image is decoded once to build its mip chain, only the full resolution level is decoded from it again on demand.
+ */
+void ModelDataImpl::startTextureStreaming(){
+  Timer<float>timer;
+  streamer = std::make_unique<TextureStreamer>(options.textureBudget,options.loaderThreads);
+  for(size_t i=0;i<model.images.size();++i){
+    auto encoded = std::make_shared<std::vector<unsigned char>>();
+    encoded->swap(model.images[i].image);
+    streamer->addTexture([encoded,i](std::vector<uint8_t>&pixels,uint32_t&width,uint32_t&height,uint32_t&channels){
+      tinygltf::Image image;
+      std::string err,warn;
+      if(!tinygltf::LoadImageData(&image,(int)i,&err,&warn,0,0,encoded->data(),(int)encoded->size(),nullptr))
+        return false;
+      pixels.swap(image.image);
+      width    = (uint32_t)image.width;
+      height   = (uint32_t)image.height;
+      channels = (uint32_t)image.component;
+      return true;
+    });
+  }
+  streamer->finishLoading();
+  auto const stats = streamer->getStats();
+  std::cerr << "texture streaming: " << model.images.size() << " images, tail levels " << std::fixed << std::setprecision(1)
+            << stats.tailBytes/1048576.f << " MB, stored levels " << stats.storedBytes/1048576.f << " MB, budget " << options.textureBudget/1048576.f << " MB, prepared in "
+            << timer.elapsedFromStart()*1000.f << " ms" << std::endl;
+}
+
+/**
+ * @brief This function decodes stored images on thread pool.
+ */
+void ModelDataImpl::decodeImages(){
+  if(!pool || (options.loaderThreads && pool->size() != options.loaderThreads))
+    pool = std::make_unique<ThreadPool>(options.loaderThreads);
+  size_t const nofImages = model.images.size();
+  imageReady.reset(new std::atomic<bool>[nofImages]);
+  for(size_t i=0;i<nofImages;++i)imageReady[i] = false;
+  remainingImages = (uint32_t)nofImages;
+  imageTimer.reset();
+
+  for(size_t i=0;i<nofImages;++i)
+    pool->add([this,i]{
+      auto&img = model.images[i];
+      if(img.as_is){
+        std::vector<unsigned char>encoded;
+        encoded.swap(img.image);
+        std::string err,warn;
+        if(!tinygltf::LoadImageData(&img,(int)i,&err,&warn,0,0,encoded.data(),(int)encoded.size(),nullptr))
+          std::cerr << "model: image " << i << " was not decoded " << err << std::endl;
+        img.as_is = false;
+      }
+      if(options.compressTextures)compressImage(i);
+      imageReady[i].store(true,std::memory_order_release);
+      if(--remainingImages == 0 && options.lazyImages)
+        std::cerr << "model load: " << model.images.size() << " images decoded in background in "
+                  << std::fixed << std::setprecision(1) << imageTimer.elapsedFromStart()*1000.f << " ms" << std::endl;
+    });
+}
+
+/**
+ * @brief This function replaces decoded image by BC1 (RGB) or BC3 (RGBA) blocks.
+ * Images with less than 3 channels or 16 bit channels are kept uncompressed.
+ *
+ * @param i image id
+ */
+void ModelDataImpl::compressImage(size_t i){
+  auto&img = model.images[i];
+  if(img.image.empty() || img.bits != 8 || img.component < 3)return;
+  TextureFormat const format = img.component == 4 ? TextureFormat::BC3 : TextureFormat::BC1;
+  img.image = compressTexture(img.image.data(),img.width,img.height,img.component,format);
+  imageFormats[i] = format;
+}
+
+bool ModelDataImpl::isImageReady(size_t i)const{
+  return !imageReady || imageReady[i].load(std::memory_order_acquire);
+}
+
+Texture ModelDataImpl::getTexture(size_t i)const{
+  if(streamer)return streamer->getTexture(i);
+  Texture tex;
+  if(!isImageReady(i))return tex; // empty until decoded
+  auto const&img = model.images[i];
+  //std::cerr << "w: " << img.width << " h: " << img.height << " c: " << img.component << " " << img.name << std::endl;
+  //std::cerr << "size: " << img.image.size() << std::endl;
+  tex.width    = img.width;
+  tex.height   = img.height;
+  tex.channels = img.component;
+  tex.data     = img.image.data();
+  tex.format   = i < imageFormats.size() ? imageFormats[i] : TextureFormat::RAW;
+  return tex;
+}
+
+/**
+ * @brief This function fills textures of model that were decoded since the last call.
+ *
+ * @param m model returned by getModel
+ *
+ * @return true if some texture has changed
+ */
+bool ModelDataImpl::updateTextures(Model&m)const{
+  bool changed = false;
+  for(size_t i=0;i<m.textures.size() && i<model.images.size();++i){
+    if(m.textures[i].data || !isImageReady(i))continue;
+    m.textures[i] = getTexture(i);
+    changed = true;
+  }
+  return changed;
 }
 
 ModelDataImpl::~ModelDataImpl(){
+  if(!streamer)return;
+  auto const stats = streamer->getStats();
+  std::cerr << "texture streaming: " << stats.loads << " levels loaded, " << stats.evictions << " evicted, peak "
+            << std::fixed << std::setprecision(1) << stats.peakBytes/1048576.f << " MB of "
+            << options.textureBudget/1048576.f << " MB budget" << std::endl;
 }
 
 Node loadNode(tinygltf::Node const&root,tinygltf::Model const&model){
@@ -102,6 +486,20 @@ Node loadNode(tinygltf::Node const&root,tinygltf::Model const&model){
 
 
 Model ModelDataImpl::getModel(){
+  // generated data is owned by this object, so it is created only once
+  if(!modelBuilt){
+    Timer<float>timer;
+    builtModel = buildModel();
+    modelBuilt = true;
+    if(options.parallelImages)
+      std::cerr << "model load: geometry built in " << std::fixed << std::setprecision(1) << timer.elapsedFromStart()*1000.f << " ms" << std::endl;
+    storeSceneCache();
+  }
+  updateTextures(builtModel);
+  return builtModel;
+}
+
+Model ModelDataImpl::buildModel(){
   Model res;
   if(!ret)return res;
 
@@ -122,16 +520,8 @@ Model ModelDataImpl::getModel(){
   }
   //std::cerr << "loaded nodes" << std::endl;
 
-  for(auto const&img:model.images){
-    res.textures.push_back({});
-    auto&tex = res.textures.back();
-    //std::cerr << "w: " << img.width << " h: " << img.height << " c: " << img.component << " " << img.name << std::endl;
-    //std::cerr << "size: " << img.image.size() << std::endl;
-    tex.width    = img.width;
-    tex.height   = img.height;
-    tex.channels = img.component;
-    tex.data     = img.image.data();
-  }
+  for(size_t i=0;i<model.images.size();++i)
+    res.textures.push_back(getTexture(i));
 
   for(auto const&mesh:model.meshes){
     
@@ -170,7 +560,7 @@ Model ModelDataImpl::getModel(){
           auto const&ia  = model.accessors.at(primitive.indices);
           auto const&ibv = model.bufferViews.at(ia.bufferView);
           m_mesh.nofIndices = (uint32_t)ia.count;
-          m_mesh.indices = model.buffers.at(ibv.buffer).data.data() + ibv.byteOffset + ia.byteOffset;
+          m_mesh.indices = bufferData(ibv.buffer) + ibv.byteOffset + ia.byteOffset;
           //std::cerr << "  ibv : " << ia.bufferView ;
           //std::cerr << "  iNof: " << ia.count      ;
           //std::cerr << "  ibuf: " << ibv.buffer    ;
@@ -199,6 +589,10 @@ Model ModelDataImpl::getModel(){
         //std::cerr << " components: " << accesstorType2Str(accessor.type) << std::endl;
         if(std::string(attrib.first) == "POSITION"){
           att = &m_mesh.position;
+          if(accessor.minValues.size() >= 3 && accessor.maxValues.size() >= 3){
+            m_mesh.aabbMin = glm::vec3(accessor.minValues[0],accessor.minValues[1],accessor.minValues[2]);
+            m_mesh.aabbMax = glm::vec3(accessor.maxValues[0],accessor.maxValues[1],accessor.maxValues[2]);
+          }
 
 
           //m_mesh.nofIndices = accessor.count;
@@ -220,7 +614,7 @@ Model ModelDataImpl::getModel(){
           auto stride = bufferView.byteStride;
           auto offset = bufferView.byteOffset;
           //auto size   = bufferView.byteLength;
-          auto bptr   = model.buffers.at(bufId).data.data() + accessor.byteOffset;
+          auto bptr   = bufferData(bufId) + accessor.byteOffset;
 
           att->bufferData = bptr;
           att->offset     = offset;
@@ -244,7 +638,14 @@ Model ModelDataImpl::getModel(){
       }
     //std::cerr << __LINE__ << std::endl;
 
-      
+      computeMeshBounds(m_mesh);
+      computeMeshUvDensity(m_mesh);
+      if(options.optimizeMeshes)
+        optimizeMesh(m_mesh,bufferStorage,optimizationStats);
+      if(options.buildMeshlets)
+        buildMeshMeshlets(m_mesh,bufferStorage);
+      if(options.generateLods)
+        generateMeshLods(m_mesh,bufferStorage,options.lodMaxError);
 
     }
     //std::cerr << __LINE__ << std::endl;
@@ -252,12 +653,19 @@ Model ModelDataImpl::getModel(){
   }
     //std::cerr << __LINE__ << std::endl;
 
+  if(options.optimizeMeshes && optimizationStats.triangles){
+    auto const triangles = (float)optimizationStats.triangles;
+    std::cerr << "mesh optimization: ACMR " << optimizationStats.missesBefore/triangles
+              << " -> " << optimizationStats.missesAfter/triangles
+              << " (" << optimizationStats.triangles << " triangles, cache size " << vertexCacheSize << ")" << std::endl;
+  }
+
   //tests::printModel(res);
   return res;
 }
 
-void ModelData::load(std::string const&fileName){
-  impl->load(fileName);
+void ModelData::load(std::string const&fileName,ModelLoadOptions const&options){
+  impl->load(fileName,options);
 }
 
 ModelData::ModelData(){
@@ -271,3 +679,30 @@ ModelData::~ModelData(){
 Model ModelData::getModel(){
   return impl->getModel();
 }
+
+/**
+ * @brief This function fills textures that were decoded since the model was returned by getModel.
+ * It is needed only with lazy image decoding.
+ *
+ * @param model model returned by getModel
+ *
+ * @return true if some texture has changed
+ */
+bool ModelData::updateTextures(Model&model){
+  return impl->updateTextures(model);
+}
+
+/**
+ * @brief This function makes requested texture levels resident and binds them to model (texture streaming).
+ * Levels that are not loaded yet are replaced by coarser ones.
+ * Textures of other copies of the model may point to evicted levels.
+ *
+ * @param model model returned by getModel
+ * @param levels finest needed level of each texture (Scene::textureLevels)
+ *
+ * @return true if some texture has changed
+ */
+bool ModelData::streamTextures(Model&model,std::vector<uint32_t>const&levels){
+  if(!impl->streamer)return false;
+  return impl->streamer->update(model.textures,levels);
+}
@@ -6,13 +6,32 @@
 
 #include<student/fwd.hpp>
 
+/**
+ * @brief This struct holds optional processing done when model is loaded
+ */
+struct ModelLoadOptions{
+  bool  generateLods   = false;///< generate simplified levels of detail of meshes
+  float lodMaxError    = .05f ;///< maximal error of the coarsest level relative to mesh radius
+  bool  optimizeMeshes = false;///< reorder indices and vertices for vertex cache, overdraw and vertex fetch
+  bool  buildMeshlets  = false;///< split meshes into meshlets for per cluster culling
+  bool     parallelImages = false;///< decode images on thread pool after JSON and buffers are parsed, report load phases
+  bool     lazyImages     = false;///< do not wait for images, textures are filled by updateTextures when they are decoded
+  uint32_t loaderThreads  = 0    ;///< number of image decoding threads, 0 selects number of hardware threads
+  bool     mapFile        = false;///< map .glb file into memory and use its binary chunk in place instead of copying it
+  bool     sceneCache     = false;///< load model from .izgscene cache next to model file, write the cache if it is missing or stale
+  bool     compressTextures = false;///< store RGB images as BC1 and RGBA images as BC3 blocks (not used with texture streaming)
+  size_t   textureBudget  = 0    ;///< bytes of streamed texture levels, 0 keeps all images decoded at full resolution
+};
+
 class ModelDataImpl;
 class ModelData{
   public:
     ModelData();
-    void load(std::string const&fileName);
+    void load(std::string const&fileName,ModelLoadOptions const&options = ModelLoadOptions{});
     ~ModelData();
     Model getModel();
+    bool updateTextures(Model&model);
+    bool streamTextures(Model&model,std::vector<uint32_t>const&levels);
   private:
     friend class ModelDataImpl;
     ModelDataImpl*impl = nullptr;
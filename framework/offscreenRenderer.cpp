@@ -0,0 +1,145 @@
+/*!
+ * @file
+ * @brief This file contains offscreen rendering of models without window
+ *
+ * @author Martin Zmitko, xzmitk01@stud.fit.vutbr.cz
+ */
+
+#include <framework/offscreenRenderer.hpp>
+
+void defaultSceneParameters(
+    basicCamera::OrbitCamera&orbit,
+    basicCamera::PerspectiveCamera&proj,
+    glm::vec3&light,
+    uint32_t w,uint32_t h){
+  orbit.addDistance(35.f);
+  orbit.addYAngle(glm::radians(-20.f));
+  proj.setNear(0.1f);
+  proj.setFar(glm::half_pi<float>());
+  auto const aspect = static_cast<float>(w) / static_cast<float>(h);
+  proj.setAspect(aspect);
+  light  = glm::vec3(100.f,100.f,100.f);
+}
+
+/**
+ * @brief This function returns view of default scene parameters.
+ *
+ * @param width width of image
+ * @param height height of image
+ *
+ * @return view
+ */
+RenderView defaultRenderView(uint32_t width,uint32_t height){
+  basicCamera::OrbitCamera       orbit;
+  basicCamera::PerspectiveCamera proj;
+  glm::vec3                      light;
+  defaultSceneParameters(orbit,proj,light,width,height);
+  return renderView(orbit,proj,light);
+}
+
+/**
+ * @brief This function returns view of cameras.
+ *
+ * @param orbit orbit camera
+ * @param proj projection camera
+ * @param light light position
+ *
+ * @return view
+ */
+RenderView renderView(basicCamera::OrbitCamera&orbit,basicCamera::PerspectiveCamera&proj,glm::vec3 const&light){
+  RenderView res;
+  res.proj   = proj .getProjection();
+  res.view   = orbit.getView();
+  res.light  = light;
+  res.camera = glm::vec3(glm::inverse(res.view)*glm::vec4(0.f,0.f,0.f,1.f));
+  return res;
+}
+
+/**
+ * @brief Constructor, loads model
+ *
+ * @param modelFile model file in gltf/glb format
+ * @param drawSettings optional stages of model rendering
+ * @param loadOptions optional processing of loaded model
+ */
+OffscreenModel::OffscreenModel(std::string const&modelFile,DrawSettings const&drawSettings,ModelLoadOptions const&loadOptions):drawSettings(drawSettings){
+  modelData.load(modelFile,loadOptions);
+  model = modelData.getModel();
+  buildScene(scene,model);
+}
+
+/**
+ * @brief Constructor
+ *
+ * @param width width of rendered images
+ * @param height height of rendered images
+ */
+OffscreenRenderer::OffscreenRenderer(uint32_t width,uint32_t height):framebuffer(width,height){
+  ctx.frame = framebuffer.getFrame();
+}
+
+/**
+ * @brief This function changes size of rendered images.
+ *
+ * @param width width of rendered images
+ * @param height height of rendered images
+ */
+void OffscreenRenderer::resize(uint32_t width,uint32_t height){
+  framebuffer.resize(width,height);
+  ctx.frame = framebuffer.getFrame();
+}
+
+/**
+ * @brief This function clears framebuffer and renders model.
+ *
+ * @param model model
+ * @param view camera and light
+ * @param background clear color
+ */
+void OffscreenRenderer::render(OffscreenModel&model,RenderView const&view,glm::vec4 const&background){
+  model.modelData.updateTextures(model.model);
+  model.modelData.streamTextures(model.model,model.scene.textureLevels);
+  render(model.model,model.scene,model.drawSettings,view,background);
+}
+
+/**
+ * @brief This function clears framebuffer and renders model without updating its textures.
+ * Renderers on different threads can draw the same model at once if each of them has its own scene.
+ *
+ * @param model model
+ * @param scene flattened node tree of model
+ * @param drawSettings optional stages of model rendering
+ * @param view camera and light
+ * @param background clear color
+ */
+void OffscreenRenderer::render(Model const&model,Scene&scene,DrawSettings const&drawSettings,RenderView const&view,glm::vec4 const&background){
+  ctx.frame = framebuffer.getFrame();
+  clear(ctx,background.r,background.g,background.b,background.a);
+  drawScene(ctx,model,scene,view.proj,view.view,view.light,view.camera,drawSettings);
+}
+
+/**
+ * @brief This function returns frame of framebuffer.
+ *
+ * @return frame
+ */
+Frame OffscreenRenderer::getFrame(){
+  return framebuffer.getFrame();
+}
+
+uint32_t OffscreenRenderer::getWidth()const{
+  return framebuffer.width;
+}
+
+uint32_t OffscreenRenderer::getHeight()const{
+  return framebuffer.height;
+}
+
+/**
+ * @brief This function returns color buffer of the last rendered image.
+ *
+ * @return RGBA8 pixels, rows from bottom to top
+ */
+std::vector<uint8_t>const&OffscreenRenderer::getColor()const{
+  return framebuffer.color;
+}
@@ -0,0 +1,80 @@
+/*!
+ * @file
+ * @brief This file contains offscreen rendering of models without window
+ *
+ * @author Martin Zmitko, xzmitk01@stud.fit.vutbr.cz
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <BasicCamera/OrbitCamera.h>
+#include <BasicCamera/PerspectiveCamera.h>
+
+#include <framework/framebuffer.hpp>
+#include <framework/model.hpp>
+#include <student/drawModel.hpp>
+#include <student/scene.hpp>
+
+/**
+ * @brief This function sets default scene parameters for rendering
+ *
+ * @param orbit output orbit camera
+ * @param proj output projection camera
+ * @param light output light position
+ * @param width width of the window
+ * @param height height of the window
+ */
+void defaultSceneParameters(
+    basicCamera::OrbitCamera&orbit,
+    basicCamera::PerspectiveCamera&proj,
+    glm::vec3&light,
+    uint32_t width,uint32_t height);
+
+//! [RenderView]
+/**
+ * @brief This struct holds camera and light of one rendered image
+ */
+struct RenderView{
+  glm::mat4 proj   = glm::mat4(1.f)                ;///< projection matrix
+  glm::mat4 view   = glm::mat4(1.f)                ;///< view matrix
+  glm::vec3 light  = glm::vec3(100.f,100.f,100.f)  ;///< light position
+  glm::vec3 camera = glm::vec3(0.f)                ;///< camera position
+};
+//! [RenderView]
+
+RenderView defaultRenderView(uint32_t width,uint32_t height);
+
+RenderView renderView(basicCamera::OrbitCamera&orbit,basicCamera::PerspectiveCamera&proj,glm::vec3 const&light);
+
+/**
+ * @brief This class holds loaded model prepared for offscreen rendering
+ */
+class OffscreenModel{
+  public:
+    OffscreenModel(std::string const&modelFile,DrawSettings const&drawSettings = DrawSettings{},ModelLoadOptions const&loadOptions = ModelLoadOptions{});
+    ModelData    modelData   ;///< owner of model memory
+    Model        model       ;///< model
+    Scene        scene       ;///< flattened node tree of model
+    DrawSettings drawSettings;///< optional stages of model rendering
+};
+
+/**
+ * @brief This class renders models into its own framebuffer, it does not need any window
+ */
+class OffscreenRenderer{
+  public:
+    OffscreenRenderer(uint32_t width,uint32_t height);
+    void resize(uint32_t width,uint32_t height);
+    void render(OffscreenModel&model,RenderView const&view,glm::vec4 const&background = glm::vec4(.5f,.5f,1.f,0.f));
+    void render(Model const&model,Scene&scene,DrawSettings const&drawSettings,RenderView const&view,glm::vec4 const&background = glm::vec4(.5f,.5f,1.f,0.f));
+    Frame getFrame();
+    uint32_t getWidth ()const;
+    uint32_t getHeight()const;
+    std::vector<uint8_t>const&getColor()const;
+  protected:
+    Framebuffer framebuffer;///< color and depth buffer
+    GPUContext  ctx        ;///< gpu context
+};
@@ -0,0 +1,164 @@
+/*!
+ * @file
+ * @brief This file contains hardware performance counters of calling thread (Linux perf_event_open)
+ *
+ * @author Martin Zmitko, xzmitk01@stud.fit.vutbr.cz
+ */
+
+#include <cerrno>
+#include <cstring>
+#include <iomanip>
+
+#include <framework/perfCounters.hpp>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace perfCounters{
+
+char const*const names[] = {"cycles","instructions","cache references","cache misses","branches","branch misses"};
+
+#if defined(__linux__)
+uint64_t const configs[] = {
+  PERF_COUNT_HW_CPU_CYCLES         ,
+  PERF_COUNT_HW_INSTRUCTIONS       ,
+  PERF_COUNT_HW_CACHE_REFERENCES   ,
+  PERF_COUNT_HW_CACHE_MISSES       ,
+  PERF_COUNT_HW_BRANCH_INSTRUCTIONS,
+  PERF_COUNT_HW_BRANCH_MISSES      ,
+};
+#endif
+
+}
+
+using namespace perfCounters;
+
+/**
+ * @brief Constructor, opens counters, they do not count until start is called
+ */
+PerfCounters::PerfCounters(){
+  for(auto&fd:fds)fd = -1;
+#if defined(__linux__)
+  for(size_t i=0;i<(size_t)PerfEvent::COUNT;++i){
+    perf_event_attr attr;
+    std::memset(&attr,0,sizeof(attr));
+    attr.size           = sizeof(attr);
+    attr.type           = PERF_TYPE_HARDWARE;
+    attr.config         = configs[i];
+    attr.disabled       = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv     = 1;
+    attr.read_format    = PERF_FORMAT_TOTAL_TIME_ENABLED|PERF_FORMAT_TOTAL_TIME_RUNNING;
+    // counters are not grouped, a counter that is not supported does not disable the others
+    fds[i] = (int)syscall(SYS_perf_event_open,&attr,0,-1,-1,0);
+    if(fds[i] < 0 && error.empty())error = std::string(names[i])+": "+std::strerror(errno);
+  }
+#else
+  error = "perf_event_open is available only on Linux";
+#endif
+}
+
+/**
+ * @brief Destructor, closes counters
+ */
+PerfCounters::~PerfCounters(){
+#if defined(__linux__)
+  for(auto fd:fds)
+    if(fd >= 0)close(fd);
+#endif
+}
+
+/**
+ * @brief This function returns true if at least one counter is opened.
+ *
+ * @return true if something can be counted
+ */
+bool PerfCounters::available()const{
+  for(auto fd:fds)
+    if(fd >= 0)return true;
+  return false;
+}
+
+/**
+ * @brief This function returns reason why the first missing counter could not be opened.
+ *
+ * @return error, empty if all counters are opened
+ */
+std::string const&PerfCounters::getError()const{
+  return error;
+}
+
+/**
+ * @brief This function resets counters and starts counting.
+ */
+void PerfCounters::start(){
+#if defined(__linux__)
+  for(auto fd:fds)
+    if(fd >= 0)ioctl(fd,PERF_EVENT_IOC_RESET,0);
+  for(auto fd:fds)
+    if(fd >= 0)ioctl(fd,PERF_EVENT_IOC_ENABLE,0);
+#endif
+}
+
+/**
+ * @brief This function stops counting and returns events counted from start.
+ * Counters that were multiplexed with other events are scaled by the time they were running.
+ *
+ * @return counted events
+ */
+PerfCounterValues PerfCounters::stop(){
+  PerfCounterValues res;
+#if defined(__linux__)
+  for(auto fd:fds)
+    if(fd >= 0)ioctl(fd,PERF_EVENT_IOC_DISABLE,0);
+  for(size_t i=0;i<(size_t)PerfEvent::COUNT;++i){
+    uint64_t data[3] = {}; // value, time enabled, time running
+    if(fds[i] < 0 || read(fds[i],data,sizeof(data)) != (ssize_t)sizeof(data) || !data[2])continue;
+    res.value[i] = data[2] < data[1] ? (uint64_t)((double)data[0]*(double)data[1]/(double)data[2]) : data[0];
+    res.valid[i] = true;
+  }
+#endif
+  return res;
+}
+
+/**
+ * @brief This function prints counted events per frame, per triangle and per fragment.
+ *
+ * @param out output stream
+ * @param values events counted during all frames
+ * @param frames number of frames
+ * @param primitives number of triangles drawn during all frames
+ * @param fragments number of fragments rasterized during all frames
+ */
+void reportPerfCounters(std::ostream&out,PerfCounterValues const&values,double frames,uint64_t primitives,uint64_t fragments){
+  auto const line = [&](char const*name,double divisor,int precision){
+    if(divisor <= 0.)return;
+    out << name;
+    bool first = true;
+    auto const item = [&](char const*label,PerfEvent e){
+      if(!values.has(e))return;
+      out << (first ? " " : ", ") << label << " " << std::setprecision(precision) << values.get(e)/divisor;
+      first = false;
+    };
+    out << std::fixed;
+    item("instructions",PerfEvent::INSTRUCTIONS);
+    item("cycles"      ,PerfEvent::CYCLES      );
+    item("cache misses",PerfEvent::CACHE_MISSES);
+    item("branch misses",PerfEvent::BRANCH_MISSES);
+    out << std::endl;
+  };
+  line("Per frame:"   ,frames            ,0);
+  line("Per triangle:",(double)primitives,2);
+  line("Per fragment:",(double)fragments ,2);
+  out << std::fixed << std::setprecision(2);
+  if(values.has(PerfEvent::INSTRUCTIONS) && values.has(PerfEvent::CYCLES) && values.get(PerfEvent::CYCLES) > 0.)
+    out << "IPC: " << values.get(PerfEvent::INSTRUCTIONS)/values.get(PerfEvent::CYCLES) << std::endl;
+  if(values.has(PerfEvent::CACHE_MISSES) && values.has(PerfEvent::CACHE_REFERENCES) && values.get(PerfEvent::CACHE_REFERENCES) > 0.)
+    out << "Cache miss rate: " << 100.*values.get(PerfEvent::CACHE_MISSES)/values.get(PerfEvent::CACHE_REFERENCES) << " %" << std::endl;
+  if(values.has(PerfEvent::BRANCH_MISSES) && values.has(PerfEvent::BRANCHES) && values.get(PerfEvent::BRANCHES) > 0.)
+    out << "Branch miss rate: " << 100.*values.get(PerfEvent::BRANCH_MISSES)/values.get(PerfEvent::BRANCHES) << " %" << std::endl;
+}
@@ -0,0 +1,58 @@
+/*!
+ * @file
+ * @brief This file contains hardware performance counters of calling thread (Linux perf_event_open)
+ *
+ * @author Martin Zmitko, xzmitk01@stud.fit.vutbr.cz
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+/**
+ * @brief Counted hardware events
+ */
+enum class PerfEvent{
+  CYCLES          ,///< cpu cycles
+  INSTRUCTIONS    ,///< retired instructions
+  CACHE_REFERENCES,///< last level cache references
+  CACHE_MISSES    ,///< last level cache misses
+  BRANCHES        ,///< retired branch instructions
+  BRANCH_MISSES   ,///< mispredicted branches
+  COUNT           ,///< number of events
+};
+
+//! [PerfCounterValues]
+/**
+ * @brief This struct holds counted events, events that cannot be counted are not valid
+ */
+struct PerfCounterValues{
+  uint64_t value[(size_t)PerfEvent::COUNT] = {};///< number of events
+  bool     valid[(size_t)PerfEvent::COUNT] = {};///< event was counted
+  bool has(PerfEvent e)const{return valid[(size_t)e];}
+  double get(PerfEvent e)const{return (double)value[(size_t)e];}
+};
+//! [PerfCounterValues]
+
+/**
+ * @brief This class counts hardware events of calling thread in user space.
+ * Counters that cannot be opened (no PMU in virtual machine or container, perf_event_paranoid, other OS) are skipped.
+ */
+class PerfCounters{
+  public:
+    PerfCounters();
+    ~PerfCounters();
+    PerfCounters(PerfCounters const&) = delete;
+    PerfCounters&operator=(PerfCounters const&) = delete;
+    bool available()const;
+    std::string const&getError()const;
+    void start();
+    PerfCounterValues stop();
+  protected:
+    int         fds[(size_t)PerfEvent::COUNT];///< file descriptors of counters, -1 if counter is not opened
+    std::string error                        ;///< reason why some counters are not opened
+};
+
+void reportPerfCounters(std::ostream&out,PerfCounterValues const&values,double frames,uint64_t primitives,uint64_t fragments);
@@ -0,0 +1,303 @@
+/*!
+ * @file
+ * @brief This file contains binary cache of preprocessed models (.izgscene)
+ *
+ * Layout: header, flattened nodes, meshes, textures, data blocks.
+ * Meshes are stored as Mesh structs whose pointers hold offsets from the start of the file,
+ * vertex attributes are tightly packed. The file is mapped on load and meshes and textures point into it.
+ *
+ * @author Martin Zmitko, xzmitk01@stud.fit.vutbr.cz
+ */
+
+#include<algorithm>
+#include<cstring>
+#include<filesystem>
+#include<fstream>
+
+#include<framework/sceneCache.hpp>
+#include<student/simplify.hpp>
+#include<student/textureCompression.hpp>
+
+namespace{
+
+char const sceneCacheMagic[8] = {'I','Z','G','S','C','E','N','E'};
+
+/**
+ * @brief Header of .izgscene file
+ */
+struct SceneCacheHeader{
+  char          magic[8]                ;///< "IZGSCENE"
+  uint32_t      version     = 0         ;///< sceneCacheVersion
+  uint32_t      meshSize    = 0         ;///< sizeof(Mesh), stored meshes depend on compiler layout
+  SceneCacheKey key                     ;///< source file and options
+  uint64_t      checksum    = 0         ;///< checksum of everything behind header
+  uint64_t      fileSize    = 0         ;///< size of the whole file
+  uint32_t      nofNodes    = 0         ;///< number of flattened nodes
+  uint32_t      nofRoots    = 0         ;///< number of root nodes
+  uint32_t      nofMeshes   = 0         ;///< number of meshes
+  uint32_t      nofTextures = 0         ;///< number of textures
+};
+
+/**
+ * @brief Node stored in depth first order, children follow their parent
+ */
+struct CachedNode{
+  glm::mat4 modelMatrix = glm::mat4(1.f);///< model transformation matrix
+  int32_t   mesh        = -1            ;///< id of mesh or -1
+  uint32_t  nofChildren = 0             ;///< number of direct children
+};
+
+/**
+ * @brief Texture description, pixels are stored in data block
+ */
+struct CachedTexture{
+  uint32_t width    = 0;///< width of the texture
+  uint32_t height   = 0;///< height of the texture
+  uint32_t channels = 0;///< number of channels
+  uint32_t format   = 0;///< TextureFormat of data
+  uint64_t data     = 0;///< offset of pixels or compressed blocks
+};
+
+size_t const blockAlignment = 16;
+
+size_t alignBlock(size_t offset){
+  return (offset + blockAlignment - 1) / blockAlignment * blockAlignment;
+}
+
+/**
+ * @brief This function computes checksum of data (FNV-1a over 64-bit words).
+ */
+uint64_t checksum(uint8_t const*data,size_t size){
+  uint64_t h = 0xcbf29ce484222325ull;
+  size_t i = 0;
+  for(;i+8<=size;i+=8){
+    uint64_t w;
+    memcpy(&w,data+i,sizeof(w));
+    h = (h^w)*0x100000001b3ull;
+  }
+  for(;i<size;++i)
+    h = (h^data[i])*0x100000001b3ull;
+  return h;
+}
+
+void const*toOffset(uint64_t offset){
+  return (void const*)(uintptr_t)offset;
+}
+
+void const*fromOffset(uint8_t const*base,void const*offset){
+  return offset ? base + (uintptr_t)offset : nullptr;
+}
+
+void flattenNode(std::vector<CachedNode>&nodes,Node const&node){
+  CachedNode n;
+  n.modelMatrix = node.modelMatrix;
+  n.mesh        = node.mesh;
+  n.nofChildren = (uint32_t)node.children.size();
+  nodes.push_back(n);
+  for(auto const&c:node.children)flattenNode(nodes,c);
+}
+
+bool unflattenNode(Node&res,CachedNode const*nodes,uint32_t nofNodes,uint32_t&i){
+  if(i >= nofNodes)return false;
+  CachedNode const&n = nodes[i++];
+  res.modelMatrix = n.modelMatrix;
+  res.mesh        = n.mesh;
+  res.children.resize(n.nofChildren);
+  for(auto&c:res.children)
+    if(!unflattenNode(c,nodes,nofNodes,i))return false;
+  return true;
+}
+
+}
+
+/**
+ * @brief This function returns name of cache file of model.
+ *
+ * @param modelFile model file
+ *
+ * @return cache file name
+ */
+std::string sceneCacheFile(std::string const&modelFile){
+  return modelFile + ".izgscene";
+}
+
+/**
+ * @brief This function computes key of model file and load options.
+ *
+ * @param key output key
+ * @param modelFile model file
+ * @param options load options
+ *
+ * @return false if model file does not exist
+ */
+bool sceneCacheKey(SceneCacheKey&key,std::string const&modelFile,ModelLoadOptions const&options){
+  std::error_code ec;
+  key = SceneCacheKey{};
+  key.sourceSize = std::filesystem::file_size(modelFile,ec);
+  if(ec)return false;
+  key.sourceTime = (int64_t)std::filesystem::last_write_time(modelFile,ec).time_since_epoch().count();
+  if(ec)return false;
+  key.options     = (uint32_t)options.generateLods | (uint32_t)options.optimizeMeshes << 1 | (uint32_t)options.buildMeshlets << 2
+                | (uint32_t)options.compressTextures << 3;
+  key.lodMaxError = options.generateLods ? options.lodMaxError : 0.f;
+  return true;
+}
+
+/**
+ * @brief This function writes model into cache file.
+ * File is written under temporary name and renamed, so readers never see partial cache.
+ *
+ * @param cacheFile cache file name
+ * @param model model, its images have to be decoded
+ * @param key key of model source
+ *
+ * @return true if cache was written
+ */
+bool writeSceneCache(std::string const&cacheFile,Model const&model,SceneCacheKey const&key){
+  std::vector<CachedNode>nodes;
+  for(auto const&r:model.roots)flattenNode(nodes,r);
+
+  std::vector<uint8_t>data;
+  auto allocate = [&](size_t size){
+    size_t const offset = alignBlock(data.size());
+    data.resize(offset + size);
+    return offset;
+  };
+  auto append = [&](void const*ptr,size_t size){
+    size_t const offset = allocate(size);
+    if(size)memcpy(data.data()+offset,ptr,size);
+    return (uint64_t)offset;
+  };
+
+  size_t const headerOffset   = allocate(sizeof(SceneCacheHeader));
+  size_t const nodesOffset    = append(nodes.data(),nodes.size()*sizeof(CachedNode));
+  size_t const meshesOffset   = allocate(model.meshes.size()*sizeof(Mesh));
+  size_t const texturesOffset = allocate(model.textures.size()*sizeof(CachedTexture));
+
+  std::vector<uint8_t>packed;
+  for(size_t m=0;m<model.meshes.size();++m){
+    Mesh mesh = model.meshes[m];
+    uint32_t nofVertices = mesh.nofIndices;
+    if(mesh.indices){
+      auto const indices = readIndices(mesh);
+      nofVertices = indices.empty() ? 0 : *std::max_element(indices.begin(),indices.end()) + 1;
+      mesh.indices = toOffset(append(mesh.indices,(size_t)mesh.nofIndices*(size_t)mesh.indexType));
+    }
+    for(VertexAttrib*att:{&mesh.position,&mesh.normal,&mesh.texCoord}){
+      if(!att->bufferData || att->type == AttributeType::EMPTY){
+        *att = VertexAttrib{};
+        continue;
+      }
+      size_t const size = sizeof(float)*(size_t)att->type;
+      packed.resize(nofVertices*size);
+      for(uint32_t v=0;v<nofVertices;++v)
+        memcpy(packed.data()+v*size,(uint8_t const*)att->bufferData+att->offset+att->stride*v,size);
+      att->bufferData = toOffset(append(packed.data(),packed.size()));
+      att->offset     = 0;
+      att->stride     = size;
+    }
+    for(uint32_t l=0;l<mesh.nofLods;++l)
+      mesh.lods[l].indices = toOffset(append(mesh.lods[l].indices,(size_t)mesh.lods[l].nofIndices*(size_t)mesh.indexType));
+    if(mesh.meshlets)
+      mesh.meshlets = (Meshlet const*)toOffset(append(mesh.meshlets,mesh.nofMeshlets*sizeof(Meshlet)));
+    memcpy(data.data()+meshesOffset+m*sizeof(Mesh),&mesh,sizeof(Mesh));
+  }
+
+  for(size_t t=0;t<model.textures.size();++t){
+    Texture const&tex = model.textures[t];
+    CachedTexture cached;
+    cached.width    = tex.width;
+    cached.height   = tex.height;
+    cached.channels = tex.channels;
+    cached.format   = (uint32_t)tex.format;
+    if(tex.data) // image that failed to decode stays empty
+      cached.data   = append(tex.data,textureDataSize(tex));
+    memcpy(data.data()+texturesOffset+t*sizeof(CachedTexture),&cached,sizeof(CachedTexture));
+  }
+
+  SceneCacheHeader header;
+  memcpy(header.magic,sceneCacheMagic,sizeof(header.magic));
+  header.version     = sceneCacheVersion;
+  header.meshSize    = sizeof(Mesh);
+  header.key         = key;
+  header.fileSize    = data.size();
+  header.nofNodes    = (uint32_t)nodes.size();
+  header.nofRoots    = (uint32_t)model.roots.size();
+  header.nofMeshes   = (uint32_t)model.meshes.size();
+  header.nofTextures = (uint32_t)model.textures.size();
+  header.checksum    = checksum(data.data()+nodesOffset,data.size()-nodesOffset);
+  memcpy(data.data()+headerOffset,&header,sizeof(header));
+
+  std::string const tmpFile = cacheFile + ".tmp";
+  {
+    std::ofstream file(tmpFile,std::ios::binary);
+    if(!file.write((char const*)data.data(),(std::streamsize)data.size()))return false;
+  }
+  std::error_code ec;
+  std::filesystem::rename(tmpFile,cacheFile,ec);
+  if(ec)std::filesystem::remove(tmpFile,ec);
+  return !ec;
+}
+
+/**
+ * @brief This function maps cache file and creates model that points into it.
+ *
+ * @param model output model
+ * @param file output mapping, it has to outlive the model
+ * @param cacheFile cache file name
+ * @param key expected key of model source
+ *
+ * @return false if cache does not exist, is stale or is corrupted
+ */
+bool readSceneCache(Model&model,std::unique_ptr<MappedFile>&file,std::string const&cacheFile,SceneCacheKey const&key){
+  auto mapped = std::make_unique<MappedFile>(cacheFile);
+  if(!mapped->isValid() || mapped->size() < sizeof(SceneCacheHeader))return false;
+  uint8_t const*base = mapped->data();
+
+  SceneCacheHeader header;
+  memcpy(&header,base,sizeof(header));
+  if(memcmp(header.magic,sceneCacheMagic,sizeof(header.magic)))return false;
+  if(header.version != sceneCacheVersion || header.meshSize != sizeof(Mesh))return false;
+  if(memcmp(&header.key,&key,sizeof(key)) || header.fileSize != mapped->size())return false;
+
+  // same order of tables as in writeSceneCache
+  size_t const nodesOffset    = alignBlock(sizeof(SceneCacheHeader));
+  size_t const meshesOffset   = alignBlock(nodesOffset  + header.nofNodes *sizeof(CachedNode));
+  size_t const texturesOffset = alignBlock(meshesOffset + header.nofMeshes*sizeof(Mesh      ));
+  if(texturesOffset + header.nofTextures*sizeof(CachedTexture) > mapped->size())return false;
+  if(checksum(base+nodesOffset,mapped->size()-nodesOffset) != header.checksum)return false;
+
+  Model res;
+  auto const*nodes = (CachedNode const*)(base+nodesOffset);
+  uint32_t next = 0;
+  res.roots.resize(header.nofRoots);
+  for(auto&r:res.roots)
+    if(!unflattenNode(r,nodes,header.nofNodes,next))return false;
+
+  res.meshes.resize(header.nofMeshes);
+  for(uint32_t m=0;m<header.nofMeshes;++m){
+    Mesh&mesh = res.meshes[m];
+    memcpy(&mesh,base+meshesOffset+m*sizeof(Mesh),sizeof(Mesh));
+    mesh.indices = fromOffset(base,mesh.indices);
+    for(VertexAttrib*att:{&mesh.position,&mesh.normal,&mesh.texCoord})
+      att->bufferData = fromOffset(base,att->bufferData);
+    for(uint32_t l=0;l<mesh.nofLods;++l)
+      mesh.lods[l].indices = fromOffset(base,mesh.lods[l].indices);
+    mesh.meshlets = (Meshlet const*)fromOffset(base,mesh.meshlets);
+  }
+
+  res.textures.resize(header.nofTextures);
+  for(uint32_t t=0;t<header.nofTextures;++t){
+    CachedTexture cached;
+    memcpy(&cached,base+texturesOffset+t*sizeof(CachedTexture),sizeof(cached));
+    res.textures[t].width    = cached.width;
+    res.textures[t].height   = cached.height;
+    res.textures[t].channels = cached.channels;
+    res.textures[t].format   = (TextureFormat)cached.format;
+    res.textures[t].data     = cached.data ? base + cached.data : nullptr;
+  }
+
+  model = std::move(res);
+  file  = std::move(mapped);
+  return true;
+}
@@ -0,0 +1,38 @@
+/*!
+ * @file
+ * @brief This file contains binary cache of preprocessed models (.izgscene)
+ *
+ * @author Martin Zmitko, xzmitk01@stud.fit.vutbr.cz
+ */
+
+#pragma once
+
+#include<cstdint>
+#include<memory>
+#include<string>
+
+#include<framework/mappedFile.hpp>
+#include<framework/model.hpp>
+
+uint32_t const sceneCacheVersion = 2;///< version of .izgscene layout, caches of other versions are rebuilt
+
+/**
+ * @brief This struct identifies source of cached model.
+ * Cache is valid only if it was built from the same file with the same load options.
+ */
+//! [SceneCacheKey]
+struct SceneCacheKey{
+  uint64_t sourceSize  = 0  ;///< size of model file in bytes
+  int64_t  sourceTime  = 0  ;///< last write time of model file
+  uint32_t options     = 0  ;///< load options that change model data (bit mask)
+  float    lodMaxError = 0.f;///< error of the coarsest level of detail
+};
+//! [SceneCacheKey]
+
+std::string sceneCacheFile(std::string const&modelFile);
+
+bool sceneCacheKey(SceneCacheKey&key,std::string const&modelFile,ModelLoadOptions const&options);
+
+bool writeSceneCache(std::string const&cacheFile,Model const&model,SceneCacheKey const&key);
+
+bool readSceneCache(Model&model,std::unique_ptr<MappedFile>&file,std::string const&cacheFile,SceneCacheKey const&key);
@@ -0,0 +1,110 @@
+/*!
+ * @file
+ * @brief This file contains copying of color buffer into SDL surface
+ *
+ * @author Martin Zmitko, xzmitk01@stud.fit.vutbr.cz
+ */
+
+#include <cstring>
+
+#include <glm/glm.hpp>
+
+#include <framework/surface.hpp>
+#include <framework/trace.hpp>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#endif
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define IZG_SSSE3_PRESENT
+/**
+ * @brief This function swizzles row of RGBA8 pixels into 32 bit surface using byte shuffle.
+ *
+ * @param dst destination row
+ * @param src source row
+ * @param width number of pixels
+ * @param mask shuffle of 4 pixels
+ *
+ * @return number of converted pixels (multiple of 4)
+ */
+__attribute__((target("ssse3")))
+uint32_t shuffleRowSSSE3(uint8_t*dst,uint8_t const*src,uint32_t width,uint8_t const*mask){
+  __m128i const m = _mm_loadu_si128((__m128i const*)mask);
+  uint32_t x = 0;
+  for(;x+4<=width;x+=4)
+    _mm_storeu_si128((__m128i*)(dst+x*4),_mm_shuffle_epi8(_mm_loadu_si128((__m128i const*)(src+x*4)),m));
+  return x;
+}
+#endif
+
+/**
+ * @brief This function copies rows of color buffer into SDL surface and flips them vertically.
+ * 32 bit surfaces use byte shuffles (SSSE3 when available) or whole pixel stores,
+ * other formats are written one channel at a time.
+ *
+ * @param surface sdl surface
+ * @param frame color buffer (RGBA8UI)
+ * @param width width of color buffer
+ * @param height height of color buffer
+ * @param firstRow the first copied row of color buffer
+ * @param endRow row after the last copied row of color buffer
+ */
+void copyRowsToSDLSurface(SDL_Surface*surface,uint8_t const*const frame,uint32_t width,uint32_t height,uint32_t firstRow,uint32_t endRow){
+  IZG_TRACE_ZONE("copyRowsToSDLSurface");
+  uint32_t const bitsPerByte    = 8;
+  uint32_t const swizzleTable[] = {
+      surface->format->Rshift / bitsPerByte,
+      surface->format->Gshift / bitsPerByte,
+      surface->format->Bshift / bitsPerByte,
+      6 - (surface->format->Rshift+surface->format->Gshift+surface->format->Bshift) / bitsPerByte, // remaining byte
+  };
+  uint32_t const bytesPerPixel  = surface->format->BytesPerPixel;
+  bool     const wholePixels    = bytesPerPixel == 4 && swizzleTable[3] < 4;
+
+  uint8_t mask[16];
+  for(uint32_t p=0;p<4;++p)
+    for(uint32_t c=0;c<4;++c)
+      mask[p*4+swizzleTable[c]] = (uint8_t)(p*4+c);
+#ifdef IZG_SSSE3_PRESENT
+  static bool const hasSSSE3 = __builtin_cpu_supports("ssse3");
+#endif
+
+  uint8_t* const  pixels      = (uint8_t*)surface->pixels;
+  for (size_t y = firstRow; y < endRow; ++y) {
+    size_t const reversedY = height - y - 1;
+    uint8_t const*const src = frame + y*width*4;
+    uint8_t      *const dst = pixels + reversedY * surface->pitch;
+    uint32_t x = 0;
+    if(wholePixels){
+#ifdef IZG_SSSE3_PRESENT
+      if(hasSSSE3)x = shuffleRowSSSE3(dst,src,width,mask);
+#endif
+      for (; x < width; ++x) {
+        auto const color = src + x*4;
+        uint32_t const pixel = (uint32_t)color[0] << (swizzleTable[0]*bitsPerByte) | (uint32_t)color[1] << (swizzleTable[1]*bitsPerByte)
+                             | (uint32_t)color[2] << (swizzleTable[2]*bitsPerByte) | (uint32_t)color[3] << (swizzleTable[3]*bitsPerByte);
+        memcpy(dst + x*4,&pixel,sizeof(pixel));
+      }
+      continue;
+    }
+    for (; x < width; ++x) {
+      auto const color    = src + x*4;
+      auto const dstPixel = dst + x * bytesPerPixel;
+      for (uint32_t c = 0; c < 3; ++c)
+        dstPixel[swizzleTable[c]] = color[c];
+    }
+  }
+}
+
+void copyToSDLSurface(SDL_Surface*surface,uint8_t const*const frame,uint32_t width,uint32_t height,ThreadPool*pool){
+  uint32_t const parallelPixels = 1<<18;
+  if(!pool || pool->size() < 2 || width*height < parallelPixels){
+    copyRowsToSDLSurface(surface,frame,width,height,0,height);
+    return;
+  }
+  uint32_t const rows = (height+pool->size()-1)/pool->size();
+  for(uint32_t y=0;y<height;y+=rows)
+    pool->add([=]{copyRowsToSDLSurface(surface,frame,width,height,y,glm::min(y+rows,height));});
+  pool->wait();
+}
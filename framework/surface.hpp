@@ -0,0 +1,27 @@
+/*!
+ * @file
+ * @brief This file contains copying of color buffer into SDL surface
+ *
+ * @author Martin Zmitko, xzmitk01@stud.fit.vutbr.cz
+ */
+
+#pragma once
+
+#include <cstdint>
+
+#include <SDL.h>
+
+#include <framework/threadPool.hpp>
+
+void copyRowsToSDLSurface(SDL_Surface*surface,uint8_t const*const color,uint32_t width,uint32_t height,uint32_t firstRow,uint32_t endRow);
+
+/**
+ * @brief This function swaps color buffer with SDL_Surface
+ *
+ * @param surface sdl surface
+ * @param color color buffer (RGBA8UI)
+ * @param width width of color buffer
+ * @param height height of color buffer
+ * @param pool threads that copy rows of large color buffers, nullptr copies on calling thread
+ */
+void copyToSDLSurface(SDL_Surface*surface,uint8_t const*const color,uint32_t width,uint32_t height,ThreadPool*pool = nullptr);
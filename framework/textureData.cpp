@@ -1,10 +1,24 @@
 #include<framework/textureData.hpp>
+#include<framework/threadPool.hpp>
 
 #include<libs/stb_image/stb_image.h>
 
+#include <algorithm>
+#include <cstring>
 #include <iostream>
 
-TextureData loadTexture(std::string const&fileName){
+size_t const parallelFlipBytes = 16<<20;///< images larger than this are flipped on multiple threads
+
+/**
+ * @brief This function loads image file into texture.
+ * Rows are stored from bottom to top.
+ *
+ * @param fileName image file
+ * @param options channel expansion and number of threads
+ *
+ * @return texture, empty if image cannot be loaded
+ */
+TextureData loadTexture(std::string const&fileName,TextureLoadOptions const&options){
   TextureData res;
 
   int32_t w,h,channels;
@@ -14,15 +28,39 @@ TextureData loadTexture(std::string const&fileName){
     return res;
   }
   //std::cerr << "w: " << w << " h: " << h << " c: " << channels << std::endl;
-  res.data.resize(w*h*channels);
+  int32_t const outChannels = options.expandToRGBA ? 4 : channels;
+  size_t const inRow  = (size_t)w*channels;
+  size_t const outRow = (size_t)w*outChannels;
+  res.data.resize(outRow*h);
 
-  for(int32_t y=0;y<h;++y)
-    for(int32_t x=0;x<w;++x)
-      for(int32_t c=0;c<channels;++c){
-        res.data[(y*w+x)*channels+c] = data[((h-y-1)*w+x)*channels+c];
+  // flip is one memcpy per row, expansion is fused with it so image is read only once
+  auto flipRows = [&](int32_t begin,int32_t end){
+    for(int32_t y=begin;y<end;++y){
+      uint8_t const*src = data+(size_t)(h-y-1)*inRow;
+      uint8_t      *dst = res.data.data()+(size_t)y*outRow;
+      if(outChannels == channels){
+        memcpy(dst,src,outRow);
+        continue;
+      }
+      for(int32_t x=0;x<w;++x,src+=channels,dst+=4){
+        dst[0] = src[0];
+        dst[1] = channels > 2 ? src[1] : src[0];
+        dst[2] = channels > 2 ? src[2] : src[0];
+        dst[3] = channels == 4 ? src[3] : channels == 2 ? src[1] : 255;
       }
+    }
+  };
+  if(res.data.size() < parallelFlipBytes || options.nofThreads == 1)
+    flipRows(0,h);
+  else{
+    ThreadPool pool(options.nofThreads);
+    int32_t const rows = (h+(int32_t)pool.size()-1)/(int32_t)pool.size();
+    for(int32_t y=0;y<h;y+=rows)
+      pool.add([&,y]{flipRows(y,std::min(y+rows,h));});
+    pool.wait();
+  }
 
-  res.channels = channels;
+  res.channels = outChannels;
   res.height = h;
   res.width = w;
   stbi_image_free(data);
@@ -25,4 +25,12 @@ class TextureData{
     }
 };
 
-TextureData loadTexture(std::string const&fileName);
+/**
+ * @brief This struct holds optional processing done when texture is loaded
+ */
+struct TextureLoadOptions{
+  bool     expandToRGBA = false;///< convert images with 1-3 channels to 4 channels, alpha is 255
+  uint32_t nofThreads   = 0    ;///< threads that flip rows of large images, 0 selects number of hardware threads
+};
+
+TextureData loadTexture(std::string const&fileName,TextureLoadOptions const&options = TextureLoadOptions{});
@@ -0,0 +1,307 @@
+/*!
+ * @file
+ * @brief This file contains streaming of texture mip levels under memory budget
+ *
+ * @author Martin Zmitko, xzmitk01@stud.fit.vutbr.cz
+ */
+
+#include<algorithm>
+
+#include<framework/textureStreamer.hpp>
+#include<student/textureCompression.hpp>
+
+/**
+ * @brief This function halves image size by averaging 2x2 blocks of pixels.
+ * Odd last row or column of larger image is dropped, dimensions do not go below 1.
+ *
+ * @param pixels image
+ * @param width width of image
+ * @param height height of image
+ * @param channels number of channels
+ *
+ * @return image of size max(width/2,1) x max(height/2,1)
+ */
+std::vector<uint8_t>downsampleImage(std::vector<uint8_t>const&pixels,uint32_t width,uint32_t height,uint32_t channels){
+  uint32_t const w = std::max(width /2,1u);
+  uint32_t const h = std::max(height/2,1u);
+  std::vector<uint8_t>res((size_t)w*h*channels);
+  for(uint32_t y=0;y<h;++y)
+    for(uint32_t x=0;x<w;++x){
+      uint32_t const x0 = std::min(2*x,width -1),x1 = std::min(2*x+1,width -1);
+      uint32_t const y0 = std::min(2*y,height-1),y1 = std::min(2*y+1,height-1);
+      for(uint32_t c=0;c<channels;++c){
+        uint32_t sum = pixels[((size_t)y0*width+x0)*channels+c] + pixels[((size_t)y0*width+x1)*channels+c]
+                     + pixels[((size_t)y1*width+x0)*channels+c] + pixels[((size_t)y1*width+x1)*channels+c];
+        res[((size_t)y*w+x)*channels+c] = (uint8_t)((sum+2)/4);
+      }
+    }
+  return res;
+}
+
+/**
+ * @brief Constructor
+ *
+ * @param budget maximal number of bytes of streamed levels (tails and stored levels are not counted)
+ * @param nofThreads number of loading threads, 0 selects number of hardware threads
+ * @param maxLoads maximal number of images decoded or levels created at once
+ */
+TextureStreamer::TextureStreamer(size_t budget,uint32_t nofThreads,uint32_t maxLoads):budget(budget),maxLoads(std::max(maxLoads,1u)){
+  pool = std::make_unique<ThreadPool>(nofThreads);
+}
+
+/**
+ * @brief Destructor, waits for running loads
+ */
+TextureStreamer::~TextureStreamer(){
+  pool.reset();
+}
+
+/**
+ * @brief This function registers texture.
+ * All textures have to be added before finishLoading is called.
+ *
+ * @param decoder function that decodes full resolution image
+ */
+void TextureStreamer::addTexture(TextureDecoder const&decoder){
+  textures.emplace_back();
+  textures.back().decoder = decoder;
+}
+
+/**
+ * @brief This function decodes image of texture and builds its mip chain.
+ * Levels between full resolution and tail are compressed into BC1 (RGB) or BC3 (RGBA) blocks,
+ * images with less channels keep them uncompressed. Only the tail level stays decoded.
+ *
+ * @param texture texture id
+ */
+void TextureStreamer::prepareTexture(size_t texture){
+  auto&tex = textures[texture];
+  std::vector<uint8_t>pixels;
+  uint32_t width = 0,height = 0;
+  if(!tex.decoder(pixels,width,height,tex.channels) || !width || !height)return;
+  TextureFormat const format = tex.channels == 4 ? TextureFormat::BC3 : tex.channels == 3 ? TextureFormat::BC1 : TextureFormat::RAW;
+  do{
+    Level level;
+    level.width  = width;
+    level.height = height;
+    bool const tail = std::max(width,height) <= textureTailSize;
+    if(!tex.levels.empty() && !tail){
+      level.format = format;
+      level.stored = format == TextureFormat::RAW ? pixels : compressTexture(pixels.data(),width,height,tex.channels,format);
+    }
+    tex.levels.push_back(std::move(level));
+    if(tail)break;
+    pixels = downsampleImage(pixels,width,height,tex.channels);
+    width  = std::max(width /2,1u);
+    height = std::max(height/2,1u);
+  }while(true);
+  tex.levels.back().data = std::move(pixels);
+  tex.bound = (uint32_t)tex.levels.size()-1;
+  tex.valid = true;
+}
+
+/**
+ * @brief This function prepares all textures on worker threads, at most maxLoads images are decoded at once.
+ */
+void TextureStreamer::finishLoading(){
+  for(size_t first=0;first<textures.size();first+=maxLoads){
+    for(size_t t=first;t<std::min(first+maxLoads,textures.size());++t)
+      pool->add([this,t]{prepareTexture(t);});
+    pool->wait();
+  }
+  for(auto const&tex:textures){
+    if(!tex.valid)continue;
+    stats.tailBytes += tex.levels.back().data.size();
+    for(auto const&level:tex.levels)stats.storedBytes += level.stored.size();
+  }
+}
+
+/**
+ * @brief This function creates pixels of level, it is called from worker threads.
+ * Full resolution is decoded from the image, other levels from their stored blocks.
+ *
+ * @param texture texture id
+ * @param level level
+ *
+ * @return pixels of level, zeros if image could not be decoded again
+ */
+std::vector<uint8_t>TextureStreamer::createLevel(size_t texture,uint32_t level)const{
+  auto const&tex = textures[texture];
+  Level const&lv = tex.levels[level];
+  if(level)return decompressTexture(lv.stored.data(),lv.width,lv.height,tex.channels,lv.format);
+  std::vector<uint8_t>pixels;
+  uint32_t width = 0,height = 0,channels = 0;
+  if(!tex.decoder(pixels,width,height,channels) || width != lv.width || height != lv.height || channels != tex.channels)
+    pixels.assign(levelBytes(texture,level),0);
+  return pixels;
+}
+
+size_t TextureStreamer::levelBytes(size_t texture,uint32_t level)const{
+  auto const&tex = textures[texture];
+  return (size_t)tex.levels[level].width*tex.levels[level].height*tex.channels;
+}
+
+/**
+ * @brief This function returns bytes that creation of level holds at most.
+ * Decoder of full resolution may keep its own copy of the image next to the returned one.
+ */
+size_t TextureStreamer::loadBytes(size_t texture,uint32_t level)const{
+  return level ? levelBytes(texture,level) : 2*levelBytes(texture,level);
+}
+
+/**
+ * @brief This function returns the finest resident level that is not finer than requested level.
+ */
+uint32_t TextureStreamer::bestResident(size_t texture,uint32_t level)const{
+  auto const&levels = textures[texture].levels;
+  for(uint32_t l=level;l+1<levels.size();++l)
+    if(!levels[l].data.empty())return l;
+  return (uint32_t)levels.size()-1;
+}
+
+/**
+ * @brief This function evicts least recently used levels until given number of bytes fits into budget.
+ * Levels used in the current frame and tails are never evicted.
+ *
+ * @param bytes size of new level
+ *
+ * @return false if there is not enough space
+ */
+bool TextureStreamer::makeRoom(size_t bytes){
+  if(bytes > budget)return false;
+  while(stats.residentBytes + reserved + bytes > budget){
+    Level*victim = nullptr;
+    for(auto&tex:textures)
+      for(size_t l=0;l+1<tex.levels.size();++l){
+        Level&level = tex.levels[l];
+        if(level.data.empty() || level.lastUse >= frame)continue;
+        if(!victim || level.lastUse < victim->lastUse)victim = &level;
+      }
+    if(!victim)return false;
+    stats.residentBytes -= victim->data.size();
+    std::vector<uint8_t>().swap(victim->data);
+    stats.evictions++;
+  }
+  return true;
+}
+
+Texture TextureStreamer::makeTexture(size_t texture,uint32_t level)const{
+  Texture res;
+  auto const&tex = textures[texture];
+  if(!tex.valid)return res;
+  res.data     = tex.levels[level].data.data();
+  res.width    = tex.levels[level].width;
+  res.height   = tex.levels[level].height;
+  res.channels = tex.channels;
+  res.level    = level;
+  return res;
+}
+
+/**
+ * @brief This function is called once per frame.
+ * It takes finished loads, starts loads of requested levels and binds the best resident levels.
+ *
+ * @param out textures of model, they are rebound to resident levels
+ * @param levels finest level requested for each texture, UINT32_MAX if texture was not used
+ *
+ * @return true if some texture was rebound
+ */
+bool TextureStreamer::update(std::vector<Texture>&out,std::vector<uint32_t>const&levels){
+  frame++;
+  std::vector<LoadedLevel>finished;
+  {
+    std::lock_guard<std::mutex>lock(mutex);
+    finished.swap(loaded);
+  }
+  for(auto&l:finished){
+    Level&level = textures[l.texture].levels[l.level];
+    level.loading = false;
+    loading--;
+    reserved -= l.reserved;
+    stats.residentBytes += l.data.size();
+    level.data = std::move(l.data);
+    stats.loads++;
+  }
+  auto requested = [&](size_t t){
+    if(t >= levels.size() || levels[t] == UINT32_MAX)return UINT32_MAX;
+    return std::min(levels[t],(uint32_t)textures[t].levels.size()-1);
+  };
+
+  // levels in use are protected from eviction before anything is loaded
+  for(size_t t=0;t<textures.size();++t){
+    uint32_t const level = requested(t);
+    if(!textures[t].valid || level == UINT32_MAX)continue;
+    textures[t].levels[level].lastUse = frame;
+    textures[t].levels[bestResident(t,level)].lastUse = frame;
+  }
+
+  for(size_t t=0;t<textures.size() && loading<maxLoads;++t){
+    uint32_t const level = requested(t);
+    if(!textures[t].valid || level == UINT32_MAX)continue;
+    Level&lv = textures[t].levels[level];
+    size_t const bytes = loadBytes(t,level);
+    if(!lv.data.empty() || lv.loading || !makeRoom(bytes))continue;
+    lv.loading = true;
+    loading++;
+    reserved += bytes;
+    pool->add([this,t,level,bytes]{
+      std::vector<uint8_t>pixels = createLevel(t,level);
+      std::lock_guard<std::mutex>lock(mutex);
+      loaded.push_back({t,level,bytes,std::move(pixels)});
+    });
+  }
+  stats.peakBytes = std::max(stats.peakBytes,stats.residentBytes+reserved);
+
+  bool changed = false;
+  if(out.size() < textures.size())out.resize(textures.size());
+  for(size_t t=0;t<textures.size();++t){
+    auto&tex = textures[t];
+    if(!tex.valid)continue;
+    uint32_t const level = requested(t);
+    tex.bound = bestResident(t,level != UINT32_MAX ? level : tex.bound);
+    Texture const bound = makeTexture(t,tex.bound);
+    if(out[t].data == bound.data && out[t].level == bound.level)continue;
+    out[t] = bound;
+    changed = true;
+  }
+  return changed;
+}
+
+/**
+ * @brief This function waits until all started loads are finished.
+ * Loaded levels are taken by the next update.
+ */
+void TextureStreamer::wait(){
+  pool->wait();
+}
+
+/**
+ * @brief This function returns currently bound level of texture.
+ *
+ * @param texture texture id
+ *
+ * @return texture, empty if image could not be decoded
+ */
+Texture TextureStreamer::getTexture(size_t texture)const{
+  return makeTexture(texture,textures[texture].bound);
+}
+
+/**
+ * @brief This function returns number of levels of texture (full resolution down to tail).
+ *
+ * @param texture texture id
+ *
+ * @return number of levels, 0 if image could not be decoded
+ */
+uint32_t TextureStreamer::nofLevels(size_t texture)const{
+  return textures[texture].valid ? (uint32_t)textures[texture].levels.size() : 0;
+}
+
+/**
+ * @brief This function returns statistics of streaming.
+ *
+ * @return statistics
+ */
+TextureStreamingStats TextureStreamer::getStats()const{
+  return stats;
+}
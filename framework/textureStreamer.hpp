@@ -0,0 +1,114 @@
+/*!
+ * @file
+ * @brief This file contains streaming of texture mip levels under memory budget
+ *
+ * @author Martin Zmitko, xzmitk01@stud.fit.vutbr.cz
+ */
+
+#pragma once
+
+#include<cstdint>
+#include<functional>
+#include<memory>
+#include<mutex>
+#include<vector>
+
+#include<framework/threadPool.hpp>
+#include<student/fwd.hpp>
+
+/**
+ * @brief Function that decodes full resolution image of texture.
+ * It is called from worker threads once at load and whenever the full resolution level has to be created.
+ * It may hold one temporary copy of the decoded image, the streamer reserves budget for it.
+ */
+using TextureDecoder = std::function<bool(std::vector<uint8_t>&pixels,uint32_t&width,uint32_t&height,uint32_t&channels)>;
+
+uint32_t const textureTailSize = 64;///< levels at most this large are created at load time and never evicted
+
+/**
+ * @brief This struct holds statistics of texture streaming
+ */
+//! [TextureStreamingStats]
+struct TextureStreamingStats{
+  size_t   residentBytes = 0;///< bytes of streamed levels currently held (tails are not counted)
+  size_t   peakBytes     = 0;///< largest residentBytes together with bytes reserved for running loads so far
+  size_t   tailBytes     = 0;///< bytes of always resident tail levels
+  size_t   storedBytes   = 0;///< bytes of compressed copies of levels between full resolution and tail
+  uint32_t loads         = 0;///< number of levels created
+  uint32_t evictions     = 0;///< number of levels freed to fit budget
+};
+//! [TextureStreamingStats]
+
+/**
+ * @brief This class keeps only mip levels of textures that are needed, under byte budget.
+ * Every texture always has its tail level (at most textureTailSize large) resident.
+ * Levels between full resolution and tail are built once at load and kept as BC1/BC3 blocks,
+ * so creating a level decodes only that level; the full resolution level is decoded from the image.
+ * Levels are created on worker threads when they are requested and are evicted
+ * in least recently used order when budget is exceeded. Levels being created count into budget
+ * together with temporary memory of their decoding. Until requested level is resident,
+ * the finest resident coarser level is bound instead.
+ */
+class TextureStreamer{
+  public:
+    TextureStreamer(size_t budget,uint32_t nofThreads = 0,uint32_t maxLoads = 2);
+    ~TextureStreamer();
+    void addTexture(TextureDecoder const&decoder);
+    void finishLoading();
+    bool update(std::vector<Texture>&textures,std::vector<uint32_t>const&levels);
+    void wait();
+    Texture getTexture(size_t texture)const;
+    uint32_t nofLevels(size_t texture)const;
+    TextureStreamingStats getStats()const;
+  protected:
+    /**
+     * @brief One mip level of texture
+     */
+    struct Level{
+      std::vector<uint8_t>data                         ;///< pixels, empty if level is not resident
+      std::vector<uint8_t>stored                       ;///< level in stored format, empty for full resolution and tail
+      TextureFormat       format   = TextureFormat::RAW;///< format of stored level
+      uint32_t            width    = 0                 ;///< width of level
+      uint32_t            height   = 0                 ;///< height of level
+      uint64_t            lastUse  = 0                 ;///< frame of the last use
+      bool                loading  = false             ;///< level is being created on worker thread
+    };
+    /**
+     * @brief Texture with all its levels
+     */
+    struct StreamedTexture{
+      TextureDecoder    decoder             ;///< creates full resolution image
+      std::vector<Level>levels              ;///< levels from full resolution to tail
+      uint32_t          channels = 4        ;///< number of channels
+      uint32_t          bound    = 0        ;///< level bound to the model texture
+      bool              valid    = false    ;///< image was decoded
+    };
+    /**
+     * @brief Level created by worker thread that is waiting for update
+     */
+    struct LoadedLevel{
+      size_t              texture ;///< texture id
+      uint32_t            level   ;///< level
+      size_t              reserved;///< bytes reserved for the load
+      std::vector<uint8_t>data    ;///< pixels
+    };
+    Texture makeTexture(size_t texture,uint32_t level)const;
+    uint32_t bestResident(size_t texture,uint32_t level)const;
+    bool makeRoom(size_t bytes);
+    size_t levelBytes(size_t texture,uint32_t level)const;
+    size_t loadBytes(size_t texture,uint32_t level)const;
+    void prepareTexture(size_t texture);
+    std::vector<uint8_t>createLevel(size_t texture,uint32_t level)const;
+    size_t                      budget   = 0 ;///< maximal bytes of streamed levels
+    uint32_t                    maxLoads = 2 ;///< maximal number of levels created at once
+    uint32_t                    loading  = 0 ;///< number of levels being created
+    uint64_t                    frame    = 0 ;///< number of update calls
+    size_t                      reserved = 0 ;///< bytes of levels being loaded and of their temporary memory
+    std::vector<StreamedTexture>textures     ;///< streamed textures
+    std::vector<LoadedLevel>    loaded       ;///< finished loads, guarded by mutex
+    std::mutex                  mutex        ;///< guards loaded
+    TextureStreamingStats       stats        ;///< statistics
+    std::unique_ptr<ThreadPool> pool         ;///< loading threads, destroyed first
+};
+
+std::vector<uint8_t>downsampleImage(std::vector<uint8_t>const&pixels,uint32_t width,uint32_t height,uint32_t channels);
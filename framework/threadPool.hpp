@@ -0,0 +1,115 @@
+/*!
+ * @file
+ * @brief This file contains simple thread pool
+ *
+ * @author Martin Zmitko, xzmitk01@stud.fit.vutbr.cz
+ */
+
+#pragma once
+
+#include<algorithm>
+#include<atomic>
+#include<chrono>
+#include<condition_variable>
+#include<cstdint>
+#include<deque>
+#include<functional>
+#include<mutex>
+#include<thread>
+#include<vector>
+
+/**
+ * @brief This class represents a pool of worker threads executing queued tasks
+ */
+class ThreadPool{
+  public:
+    /**
+     * @brief Constructor, starts worker threads
+     *
+     * @param nofThreads number of threads, 0 selects number of hardware threads
+     */
+    ThreadPool(uint32_t nofThreads = 0){
+      if(!nofThreads)nofThreads = std::max(std::thread::hardware_concurrency(),1u);
+      for(uint32_t i=0;i<nofThreads;++i)
+        workers.emplace_back([this]{work();});
+    }
+    /**
+     * @brief Destructor, finishes all queued tasks and joins threads
+     */
+    ~ThreadPool(){
+      {
+        std::lock_guard<std::mutex>lock(mutex);
+        stopping = true;
+      }
+      taskAdded.notify_all();
+      for(auto&w:workers)w.join();
+    }
+    /**
+     * @brief This function queues task
+     *
+     * @param task task
+     */
+    void add(std::function<void()>const&task){
+      {
+        std::lock_guard<std::mutex>lock(mutex);
+        tasks.push_back(task);
+        ++unfinished;
+      }
+      taskAdded.notify_one();
+    }
+    /**
+     * @brief This function blocks until all queued tasks are finished.
+     */
+    void wait(){
+      std::unique_lock<std::mutex>lock(mutex);
+      taskFinished.wait(lock,[this]{return unfinished == 0;});
+    }
+    /**
+     * @brief This function returns number of worker threads.
+     *
+     * @return number of threads
+     */
+    uint32_t size()const{
+      return (uint32_t)workers.size();
+    }
+    /**
+     * @brief This function returns time spent by all threads in tasks.
+     *
+     * @return busy time in seconds
+     */
+    double getBusyTime()const{
+      return (double)busy.load(std::memory_order_relaxed)*1e-9;
+    }
+  protected:
+    /**
+     * @brief Loop of worker thread
+     */
+    void work(){
+      for(;;){
+        std::function<void()>task;
+        {
+          std::unique_lock<std::mutex>lock(mutex);
+          taskAdded.wait(lock,[this]{return stopping || !tasks.empty();});
+          if(tasks.empty())return;
+          task = std::move(tasks.front());
+          tasks.pop_front();
+        }
+        auto const start = std::chrono::steady_clock::now();
+        task();
+        busy.fetch_add((uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now()-start).count(),std::memory_order_relaxed);
+        {
+          std::lock_guard<std::mutex>lock(mutex);
+          --unfinished;
+        }
+        taskFinished.notify_all();
+      }
+    }
+    std::vector<std::thread>         workers          ;///< worker threads
+    std::deque<std::function<void()>>tasks            ;///< queued tasks
+    std::mutex                       mutex            ;///< guards tasks and counters
+    std::condition_variable          taskAdded        ;///< signalled when task is queued or pool stops
+    std::condition_variable          taskFinished     ;///< signalled when task is finished
+    size_t                           unfinished = 0   ;///< number of queued and running tasks
+    bool                             stopping   = false;///< pool is being destroyed
+    std::atomic<uint64_t>            busy       = {0}  ;///< nanoseconds spent in tasks
+};
@@ -0,0 +1,190 @@
+/*!
+ * @file
+ * @brief This file contains scoped trace zones recorded into thread local ring buffers and their export to Chrome trace JSON
+ *
+ * @author Martin Zmitko, xzmitk01@stud.fit.vutbr.cz
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <framework/trace.hpp>
+
+namespace trace{
+
+std::atomic<bool>enabled = {false};
+
+/**
+ * @brief This struct holds ring buffer of one thread, it is written only by its thread
+ */
+struct ThreadBuffer{
+  std::vector<TraceEvent>events    ;///< ring of events
+  std::atomic<uint64_t>  count = {0};///< number of recorded events, the last events.size() are stored
+  uint32_t               tid   = 0  ;///< id of thread in trace
+  std::string            name       ;///< name of thread in trace
+};
+
+std::mutex                               mutex                 ;///< guards registry of buffers
+std::vector<std::shared_ptr<ThreadBuffer>>buffers              ;///< buffers of all threads that recorded something
+std::atomic<uint32_t>                    capacity = {1<<16}    ;///< size of newly created buffers
+std::atomic<uint32_t>                    frame    = {0}        ;///< current frame
+std::chrono::steady_clock::time_point    epoch    = std::chrono::steady_clock::now();
+
+/**
+ * @brief This function returns buffer of calling thread, it creates it if it does not exist.
+ *
+ * @return buffer
+ */
+ThreadBuffer&localBuffer(){
+  static thread_local std::shared_ptr<ThreadBuffer>local;
+  if(!local){
+    local = std::make_shared<ThreadBuffer>();
+    local->events.resize(std::max(capacity.load(),1u));
+    std::lock_guard<std::mutex>lock(mutex);
+    local->tid = (uint32_t)buffers.size()+1;
+    buffers.push_back(local);
+  }
+  return *local;
+}
+
+/**
+ * @brief This function returns time from start of tracing.
+ *
+ * @return time in nanoseconds
+ */
+uint64_t now(){
+  return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now()-epoch).count();
+}
+
+/**
+ * @brief This function stores finished zone into ring buffer of calling thread.
+ *
+ * @param name name of zone
+ * @param begin start of zone
+ * @param end end of zone
+ */
+void record(char const*name,uint64_t begin,uint64_t end){
+  auto&b = localBuffer();
+  uint64_t const i = b.count.load(std::memory_order_relaxed);
+  b.events[i%b.events.size()] = TraceEvent{name,begin,end,frame.load(std::memory_order_relaxed)};
+  b.count.store(i+1,std::memory_order_release);
+}
+
+void writeEscaped(std::ostream&out,std::string const&s){
+  for(char c:s){
+    if(c == '"' || c == '\\')out << '\\';
+    out << c;
+  }
+}
+
+}
+
+/**
+ * @brief This function starts recording of trace zones.
+ *
+ * @param capacity number of events kept by every thread
+ */
+void startTracing(uint32_t capacity){
+  trace::capacity = capacity;
+  trace::epoch    = std::chrono::steady_clock::now();
+  trace::enabled  = true;
+}
+
+/**
+ * @brief This function stops recording of trace zones, recorded zones are kept.
+ */
+void stopTracing(){
+  trace::enabled = false;
+}
+
+/**
+ * @brief This function marks start of the next frame, zones are written per frames.
+ */
+void traceNextFrame(){
+  trace::frame.fetch_add(1,std::memory_order_relaxed);
+}
+
+/**
+ * @brief This function names calling thread in trace.
+ *
+ * @param name name of thread
+ */
+void setTraceThreadName(std::string const&name){
+  auto&b = trace::localBuffer();
+  std::lock_guard<std::mutex>lock(trace::mutex);
+  b.name = name;
+}
+
+/**
+ * @brief This function writes recorded zones of the last frames in Chrome trace_event JSON format
+ * (chrome://tracing, ui.perfetto.dev).
+ * Threads should not record zones while trace is written.
+ *
+ * @param file output file
+ * @param lastFrames number of written frames, 0 writes all recorded zones
+ *
+ * @return true if trace was written
+ */
+bool writeTrace(std::string const&file,uint32_t lastFrames){
+  std::ofstream out(file);
+  if(!out.is_open())return false;
+  uint32_t const current = trace::frame.load();
+  uint32_t const firstFrame = lastFrames && current >= lastFrames ? current-lastFrames+1 : 0;
+
+  std::lock_guard<std::mutex>lock(trace::mutex);
+  out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+  bool first = true;
+  auto const separator = [&]{
+    out << (first ? "\n" : ",\n");
+    first = false;
+  };
+  out << std::fixed << std::setprecision(3);
+  for(auto const&b:trace::buffers){
+    separator();
+    out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << b->tid << ",\"args\":{\"name\":\"";
+    trace::writeEscaped(out,b->name.empty() ? "thread "+std::to_string(b->tid) : b->name);
+    out << "\"}}";
+    uint64_t const count = b->count.load(std::memory_order_acquire);
+    uint64_t const size  = b->events.size();
+    for(uint64_t i=count > size ? count-size : 0;i<count;++i){
+      auto const&e = b->events[i%size];
+      if(e.frame < firstFrame)continue;
+      separator();
+      out << "{\"name\":\"" << e.name << "\",\"cat\":\"izg\",\"ph\":\"X\",\"pid\":1,\"tid\":" << b->tid
+          << ",\"ts\":" << e.begin/1000. << ",\"dur\":" << (e.end-e.begin)/1000.
+          << ",\"args\":{\"frame\":" << e.frame << "}}";
+    }
+  }
+  out << "\n]}\n";
+  return out.good();
+}
+
+/**
+ * @brief Constructor, starts tracing if file is not empty
+ *
+ * @param file output file
+ * @param lastFrames number of written frames
+ */
+TraceRecording::TraceRecording(std::string const&file,uint32_t lastFrames):file(file),lastFrames(lastFrames){
+  if(file.empty())return;
+  setTraceThreadName("main");
+  startTracing();
+}
+
+/**
+ * @brief Destructor, stops tracing and writes trace
+ */
+TraceRecording::~TraceRecording(){
+  if(file.empty())return;
+  stopTracing();
+  if(writeTrace(file,lastFrames))
+    std::cerr << "trace of the last " << lastFrames << " frames is stored in " << file << std::endl;
+  else
+    std::cerr << "trace: file \"" << file << "\" cannot be written" << std::endl;
+}
@@ -0,0 +1,76 @@
+/*!
+ * @file
+ * @brief This file contains scoped trace zones recorded into thread local ring buffers and their export to Chrome trace JSON
+ *
+ * @author Martin Zmitko, xzmitk01@stud.fit.vutbr.cz
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+//! [TraceEvent]
+/**
+ * @brief This struct holds one finished trace zone
+ */
+struct TraceEvent{
+  char const*name  = nullptr;///< name of zone, it has to be string literal
+  uint64_t   begin = 0      ;///< start of zone in nanoseconds from start of tracing
+  uint64_t   end   = 0      ;///< end of zone in nanoseconds from start of tracing
+  uint32_t   frame = 0      ;///< frame in which zone started
+};
+//! [TraceEvent]
+
+namespace trace{
+extern std::atomic<bool>enabled;///< zones are recorded only when tracing is started
+uint64_t now();
+void record(char const*name,uint64_t begin,uint64_t end);
+}
+
+/**
+ * @brief This class records time between its construction and destruction into ring buffer of calling thread.
+ * It costs one relaxed load when tracing is not started.
+ */
+class TraceZone{
+  public:
+    TraceZone(char const*name):name(trace::enabled.load(std::memory_order_relaxed) ? name : nullptr){
+      if(this->name)begin = trace::now();
+    }
+    ~TraceZone(){
+      if(name)trace::record(name,begin,trace::now());
+    }
+    TraceZone(TraceZone const&) = delete;
+    TraceZone&operator=(TraceZone const&) = delete;
+  protected:
+    char const*name ;///< name of zone, nullptr if zone is not recorded
+    uint64_t   begin;///< start of zone
+};
+
+#define IZG_TRACE_CONCAT_(a,b) a##b
+#define IZG_TRACE_CONCAT(a,b) IZG_TRACE_CONCAT_(a,b)
+#ifdef IZG_TRACING
+/// records zone from this line to the end of scope
+#define IZG_TRACE_ZONE(name) TraceZone const IZG_TRACE_CONCAT(izgTraceZone,__LINE__)(name)
+#else
+#define IZG_TRACE_ZONE(name)
+#endif
+
+void startTracing(uint32_t capacity = 1<<16);
+void stopTracing();
+void traceNextFrame();
+void setTraceThreadName(std::string const&name);
+bool writeTrace(std::string const&file,uint32_t lastFrames);
+
+/**
+ * @brief This class starts tracing and writes trace of the last frames when it is destroyed
+ */
+class TraceRecording{
+  public:
+    TraceRecording(std::string const&file,uint32_t lastFrames);
+    ~TraceRecording();
+  protected:
+    std::string file      ;///< output file, empty = tracing is not started
+    uint32_t    lastFrames;///< number of written frames
+};
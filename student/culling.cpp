@@ -0,0 +1,282 @@
+/*!
+ * @file
+ * @brief This file contains bounding volumes and visibility tests
+ *
+ * @author Martin Zmitko, xzmitk01@stud.fit.vutbr.cz
+ */
+#include <student/culling.hpp>
+#include <student/gpu.hpp>
+#include <student/meshAccess.hpp>
+
+void drawTrianglesImpl(GPUContext&,uint32_t);
+
+/**
+ * @brief This function computes bounding box and sphere of mesh from its vertices.
+ * If the box is already known (e.g. from glTF accessor) only the sphere is derived from it.
+ *
+ * @param mesh mesh
+ */
+void computeMeshBounds(Mesh &mesh){
+  if(glm::any(glm::greaterThan(mesh.aabbMin, mesh.aabbMax))){
+    if(!mesh.position.bufferData || mesh.nofIndices == 0)return;
+    if(mesh.position.type != AttributeType::VEC3 && mesh.position.type != AttributeType::VEC4)return;
+    mesh.aabbMin = glm::vec3(+INFINITY);
+    mesh.aabbMax = glm::vec3(-INFINITY);
+    for(uint32_t i = 0; i < mesh.nofIndices; i++){
+      glm::vec3 p = vertexPosition(mesh.position, readIndex(mesh, i));
+      mesh.aabbMin = glm::min(mesh.aabbMin, p);
+      mesh.aabbMax = glm::max(mesh.aabbMax, p);
+    }
+  }
+  glm::vec3 center = (mesh.aabbMin + mesh.aabbMax) * .5f;
+  mesh.boundingSphere = glm::vec4(center, glm::length(mesh.aabbMax - center));
+}
+
+/**
+ * @brief This function computes how many texture coordinate units span one model space unit of mesh surface.
+ * It is square root of ratio of texture coordinate area and surface area of all triangles.
+ *
+ * @param mesh mesh, its uvDensity is filled
+ */
+void computeMeshUvDensity(Mesh &mesh){
+  mesh.uvDensity = 0.f;
+  if(!mesh.position.bufferData || !mesh.texCoord.bufferData || mesh.texCoord.type != AttributeType::VEC2)return;
+  if(mesh.position.type != AttributeType::VEC3 && mesh.position.type != AttributeType::VEC4)return;
+  double area = 0., uvArea = 0.;
+  for(uint32_t i = 0; i + 2 < mesh.nofIndices; i += 3){
+    uint32_t const v0 = readIndex(mesh, i), v1 = readIndex(mesh, i + 1), v2 = readIndex(mesh, i + 2);
+    glm::vec3 p0 = vertexPosition(mesh.position, v0), p1 = vertexPosition(mesh.position, v1), p2 = vertexPosition(mesh.position, v2);
+    glm::vec2 t0 = vertexTexCoord(mesh.texCoord, v0), t1 = vertexTexCoord(mesh.texCoord, v1), t2 = vertexTexCoord(mesh.texCoord, v2);
+    area += glm::length(glm::cross(p1 - p0, p2 - p0));
+    glm::vec2 a = t1 - t0, b = t2 - t0;
+    uvArea += glm::abs(a.x * b.y - a.y * b.x);
+  }
+  if(area > 0.)mesh.uvDensity = (float)std::sqrt(uvArea / area);
+}
+
+/**
+ * @brief This function returns true if mesh has known bounding box.
+ *
+ * @param mesh mesh
+ *
+ * @return true if bounds are known
+ */
+bool hasBounds(Mesh const &mesh){
+  return !glm::any(glm::greaterThan(mesh.aabbMin, mesh.aabbMax));
+}
+
+/**
+ * @brief This function returns true if box contains nothing.
+ *
+ * @param box box
+ *
+ * @return true if box is empty
+ */
+bool isEmpty(AABB const &box){
+  return glm::any(glm::greaterThan(box.min, box.max));
+}
+
+/**
+ * @brief This function returns true if box has finite extent.
+ * Unbounded boxes represent geometry with unknown bounds and are never culled.
+ *
+ * @param box box
+ *
+ * @return true if box is finite
+ */
+bool isBounded(AABB const &box){
+  return !glm::any(glm::isinf(box.min)) && !glm::any(glm::isinf(box.max));
+}
+
+/**
+ * @brief This function computes union of two boxes.
+ *
+ * @param a first box
+ * @param b second box
+ *
+ * @return box containing both boxes
+ */
+AABB unite(AABB const &a, AABB const &b){
+  AABB res;
+  res.min = glm::min(a.min, b.min);
+  res.max = glm::max(a.max, b.max);
+  return res;
+}
+
+/**
+ * @brief This function transforms box and returns axis aligned box containing the result.
+ *
+ * @param m transformation matrix (affine)
+ * @param min minimal corner
+ * @param max maximal corner
+ *
+ * @return transformed box
+ */
+AABB transformAABB(glm::mat4 const &m, glm::vec3 const &min, glm::vec3 const &max){
+  glm::vec3 center = glm::vec3(m * glm::vec4((min + max) * .5f, 1.f));
+  glm::vec3 extent = (max - min) * .5f;
+  glm::mat3 absM = glm::mat3(glm::abs(glm::vec3(m[0])), glm::abs(glm::vec3(m[1])), glm::abs(glm::vec3(m[2])));
+  extent = absM * extent;
+  AABB res;
+  res.min = center - extent;
+  res.max = center + extent;
+  return res;
+}
+
+/**
+ * @brief This function extracts frustum planes from projection-view matrix.
+ *
+ * @param viewProj proj*view matrix
+ *
+ * @return frustum in world space
+ */
+Frustum extractFrustum(glm::mat4 const &viewProj){
+  glm::vec4 row[4];
+  for(uint32_t i = 0; i < 4; i++)
+    row[i] = glm::vec4(viewProj[0][i], viewProj[1][i], viewProj[2][i], viewProj[3][i]);
+
+  Frustum res;
+  res.planes[0] = row[3] + row[0];
+  res.planes[1] = row[3] - row[0];
+  res.planes[2] = row[3] + row[1];
+  res.planes[3] = row[3] - row[1];
+  res.planes[4] = row[3] + row[2];
+  return res;
+}
+
+/**
+ * @brief This function tests box against frustum.
+ * It is conservative, some boxes outside of frustum near its corners are reported visible.
+ *
+ * @param frustum frustum
+ * @param box world space box
+ *
+ * @return false if box is completely outside of frustum
+ */
+bool isVisible(Frustum const &frustum, AABB const &box){
+  if(isEmpty(box))return false;
+  if(!isBounded(box))return true;
+  for(glm::vec4 const &plane : frustum.planes){
+    // corner of box that is farthest along plane normal
+    glm::vec3 p = glm::vec3(
+        plane.x >= 0.f ? box.max.x : box.min.x,
+        plane.y >= 0.f ? box.max.y : box.min.y,
+        plane.z >= 0.f ? box.max.z : box.min.z);
+    if(glm::dot(glm::vec3(plane), p) + plane.w < 0.f)return false;
+  }
+  return true;
+}
+
+/**
+ * @brief This function tests sphere against frustum.
+ *
+ * @param frustum frustum
+ * @param sphere world space center (xyz) and radius (w)
+ *
+ * @return false if sphere is completely outside of frustum
+ */
+bool isVisible(Frustum const &frustum, glm::vec4 const &sphere){
+  for(glm::vec4 const &plane : frustum.planes)
+    if(glm::dot(glm::vec3(plane), glm::vec3(sphere)) + plane.w < -sphere.w * glm::length(glm::vec3(plane)))return false;
+  return true;
+}
+
+/**
+ * @brief This function projects box to screen.
+ *
+ * @param viewProj proj*view matrix
+ * @param box world space box
+ * @param rect output rectangle covered by the box
+ *
+ * @return false if the box reaches in front of near plane (rectangle is unknown)
+ */
+bool projectAABB(glm::mat4 const &viewProj, AABB const &box, ScreenRect &rect){
+  if(!isBounded(box) || isEmpty(box))return false;
+  rect.min = glm::vec2(+INFINITY);
+  rect.max = glm::vec2(-INFINITY);
+  rect.minDepth = +INFINITY;
+  for(uint32_t i = 0; i < 8; i++){
+    glm::vec4 corner = glm::vec4(
+        i & 1 ? box.max.x : box.min.x,
+        i & 2 ? box.max.y : box.min.y,
+        i & 4 ? box.max.z : box.min.z, 1.f);
+    glm::vec4 clip = viewProj * corner;
+    if(clip.z < -clip.w || clip.w <= 0.f)return false;
+    glm::vec3 ndc = glm::vec3(clip) / clip.w;
+    rect.min = glm::min(rect.min, glm::vec2(ndc));
+    rect.max = glm::max(rect.max, glm::vec2(ndc));
+    rect.minDepth = glm::min(rect.minDepth, ndc.z);
+  }
+  return true;
+}
+
+/**
+ * @brief This function resizes and clears occlusion buffer.
+ *
+ * @param buffer occlusion buffer
+ * @param width width of buffer
+ * @param height height of buffer
+ */
+void clearOcclusionBuffer(OcclusionBuffer &buffer, uint32_t width, uint32_t height){
+  buffer.width = width;
+  buffer.height = height;
+  buffer.depth.assign((size_t)width * height, 10e10f);
+  buffer.color.resize((size_t)width * height * 4);
+}
+
+void occluder_vertexShader(OutVertex &outVertex, InVertex const &inVertex, Uniforms const &uniforms){
+  outVertex.gl_Position = uniforms.uniform[0].m4 * glm::vec4(inVertex.attributes[0].v3, 1.f);
+}
+
+void occluder_fragmentShader(OutFragment &outFragment, InFragment const &, Uniforms const &){
+  outFragment.gl_FragColor = glm::vec4(1.f); // opaque, so depth is always written
+}
+
+/**
+ * @brief This function rasterizes depth of mesh into occlusion buffer using the regular rasterizer.
+ * Work of this pre-pass is not added to gpuCounters, they only count drawing of the frame.
+ *
+ * @param buffer occlusion buffer
+ * @param mesh occluder mesh
+ * @param viewProj proj*view matrix
+ * @param modelMatrix world matrix of mesh
+ */
+void rasterizeOccluder(OcclusionBuffer &buffer, Mesh const &mesh, glm::mat4 const &viewProj, glm::mat4 const &modelMatrix){
+  GPUContext ctx;
+  ctx.frame.color = buffer.color.data();
+  ctx.frame.depth = buffer.depth.data();
+  ctx.frame.width = buffer.width;
+  ctx.frame.height = buffer.height;
+  ctx.prg.vertexShader = occluder_vertexShader;
+  ctx.prg.fragmentShader = occluder_fragmentShader;
+  ctx.prg.uniforms.uniform[0].m4 = viewProj * modelMatrix;
+  ctx.vao.indexBuffer = mesh.indices;
+  ctx.vao.indexType = mesh.indexType;
+  ctx.vao.vertexAttrib[0] = mesh.position;
+  GPUCounters const counters = gpuCounters;
+  drawTrianglesImpl(ctx, mesh.nofIndices);
+  gpuCounters = counters;
+}
+
+/**
+ * @brief This function tests whether screen rectangle is hidden behind rasterized occluders.
+ * The rectangle is enlarged by one pixel, because occluders only cover pixels whose centers they contain.
+ *
+ * @param buffer occlusion buffer
+ * @param rect projected bounds
+ *
+ * @return true if every pixel of the rectangle has occluder nearer than rect.minDepth
+ */
+bool isOccluded(OcclusionBuffer const &buffer, ScreenRect const &rect){
+  if(buffer.depth.empty())return false;
+  glm::vec2 const size = glm::vec2(buffer.width, buffer.height);
+  glm::ivec2 const lo = glm::ivec2(glm::floor((rect.min * .5f + .5f) * size)) - 1;
+  glm::ivec2 const hi = glm::ivec2(glm::floor((rect.max * .5f + .5f) * size)) + 1;
+  int32_t const x0 = glm::max(lo.x, 0), x1 = glm::min(hi.x, (int32_t)buffer.width  - 1);
+  int32_t const y0 = glm::max(lo.y, 0), y1 = glm::min(hi.y, (int32_t)buffer.height - 1);
+  if(x0 > x1 || y0 > y1)return false;
+  for(int32_t y = y0; y <= y1; y++)
+    for(int32_t x = x0; x <= x1; x++)
+      if(buffer.depth[(size_t)y * buffer.width + x] >= rect.minDepth)return false;
+  return true;
+}
@@ -0,0 +1,84 @@
+/*!
+ * @file
+ * @brief This file contains bounding volumes and visibility tests
+ *
+ * @author Martin Zmitko, xzmitk01@stud.fit.vutbr.cz
+ */
+#pragma once
+
+#include <student/fwd.hpp>
+
+#include <cmath>
+#include <vector>
+
+/**
+ * @brief This struct represents view frustum as planes in world space.
+ * Point p is inside if dot(plane.xyz,p)+plane.w >= 0 for all planes.
+ * The far plane is not included, the pipeline does not clip against it.
+ */
+//! [Frustum]
+struct Frustum{
+  glm::vec4 planes[5];///< left, right, bottom, top and near plane
+};
+//! [Frustum]
+
+/**
+ * @brief This struct represents axis aligned bounding box
+ */
+//! [AABB]
+struct AABB{
+  glm::vec3 min = glm::vec3(+INFINITY);///< minimal corner
+  glm::vec3 max = glm::vec3(-INFINITY);///< maximal corner
+};
+//! [AABB]
+
+/**
+ * @brief This struct represents screen space rectangle covered by projected bounds
+ */
+//! [ScreenRect]
+struct ScreenRect{
+  glm::vec2 min      = glm::vec2(0.f);///< minimal corner in normalized device coordinates
+  glm::vec2 max      = glm::vec2(0.f);///< maximal corner in normalized device coordinates
+  float     minDepth = 0.f           ;///< depth of the nearest point
+};
+//! [ScreenRect]
+
+/**
+ * @brief This struct represents low resolution depth buffer with rasterized occluders
+ */
+//! [OcclusionBuffer]
+struct OcclusionBuffer{
+  std::vector<float  >depth     ;///< depth buffer
+  std::vector<uint8_t>color     ;///< color buffer required by rasterizer (unused)
+  uint32_t            width  = 0;///< width of buffer
+  uint32_t            height = 0;///< height of buffer
+};
+//! [OcclusionBuffer]
+
+void computeMeshBounds(Mesh&mesh);
+
+void computeMeshUvDensity(Mesh&mesh);
+
+bool hasBounds(Mesh const&mesh);
+
+bool isEmpty(AABB const&box);
+
+bool isBounded(AABB const&box);
+
+AABB unite(AABB const&a,AABB const&b);
+
+AABB transformAABB(glm::mat4 const&m,glm::vec3 const&min,glm::vec3 const&max);
+
+Frustum extractFrustum(glm::mat4 const&viewProj);
+
+bool isVisible(Frustum const&frustum,AABB const&box);
+
+bool isVisible(Frustum const&frustum,glm::vec4 const&sphere);
+
+bool projectAABB(glm::mat4 const&viewProj,AABB const&box,ScreenRect&rect);
+
+void clearOcclusionBuffer(OcclusionBuffer&buffer,uint32_t width,uint32_t height);
+
+void rasterizeOccluder(OcclusionBuffer&buffer,Mesh const&mesh,glm::mat4 const&viewProj,glm::mat4 const&modelMatrix);
+
+bool isOccluded(OcclusionBuffer const&buffer,ScreenRect const&rect);
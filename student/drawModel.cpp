@@ -6,47 +6,294 @@
  */
 #include <student/drawModel.hpp>
 #include <student/gpu.hpp>
+#include <student/meshlet.hpp>
+#include <student/scene.hpp>
+#include <framework/trace.hpp>
 
-void drawNode(GPUContext &ctx, Node const &node, Model const &model, glm::mat4 mat){
-  if(node.mesh >= 0){ // ma tento node mesh?
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+void setMeshState(GPUContext &ctx, Model const &model, Mesh const &mesh){
+  ctx.vao.indexType = mesh.indexType;
+  ctx.vao.indexBuffer = mesh.indices;
+  ctx.prg.uniforms.uniform[5].v4 = mesh.diffuseColor;
+  ctx.vao.vertexAttrib[0] = mesh.position;
+  ctx.vao.vertexAttrib[1] = mesh.normal;
+  ctx.vao.vertexAttrib[2] = mesh.texCoord;
+  if(mesh.diffuseTexture >= 0 && model.textures[mesh.diffuseTexture].data){ // texture may still be decoded
+    ctx.prg.uniforms.textures[0] = model.textures[mesh.diffuseTexture];
+    ctx.prg.uniforms.uniform[6].v1 = 1.f;
+  } else {
+    ctx.prg.uniforms.uniform[6].v1 = 0.f;
+    ctx.prg.uniforms.textures[0] = Texture{};
+  }
+}
+
+void drawMeshlets(GPUContext &ctx, Mesh const &mesh, Scene &scene, SceneNode const &node, MeshletView const &view){
+  MeshletInstance const instance = makeMeshletInstance(node.worldMatrix, node.normalMatrix, view.camera);
+  uint8_t const *indices = (uint8_t const*)mesh.indices;
+  uint32_t first = 0, count = 0; // visible meshlets that follow each other are drawn by one call
+  for(uint32_t m = 0; m < mesh.nofMeshlets; m++){
+    Meshlet const &meshlet = mesh.meshlets[m];
+    if(!isMeshletVisible(meshlet, instance, view)){
+      scene.stats.culledMeshlets++;
+      continue;
+    }
+    scene.stats.drawnMeshlets++;
+    scene.stats.submittedTriangles += meshlet.nofIndices / 3;
+    if(count && first + count == meshlet.firstIndex){
+      count += meshlet.nofIndices;
+      continue;
+    }
+    if(count){
+      ctx.vao.indexBuffer = indices + (size_t)first * (size_t)mesh.indexType;
+      drawTriangles(ctx, count);
+    }
+    first = meshlet.firstIndex;
+    count = meshlet.nofIndices;
+  }
+  if(count){
+    ctx.vao.indexBuffer = indices + (size_t)first * (size_t)mesh.indexType;
+    drawTriangles(ctx, count);
+  }
+}
+
+void drawMesh(GPUContext &ctx, Model const &model, Scene &scene, DrawItem const &item, int32_t &lastMesh, MeshletView const *meshletView){
+  IZG_TRACE_ZONE("drawMesh");
+  SceneNode const &node = scene.nodes[item.node];
+  Mesh const &mesh = model.meshes[node.mesh];
+  if(node.mesh != lastMesh) // vao, material and texture stay bound for repeated instances of the same mesh
+    setMeshState(ctx, model, mesh);
+  lastMesh = node.mesh;
+  ctx.prg.uniforms.uniform[1].m4 = node.worldMatrix;
+  ctx.prg.uniforms.uniform[2].m4 = node.normalMatrix;
+
+  if(meshletView && item.lod < 0 && mesh.nofMeshlets){
+    drawMeshlets(ctx, mesh, scene, node, *meshletView);
+    return;
+  }
+
+  uint32_t nofIndices = mesh.nofIndices;
+  ctx.vao.indexBuffer = mesh.indices;
+  if(item.lod >= 0){
+    ctx.vao.indexBuffer = mesh.lods[item.lod].indices;
+    nofIndices = mesh.lods[item.lod].nofIndices;
+    scene.stats.lodTrianglesSaved += (mesh.nofIndices - nofIndices) / 3;
+  }
+  scene.stats.submittedTriangles += nofIndices / 3;
+
+  drawTriangles(ctx, nofIndices);
+}
+
+bool isOpaque(Model const &model, Mesh const &mesh){
+  if(mesh.diffuseTexture >= 0 && model.textures[mesh.diffuseTexture].data)
+    return model.textures[mesh.diffuseTexture].channels < 4;
+  return mesh.diffuseColor.a >= 1.f;
+}
+
+/**
+ * @brief This function collects meshes of scene that can be visible into render queue.
+ * Subtrees whose bounds are outside of the frustum are skipped as a whole.
+ *
+ * @param scene scene with up to date world matrices and bounds
+ * @param frustum view frustum or nullptr if culling is disabled
+ */
+void collectVisibleMeshes(Scene &scene, Frustum const *frustum){
+  scene.queue.clear();
+  for(uint32_t i = 0; i < scene.nodes.size();){
+    SceneNode const &node = scene.nodes[i];
+    if(frustum && !isVisible(*frustum, node.subtreeBounds)){
+      for(uint32_t j = i; j < node.subtreeEnd; j++)
+        scene.stats.frustumCulledMeshes += scene.nodes[j].mesh >= 0;
+      i = node.subtreeEnd;
+      continue;
+    }
+    if(node.mesh >= 0){ // ma tento node mesh?
+      if(!frustum || isVisible(*frustum, node.bounds)){
+        DrawItem item;
+        item.sortKey = i;
+        item.node = i;
+        scene.queue.push_back(item);
+      } else {
+        scene.stats.frustumCulledMeshes++;
+      }
+    }
+    i++;
+  }
+}
+
+/**
+ * @brief This function removes meshes hidden behind occluders from render queue.
+ * Meshes with the largest projected bounds are rasterized into low resolution depth buffer
+ * and bounds of all other queued meshes are tested against it.
+ *
+ * @param scene scene with filled render queue
+ * @param model model
+ * @param viewProj proj*view matrix
+ * @param settings rendering settings
+ */
+void occlusionCullMeshes(Scene &scene, Model const &model, glm::mat4 const &viewProj, DrawSettings const &settings){
+  auto const nofItems = scene.queue.size();
+  scene.rects.resize(nofItems);
+  scene.occluders.clear();
+
+  auto area = [&](size_t i){
+    glm::vec2 size = (scene.rects[i].max - scene.rects[i].min) * .5f;
+    return size.x * size.y;
+  };
+
+  for(size_t i = 0; i < nofItems; i++){
+    SceneNode const &node = scene.nodes[scene.queue[i].node];
     Mesh const &mesh = model.meshes[node.mesh];
-    ctx.vao.indexType = mesh.indexType;
-    ctx.vao.indexBuffer = mesh.indices;
-    ctx.prg.uniforms.uniform[1].m4 = mat;
-    ctx.prg.uniforms.uniform[2].m4 = glm::transpose(glm::inverse(mat));
-    ctx.prg.uniforms.uniform[5].v4 = mesh.diffuseColor;
-    ctx.vao.vertexAttrib[0] = mesh.position;
-    ctx.vao.vertexAttrib[1] = mesh.normal;
-    ctx.vao.vertexAttrib[2] = mesh.texCoord;
-    if(mesh.diffuseTexture >= 0){
-      ctx.prg.uniforms.textures[0] = model.textures[mesh.diffuseTexture];
-      ctx.prg.uniforms.uniform[6].v1 = 1.f;
-    } else {
-      ctx.prg.uniforms.uniform[6].v1 = 0.f;
-      ctx.prg.uniforms.textures[0] = Texture{};
+    if(!projectAABB(viewProj, node.bounds, scene.rects[i])){
+      scene.rects[i].minDepth = -INFINITY; // never occluded
+      continue;
     }
+    if(mesh.position.bufferData && isOpaque(model, mesh) && area(i) >= settings.minOccluderArea)
+      scene.occluders.push_back((uint32_t)i);
+  }
 
-    drawTriangles(ctx, mesh.nofIndices);
+  if(scene.occluders.size() > settings.maxOccluders){
+    std::partial_sort(scene.occluders.begin(), scene.occluders.begin() + settings.maxOccluders, scene.occluders.end(),
+        [&](uint32_t a, uint32_t b){return area(a) > area(b);});
+    scene.occluders.resize(settings.maxOccluders);
   }
+  if(scene.occluders.empty())return;
 
-  for(Node n : node.children){
-    drawNode(ctx, n, model, mat * n.modelMatrix);
+  clearOcclusionBuffer(scene.occlusion, settings.occlusionWidth, settings.occlusionHeight);
+  for(uint32_t i : scene.occluders){
+    SceneNode const &node = scene.nodes[scene.queue[i].node];
+    rasterizeOccluder(scene.occlusion, model.meshes[node.mesh], viewProj, node.worldMatrix);
+    scene.rects[i].minDepth = -INFINITY; // occluders are drawn
   }
+  scene.stats.occluders = (uint32_t)scene.occluders.size();
+
+  size_t kept = 0;
+  for(size_t i = 0; i < nofItems; i++){
+    if(isOccluded(scene.occlusion, scene.rects[i])){
+      scene.stats.occlusionCulledMeshes++;
+      continue;
+    }
+    scene.queue[kept++] = scene.queue[i];
+  }
+  scene.queue.resize(kept);
 }
 
 /**
- * @brief This function renders a model
+ * @brief This function selects level of detail of queued meshes.
+ * The coarsest level whose error projected to the screen does not exceed the threshold is used.
+ * Error of level bounds distance of the full mesh from its surface and it is projected
+ * from the nearest point of the mesh bounds, so the estimate is conservative.
+ *
+ * @param scene scene with filled render queue
+ * @param model model
+ * @param proj projection matrix
+ * @param camera camera position
+ * @param height height of framebuffer in pixels
+ * @param threshold maximal projected error in pixels
+ */
+void selectLods(Scene &scene, Model const &model, glm::mat4 const &proj, glm::vec3 const &camera, uint32_t height, float threshold){
+  // pixels per unit of world space error at distance 1
+  float const pixelsPerUnit = proj[1][1] * height * .5f;
+  for(DrawItem &item : scene.queue){
+    SceneNode const &node = scene.nodes[item.node];
+    Mesh const &mesh = model.meshes[node.mesh];
+    item.lod = -1;
+    if(!mesh.nofLods || !isBounded(node.bounds))continue;
+
+    float const distance = glm::length(camera - glm::clamp(camera, node.bounds.min, node.bounds.max));
+    if(distance <= 0.f)continue;
+    float const scale = glm::max(glm::length(glm::vec3(node.worldMatrix[0])),
+                        glm::max(glm::length(glm::vec3(node.worldMatrix[1])), glm::length(glm::vec3(node.worldMatrix[2]))));
+    for(uint32_t l = 0; l < mesh.nofLods; l++){
+      if(mesh.lods[l].error * scale / distance * pixelsPerUnit > threshold)break;
+      item.lod = l;
+    }
+  }
+}
+
+/**
+ * @brief This function computes the finest mip level of each texture that drawn meshes need.
+ * One texel of selected level covers at most one pixel at the closest point of mesh bounds,
+ * assuming texture coordinates are spread evenly over the mesh surface (Mesh::uvDensity).
+ *
+ * @param scene scene with filled render queue, its textureLevels are filled
+ * @param model model
+ * @param proj projection matrix
+ * @param camera camera position in world space
+ * @param height height of framebuffer in pixels
+ */
+void selectTextureLevels(Scene &scene, Model const &model, glm::mat4 const &proj, glm::vec3 const &camera, uint32_t height){
+  scene.textureLevels.assign(model.textures.size(), UINT32_MAX);
+  float const pixelsPerUnit = proj[1][1] * height * .5f;
+  for(DrawItem const &item : scene.queue){
+    SceneNode const &node = scene.nodes[item.node];
+    Mesh const &mesh = model.meshes[node.mesh];
+    if(mesh.diffuseTexture < 0 || mesh.diffuseTexture >= (int)model.textures.size())continue;
+    uint32_t &level = scene.textureLevels[mesh.diffuseTexture];
+    if(mesh.uvDensity <= 0.f || !isBounded(node.bounds)){
+      level = 0;
+      continue;
+    }
+    Texture const &texture = model.textures[mesh.diffuseTexture];
+    float const texels = (float)glm::max(texture.width, texture.height) * (float)(1u << texture.level);
+    float const distance = glm::length(camera - glm::clamp(camera, node.bounds.min, node.bounds.max));
+    float const scale = glm::max(glm::length(glm::vec3(node.worldMatrix[0])),
+                        glm::max(glm::length(glm::vec3(node.worldMatrix[1])), glm::length(glm::vec3(node.worldMatrix[2]))));
+    float const texelsPerPixel = scale > 0.f ? texels * mesh.uvDensity / scale * distance / pixelsPerUnit : 0.f;
+    uint32_t const needed = texelsPerPixel > 1.f ? (uint32_t)glm::min(std::log2(texelsPerPixel), 31.f) : 0u;
+    level = glm::min(level, needed);
+  }
+}
+
+/**
+ * @brief This function sorts render queue.
+ * Opaque meshes go first, grouped by texture and sorted front-to-back inside each group,
+ * so the depth test rejects more fragments and texture reads stay local.
+ * Meshes that may blend keep their scene order and are drawn last.
+ *
+ * @param scene scene with filled render queue
+ * @param model model
+ * @param view view matrix
+ */
+void sortRenderQueue(Scene &scene, Model const &model, glm::mat4 const &view){
+  for(DrawItem &item : scene.queue){
+    SceneNode const &node = scene.nodes[item.node];
+    Mesh const &mesh = model.meshes[node.mesh];
+
+    if(isOpaque(model, mesh)){
+      glm::vec4 center = node.worldMatrix[3];
+      if(isBounded(node.bounds))
+        center = glm::vec4((node.bounds.min + node.bounds.max) * .5f, 1.f);
+      float depth = -(view * center).z;
+      depth = depth > 0.f ? depth : 0.f; // bit pattern of non-negative floats is monotonic
+      uint32_t depthBits;
+      memcpy(&depthBits, &depth, sizeof(depthBits));
+      item.sortKey = ((uint64_t)(uint32_t)(mesh.diffuseTexture + 1) << 32) | depthBits;
+    } else {
+      item.sortKey = (1ull << 63) | item.node;
+    }
+  }
+
+  std::sort(scene.queue.begin(), scene.queue.end(), [](DrawItem const &a, DrawItem const &b){
+    return a.sortKey != b.sortKey ? a.sortKey < b.sortKey : a.node < b.node;
+  });
+}
+
+/**
+ * @brief This function renders a model using its flattened node tree
  *
  * @param ctx GPUContext
  * @param model model structure
+ * @param scene flattened node tree of the model (see buildScene)
  * @param proj projection matrix
  * @param view view matrix
  * @param light light position
- * @param camera camera position (unused)
+ * @param camera camera position
+ * @param settings optional rendering stages
  */
-//! [drawModel]
-void drawModel(GPUContext &ctx, Model const &model, glm::mat4 const &proj, glm::mat4 const &view, glm::vec3 const& light, glm::vec3 const &camera){
-  (void)camera;
+void drawScene(GPUContext &ctx, Model const &model, Scene &scene, glm::mat4 const &proj, glm::mat4 const &view, glm::vec3 const& light, glm::vec3 const &camera, DrawSettings const &settings){
   ctx.prg.fragmentShader = drawModel_fragmentShader;
   ctx.prg.vertexShader = drawModel_vertexShader;
   ctx.prg.vs2fs[0] = AttributeType::VEC3;
@@ -55,8 +302,68 @@ void drawModel(GPUContext &ctx, Model const &model, glm::mat4 const &proj, glm::
   ctx.prg.uniforms.uniform[0].m4 = proj * view;
   ctx.prg.uniforms.uniform[3].v3 = light;
 
-  for(uint32_t i = 0; i < model.roots.size(); i++)
-    drawNode(ctx, model.roots[i], model, model.roots[i].modelMatrix);
+  IZG_TRACE_ZONE("drawScene");
+  Frustum const frustum = extractFrustum(proj * view);
+  {
+    IZG_TRACE_ZONE("updateScene");
+    updateScene(scene, model);
+  }
+  {
+    IZG_TRACE_ZONE("buildRenderQueue");
+    scene.stats = DrawStats{};
+    collectVisibleMeshes(scene, settings.frustumCulling ? &frustum : nullptr);
+    if(settings.occlusionCulling)
+      occlusionCullMeshes(scene, model, proj * view, settings);
+    if(settings.lodSelection)
+      selectLods(scene, model, proj, camera, ctx.frame.height, settings.lodErrorThreshold);
+    if(settings.textureStreaming)
+      selectTextureLevels(scene, model, proj, camera, ctx.frame.height);
+    if(settings.sortDrawCalls)
+      sortRenderQueue(scene, model, view);
+    scene.stats.drawnMeshes = (uint32_t)scene.queue.size();
+  }
+
+  MeshletView meshletView;
+  meshletView.viewProj = proj * view;
+  meshletView.frustum  = frustum;
+  meshletView.camera   = camera;
+  meshletView.viewport = glm::vec2(ctx.frame.width, ctx.frame.height);
+
+  int32_t lastMesh = -1;
+  for(DrawItem const &item : scene.queue)
+    drawMesh(ctx, model, scene, item, lastMesh, settings.meshletCulling ? &meshletView : nullptr);
+}
+
+/**
+ * @brief This function renders a model
+ *
+ * @param ctx GPUContext
+ * @param model model structure
+ * @param proj projection matrix
+ * @param view view matrix
+ * @param light light position
+ * @param camera camera position (unused)
+ */
+//! [drawModel]
+void drawModel(GPUContext &ctx, Model const &model, glm::mat4 const &proj, glm::mat4 const &view, glm::vec3 const& light, glm::vec3 const &camera){
+  IZG_TRACE_ZONE("drawModel");
+  // scene is rebuilt only for another model, moved nodes are updated by drawScene
+  static thread_local Scene scene;
+  static thread_local Model const *builtModel = nullptr;
+  static thread_local void const *builtRoots = nullptr, *builtMeshes = nullptr;
+  static thread_local size_t builtNofRoots = 0, builtNofMeshes = 0;
+  bool const sameModel = builtModel == &model &&
+      builtRoots  == model.roots .data() && builtNofRoots  == model.roots .size() &&
+      builtMeshes == model.meshes.data() && builtNofMeshes == model.meshes.size();
+  if(!sameModel || !syncScene(scene, model)){
+    buildScene(scene, model);
+    builtModel     = &model;
+    builtRoots     = model.roots.data();
+    builtMeshes    = model.meshes.data();
+    builtNofRoots  = model.roots.size();
+    builtNofMeshes = model.meshes.size();
+  }
+  drawScene(ctx, model, scene, proj, view, light, camera);
 }
 //! [drawModel]
 
@@ -7,9 +7,31 @@
 #pragma once
 
 #include <student/fwd.hpp>
+#include <student/scene.hpp>
+
+/**
+ * @brief This struct holds optional stages of model rendering
+ */
+//! [DrawSettings]
+struct DrawSettings{
+  bool     sortDrawCalls    = false;///< sort opaque meshes by texture/material and front-to-back depth
+  bool     frustumCulling   = false;///< skip nodes and meshes whose bounds are outside of view frustum
+  bool     occlusionCulling = false;///< skip meshes hidden behind large occluders
+  uint32_t occlusionWidth   = 256  ;///< width of occlusion depth buffer
+  uint32_t occlusionHeight  = 128  ;///< height of occlusion depth buffer
+  uint32_t maxOccluders     = 16   ;///< maximal number of occluders rasterized per frame
+  float    minOccluderArea  = .02f ;///< minimal screen area (fraction of screen) of occluder bounds
+  bool     lodSelection     = false;///< draw simplified levels of detail of distant meshes
+  float    lodErrorThreshold= 1.f  ;///< maximal projected error of selected level of detail in pixels
+  bool     meshletCulling   = false;///< skip meshlets outside of frustum, facing away or covering no pixel
+  bool     textureStreaming = false;///< compute mip levels of textures needed by drawn meshes (Scene::textureLevels)
+};
+//! [DrawSettings]
 
 void drawModel(GPUContext&ctx,Model const&model,glm::mat4 const&proj,glm::mat4 const&view,glm::vec3 const&light,glm::vec3 const&camera);
 
+void drawScene(GPUContext&ctx,Model const&model,Scene&scene,glm::mat4 const&proj,glm::mat4 const&view,glm::vec3 const&light,glm::vec3 const&camera,DrawSettings const&settings = DrawSettings{});
+
 void drawModel_vertexShader(OutVertex&outVertex,InVertex const&inVertex,Uniforms const&uniforms);
 
 void drawModel_fragmentShader(OutFragment&outFragment,InFragment const&inFragment,Uniforms const&uniforms);
@@ -16,16 +16,30 @@
 uint32_t const maxAttributes = 16;///< maximum number of vertex/fragment attributes
 uint32_t const maxUniforms   = 16;///< maximum number of uniform variables
 uint32_t const maxTextures   = 8 ;///< maximum number of textures
+uint32_t const maxLods       = 4 ;///< maximum number of simplified levels of detail per mesh
+
+/**
+ * @brief This enum represents layout of texture data
+ */
+//! [TextureFormat]
+enum class TextureFormat : uint32_t{
+  RAW = 0,///< channels 8 bit values per pixel, rows from top to bottom
+  BC1 = 1,///< 4x4 blocks of 8 bytes, two 565 endpoints and 2 bit indices (channels = 3)
+  BC3 = 2,///< 4x4 blocks of 16 bytes, interpolated 8 bit alpha followed by BC1 color block (channels = 4)
+};
+//! [TextureFormat]
 
 /**
  * @brief This struct represent a texture
  */
 //! [Texture]
 struct Texture{
-  uint8_t const* data     = nullptr;///< pointer to data
-  uint32_t       width    = 0      ;///< width of the texture
-  uint32_t       height   = 0      ;///< height of the texture
-  uint32_t       channels = 3      ;///< number of channels of the texture
+  uint8_t const* data     = nullptr           ;///< pointer to data
+  uint32_t       width    = 0                 ;///< width of the texture
+  uint32_t       height   = 0                 ;///< height of the texture
+  uint32_t       channels = 3                 ;///< number of channels of the texture
+  uint32_t       level    = 0                 ;///< mip level of data, full resolution texture is width<<level wide
+  TextureFormat  format   = TextureFormat::RAW;///< layout of data
 };
 //! [Texture]
 
@@ -224,6 +238,33 @@ struct GPUContext{
 //! [GPUContext]
 
 
+/**
+ * @brief This struct represents cluster of neighbouring triangles of a mesh.
+ * Triangles of meshlet are stored contiguously in index buffer of its mesh.
+ */
+//! [Meshlet]
+struct Meshlet{
+  uint32_t  firstIndex     = 0              ;///< first index of meshlet in index buffer of the mesh
+  uint32_t  nofIndices     = 0              ;///< number of indices (3 per triangle)
+  uint32_t  nofVertices    = 0              ;///< number of unique vertices
+  glm::vec4 boundingSphere = glm::vec4(0.f) ;///< center (xyz) and radius (w) in model space
+  glm::vec3 coneAxis       = glm::vec3(0.f) ;///< average front face normal in model space
+  float     coneCutoff     = 1.f            ;///< sine of normal cone spread, 1 if meshlet cannot be backface culled
+};
+//! [Meshlet]
+
+/**
+ * @brief This struct represents one simplified level of detail of a mesh.
+ * It uses vertices and index type of its mesh.
+ */
+//! [MeshLod]
+struct MeshLod{
+  void const* indices    = nullptr;///< indices to vertices of the mesh
+  uint32_t    nofIndices = 0      ;///< number of indices
+  float       error      = 0.f    ;///< geometric deviation from full mesh in model space units
+};
+//! [MeshLod]
+
 /**
  * @brief This struct represents a mesh
  */
@@ -237,6 +278,14 @@ struct Mesh{
   uint32_t     nofIndices  = 0                ;///< nofIndices or nofVertices (if there is no indexing)
   glm::vec4    diffuseColor = glm::vec4(1.f)  ;///< default diffuseColor (if there is no texture)
   int          diffuseTexture = -1            ;///< diffuse texture or -1 (no texture)
+  glm::vec3    aabbMin      = glm::vec3(+1.f) ;///< minimal corner of bounding box in model space (min > max if unknown)
+  glm::vec3    aabbMax      = glm::vec3(-1.f) ;///< maximal corner of bounding box in model space
+  glm::vec4    boundingSphere = glm::vec4(0.f,0.f,0.f,-1.f);///< center (xyz) and radius (w) of bounding sphere, negative radius if unknown
+  MeshLod      lods[maxLods]                  ;///< simplified levels of detail, from finest to coarsest
+  uint32_t     nofLods     = 0                ;///< number of levels of detail
+  Meshlet const*meshlets   = nullptr          ;///< clusters of triangles of full mesh or nullptr
+  uint32_t     nofMeshlets = 0                ;///< number of meshlets
+  float        uvDensity   = 0.f              ;///< texture coordinate units per model space unit, 0 if unknown
 };
 //! [Mesh]
 
@@ -6,16 +6,15 @@
  */
 
 #include <student/gpu.hpp>
+#include <student/gpuStages.hpp>
+#include <student/textureCompression.hpp>
+#include <framework/trace.hpp>
 
 #define MIN(a, b) (((a) < (b)) ? (a) : (b))
 #define MAX(a, b) (((a) > (b)) ? (a) : (b))
 
 #define AREA(v0, v1, v2) ((v0.x) * (v1.y) + (v1.x) * (v2.y) + (v2.x) * (v0.y) - (v1.x) * (v0.y) - (v2.x) * (v1.y) - (v0.x) * (v2.y)) / 2
 
-struct Triangle{
-  OutVertex points[3];
-};
-
 uint32_t computeVertexID(VertexArray const &vao, uint32_t shaderInvocation){
   if(!vao.indexBuffer)return shaderInvocation;
 
@@ -192,6 +191,7 @@ void rasterize(GPUContext &ctx, Triangle &triangle){
   int32_t E2 = (minY + 0.5 - triangle.points[1].gl_Position.y) * deltaX2 - (minX + 0.5 - triangle.points[1].gl_Position.x) * deltaY2;
   int32_t E3 = (minY + 0.5 - triangle.points[2].gl_Position.y) * deltaX3 - (minX + 0.5 - triangle.points[2].gl_Position.x) * deltaY3;
 
+  uint64_t fragments = 0;
   for(uint32_t y = minY; y < maxY; y++){
     int32_t lastE1 = E1;
     int32_t lastE2 = E2;
@@ -199,6 +199,7 @@ void rasterize(GPUContext &ctx, Triangle &triangle){
     for(uint32_t x = minX; x < maxX; x++){
       if(E1 >= 0 && E2 >= 0 && E3 >= 0){
         makeFragment(ctx, triangle, x, y);
+        ++fragments;
       }
       E1 -= deltaY1;
       E2 -= deltaY2;
@@ -208,10 +209,13 @@ void rasterize(GPUContext &ctx, Triangle &triangle){
     E2 = lastE2 + deltaX2;
     E3 = lastE3 + deltaX3;
   }
+  gpuCounters.fragments += fragments;
 }
 
 //! [drawTrianglesImpl]
 void drawTrianglesImpl(GPUContext &ctx, uint32_t nofVertices){
+  IZG_TRACE_ZONE("drawTrianglesImpl");
+  gpuCounters.triangles += nofVertices / 3;
   for(uint32_t i = 0; i < nofVertices; i += 3){
     Triangle triangle;
     loadTriangle(triangle, ctx, i);
@@ -234,6 +238,10 @@ void drawTrianglesImpl(GPUContext &ctx, uint32_t nofVertices){
 }
 //! [drawTrianglesImpl]
 
+void(*drawTriangles)(GPUContext&,uint32_t) = drawTrianglesImpl;
+
+thread_local GPUCounters gpuCounters;
+
 /**
  * @brief This function reads color from texture.
  *
@@ -249,6 +257,12 @@ glm::vec4 read_texture(Texture const&texture,glm::vec2 uv){
   auto pix = glm::uvec2(uv2);
   //auto t   = glm::fract(uv2);
   glm::vec4 color = glm::vec4(0.f,0.f,0.f,1.f);
+  if(texture.format != TextureFormat::RAW){
+    uint8_t const*texel = decodedTextureBlock(texture,pix.x/4,pix.y/4) + ((pix.y&3)*4+(pix.x&3))*4;
+    for(uint32_t c=0;c<texture.channels;++c)
+      color[c] = texel[c]/255.f;
+    return color;
+  }
   for(uint32_t c=0;c<texture.channels;++c)
     color[c] = texture.data[(pix.y*texture.width+pix.x)*texture.channels+c]/255.f;
   return color;
@@ -264,6 +278,7 @@ glm::vec4 read_texture(Texture const&texture,glm::vec2 uv){
  * @param a alpha channel
  */
 void clear(GPUContext&ctx,float r,float g,float b,float a){
+  IZG_TRACE_ZONE("clear");
   auto&frame = ctx.frame;
   auto const nofPixels = frame.width * frame.height;
   for(size_t i=0;i<nofPixels;++i){
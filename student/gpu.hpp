@@ -10,6 +10,18 @@
 
 void clear(GPUContext&ctx,float r,float g,float b,float a);
 
+//! [GPUCounters]
+/**
+ * @brief This struct counts work of pipeline, every rendering thread has its own counters
+ */
+struct GPUCounters{
+  uint64_t triangles = 0;///< triangles sent to drawTriangles
+  uint64_t fragments = 0;///< fragments produced by rasterization
+};
+//! [GPUCounters]
+
+extern thread_local GPUCounters gpuCounters;
+
 /**
  * @brief Function that renders triangles
  *
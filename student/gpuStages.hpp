@@ -0,0 +1,42 @@
+/*!
+ * @file
+ * @brief This file contains stages of triangle rendering, they are exposed for stage benchmarks
+ *
+ * @author Martin Zmitko, xzmitk01@stud.fit.vutbr.cz
+ */
+#pragma once
+
+#include <student/fwd.hpp>
+
+//! [Triangle]
+/**
+ * @brief This struct holds vertices of primitive after vertex shader
+ */
+struct Triangle{
+  OutVertex points[3];///< vertices of triangle
+};
+//! [Triangle]
+
+uint32_t computeVertexID(VertexArray const &vao, uint32_t shaderInvocation);
+
+void vertexPuller(VertexArray const &vao, InVertex &vert);
+
+void loadTriangle(Triangle &triangle, GPUContext &ctx, uint32_t tId);
+
+uint8_t nearPlaneClipping(Triangle &triangle, Triangle &triangle2);
+
+void perspectiveDivision(Triangle &triangle);
+
+void viewportTransformation(Triangle &triangle, uint32_t w, uint32_t h);
+
+void getBarCords(Triangle &triangle, InFragment &fragment);
+
+void getPerspectiveBarAttrs(Triangle &triangle, InFragment &fragment, Program &prg);
+
+void perFragOperation(Frame &frame, InFragment &in, OutFragment &out);
+
+void makeFragment(GPUContext &ctx, Triangle &triangle, int x, int y);
+
+void rasterize(GPUContext &ctx, Triangle &triangle);
+
+void drawTrianglesImpl(GPUContext &ctx, uint32_t nofVertices);
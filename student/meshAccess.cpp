@@ -0,0 +1,88 @@
+/*!
+ * @file
+ * @brief This file contains reading and storing of mesh indices and vertex attributes
+ *
+ * @author Martin Zmitko, xzmitk01@stud.fit.vutbr.cz
+ */
+#include <student/meshAccess.hpp>
+
+/**
+ * @brief This function reads one index of mesh.
+ * Non-indexed meshes return the position in index buffer.
+ *
+ * @param mesh mesh
+ * @param i position in index buffer
+ *
+ * @return vertex id
+ */
+uint32_t readIndex(Mesh const &mesh, uint32_t i){
+  if(mesh.indices){
+    switch(mesh.indexType){
+      case IndexType::UINT32: return ((uint32_t*)mesh.indices)[i];
+      case IndexType::UINT16: return ((uint16_t*)mesh.indices)[i];
+      case IndexType::UINT8:  return ((uint8_t*) mesh.indices)[i];
+    }
+  }
+  return i;
+}
+
+/**
+ * @brief This function reads indices of mesh into 32-bit array.
+ * Non-indexed meshes produce sequence 0..nofIndices-1.
+ *
+ * @param mesh mesh
+ *
+ * @return indices
+ */
+std::vector<uint32_t> readIndices(Mesh const &mesh){
+  std::vector<uint32_t> res(mesh.nofIndices);
+  for(uint32_t i = 0; i < mesh.nofIndices; i++)
+    res[i] = readIndex(mesh, i);
+  return res;
+}
+
+/**
+ * @brief This function reads position of vertex (VEC3 or VEC4 attribute, w is ignored).
+ *
+ * @param position position attribute
+ * @param v vertex id
+ *
+ * @return position
+ */
+glm::vec3 vertexPosition(VertexAttrib const &position, uint32_t v){
+  return *(glm::vec3*)((uint8_t*)position.bufferData + position.offset + position.stride * v);
+}
+
+/**
+ * @brief This function reads texture coordinate of vertex (VEC2 attribute).
+ *
+ * @param texCoord texture coordinate attribute
+ * @param v vertex id
+ *
+ * @return texture coordinate
+ */
+glm::vec2 vertexTexCoord(VertexAttrib const &texCoord, uint32_t v){
+  return *(glm::vec2*)((uint8_t*)texCoord.bufferData + texCoord.offset + texCoord.stride * v);
+}
+
+/**
+ * @brief This function stores indices in given index type into storage.
+ *
+ * @param storage storage that owns the data
+ * @param indices indices, all have to fit into type
+ * @param type index type of stored data
+ *
+ * @return pointer to stored indices
+ */
+void const* storeIndices(BufferStorage &storage, std::vector<uint32_t> const &indices, IndexType type){
+  storage.emplace_back(indices.size() * (size_t)type);
+  uint8_t *data = storage.back().data();
+  for(size_t i = 0; i < indices.size(); i++){
+    switch(type){
+      case IndexType::UINT32: ((uint32_t*)data)[i] = indices[i]; break;
+      case IndexType::UINT16: ((uint16_t*)data)[i] = (uint16_t)indices[i]; break;
+      case IndexType::UINT8:  ((uint8_t*) data)[i] = (uint8_t) indices[i]; break;
+    }
+  }
+  return data;
+}
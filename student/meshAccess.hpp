@@ -0,0 +1,27 @@
+/*!
+ * @file
+ * @brief This file contains reading and storing of mesh indices and vertex attributes
+ *
+ * @author Martin Zmitko, xzmitk01@stud.fit.vutbr.cz
+ */
+#pragma once
+
+#include <student/fwd.hpp>
+
+#include <vector>
+
+/**
+ * @brief Storage of index and vertex buffers generated for a model.
+ * Meshes only point into it, so it has to outlive them.
+ */
+using BufferStorage = std::vector<std::vector<uint8_t>>;
+
+uint32_t readIndex(Mesh const&mesh,uint32_t i);
+
+std::vector<uint32_t>readIndices(Mesh const&mesh);
+
+glm::vec3 vertexPosition(VertexAttrib const&position,uint32_t v);
+
+glm::vec2 vertexTexCoord(VertexAttrib const&texCoord,uint32_t v);
+
+void const*storeIndices(BufferStorage&storage,std::vector<uint32_t>const&indices,IndexType type);
@@ -0,0 +1,269 @@
+/*!
+ * @file
+ * @brief This file contains load time reordering of mesh indices and vertices
+ *
+ * @author Martin Zmitko, xzmitk01@stud.fit.vutbr.cz
+ */
+#include <student/meshOptimizer.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+/**
+ * @brief This function counts misses of FIFO vertex cache when drawing triangle list.
+ *
+ * @param indices triangle list
+ * @param nofVertices number of vertices (all indices are smaller)
+ * @param cacheSize number of cache entries
+ *
+ * @return number of misses, divided by number of triangles it gives ACMR
+ */
+uint64_t countCacheMisses(std::vector<uint32_t> const &indices, uint32_t nofVertices, uint32_t cacheSize){
+  // vertex is cached if less than cacheSize misses happened since it was loaded
+  std::vector<uint64_t> loaded(nofVertices, 0);
+  uint64_t misses = 0;
+  for(uint32_t v : indices){
+    if(loaded[v] && misses + 1 - loaded[v] <= cacheSize)continue;
+    loaded[v] = ++misses;
+  }
+  return misses;
+}
+
+float const forsythCacheSize     = 32.f;
+float const forsythLastTriangle  = .75f;
+float const forsythDecayPower    = 1.5f;
+float const forsythValenceScale  = 2.f ;
+float const forsythValencePower  = .5f ;
+
+float forsythScore(int32_t cachePosition, uint32_t activeTriangles){
+  if(!activeTriangles)return -1.f;
+  float score = 0.f;
+  if(cachePosition >= 0){
+    if(cachePosition < 3)
+      score = forsythLastTriangle;
+    else
+      score = std::pow(1.f - (cachePosition - 3) / (forsythCacheSize - 3.f), forsythDecayPower);
+  }
+  return score + forsythValenceScale * std::pow((float)activeTriangles, -forsythValencePower);
+}
+
+/**
+ * @brief This function reorders triangles for post-transform vertex cache (Forsyth's linear speed algorithm).
+ * Triangles are emitted greedily, the next one is the best scoring triangle of vertices in simulated LRU cache.
+ *
+ * @param indices triangle list, it is reordered in place
+ * @param nofVertices number of vertices (all indices are smaller)
+ */
+void optimizeVertexCache(std::vector<uint32_t> &indices, uint32_t nofVertices){
+  size_t const nofTriangles = indices.size() / 3;
+  if(nofTriangles < 2)return;
+  uint32_t const cacheSize = (uint32_t)forsythCacheSize;
+
+  // live triangles of vertex v are adjacency[offset[v], offset[v]+active[v])
+  std::vector<uint32_t> offset(nofVertices + 1, 0), active(nofVertices, 0), adjacency(nofTriangles * 3);
+  for(size_t i = 0; i < nofTriangles * 3; i++)active[indices[i]]++;
+  for(uint32_t v = 0; v < nofVertices; v++)offset[v + 1] = offset[v] + active[v];
+  std::vector<uint32_t> fill(offset.begin(), offset.end() - 1);
+  for(size_t i = 0; i < nofTriangles * 3; i++)
+    adjacency[fill[indices[i]]++] = (uint32_t)(i / 3);
+
+  std::vector<int32_t > cachePosition(nofVertices, -1);
+  std::vector<float   > vertexScore(nofVertices);
+  std::vector<float   > triangleScore(nofTriangles, 0.f);
+  std::vector<bool    > emitted(nofTriangles, false);
+  for(uint32_t v = 0; v < nofVertices; v++)
+    vertexScore[v] = forsythScore(-1, active[v]);
+  for(size_t i = 0; i < nofTriangles * 3; i++)
+    triangleScore[i / 3] += vertexScore[indices[i]];
+
+  std::vector<uint32_t> result, cache, newCache;
+  result.reserve(nofTriangles * 3);
+  size_t scan = 0;
+  int64_t best = -1;
+  while(result.size() < nofTriangles * 3){
+    if(best < 0){ // nothing adjacent to cache, continue with the next unused triangle
+      while(emitted[scan])scan++;
+      best = (int64_t)scan;
+    }
+    uint32_t const *tri = &indices[best * 3];
+    emitted[best] = true;
+    newCache.assign(tri, tri + 3);
+    for(uint32_t i = 0; i < 3; i++){
+      uint32_t const v = tri[i];
+      result.push_back(v);
+      uint32_t *live = &adjacency[offset[v]];
+      uint32_t k = 0;
+      while(live[k] != (uint32_t)best)k++;
+      std::swap(live[k], live[--active[v]]);
+    }
+    for(uint32_t v : cache)
+      if(v != tri[0] && v != tri[1] && v != tri[2])
+        newCache.push_back(v);
+
+    for(uint32_t i = 0; i < newCache.size(); i++){
+      uint32_t const v = newCache[i];
+      cachePosition[v] = i < cacheSize ? (int32_t)i : -1;
+      float const score = forsythScore(cachePosition[v], active[v]);
+      float const delta = score - vertexScore[v];
+      vertexScore[v] = score;
+      for(uint32_t k = offset[v]; k < offset[v] + active[v]; k++)
+        triangleScore[adjacency[k]] += delta;
+    }
+
+    best = -1;
+    float bestScore = -1.f;
+    for(uint32_t i = 0; i < newCache.size() && i < cacheSize; i++){
+      uint32_t const v = newCache[i];
+      for(uint32_t k = offset[v]; k < offset[v] + active[v]; k++)
+        if(triangleScore[adjacency[k]] > bestScore){
+          bestScore = triangleScore[adjacency[k]];
+          best = adjacency[k];
+        }
+    }
+    if(newCache.size() > cacheSize)newCache.resize(cacheSize);
+    cache.swap(newCache);
+  }
+  indices.swap(result);
+}
+
+/**
+ * @brief This function reorders clusters of triangles to reduce overdraw (cluster sorting of Tipsify).
+ * Cache optimized triangle list is split into clusters whose ACMR, measured from cold cache,
+ * stays within threshold of the whole list. Clusters facing away from the mesh center are drawn first,
+ * because they tend to occlude the others.
+ *
+ * @param indices cache optimized triangle list, it is reordered in place
+ * @param position position attribute
+ * @param threshold allowed ACMR increase (1.05 means 5 %)
+ */
+void optimizeOverdraw(std::vector<uint32_t> &indices, VertexAttrib const &position, float threshold){
+  size_t const nofTriangles = indices.size() / 3;
+  if(nofTriangles < 2)return;
+  uint32_t const nofVertices = *std::max_element(indices.begin(), indices.end()) + 1;
+  float const targetACMR = threshold * countCacheMisses(indices, nofVertices) / nofTriangles;
+
+  std::vector<size_t> clusters; // first triangle of each cluster
+  std::vector<uint64_t> loaded(nofVertices, 0);
+  uint64_t time = 0, misses = 0;
+  size_t start = 0;
+  for(size_t t = 0; t < nofTriangles; t++){
+    if(t == start){
+      clusters.push_back(t);
+      time += vertexCacheSize + 1; // cold cache
+      misses = 0;
+    }
+    for(uint32_t i = 0; i < 3; i++){
+      uint32_t const v = indices[t * 3 + i];
+      if(loaded[v] && time + 1 - loaded[v] <= vertexCacheSize)continue;
+      loaded[v] = ++time;
+      misses++;
+    }
+    if(misses <= targetACMR * (t - start + 1))
+      start = t + 1;
+  }
+  clusters.push_back(nofTriangles);
+  size_t const nofClusters = clusters.size() - 1;
+  if(nofClusters < 2)return;
+
+  std::vector<glm::vec3> centroid(nofClusters), normal(nofClusters);
+  std::vector<float    > area(nofClusters, 0.f);
+  glm::vec3 meshCentroid = glm::vec3(0.f);
+  float meshArea = 0.f;
+  for(size_t c = 0; c < nofClusters; c++){
+    centroid[c] = normal[c] = glm::vec3(0.f);
+    for(size_t t = clusters[c]; t < clusters[c + 1]; t++){
+      glm::vec3 p0 = vertexPosition(position, indices[t * 3 + 0]);
+      glm::vec3 p1 = vertexPosition(position, indices[t * 3 + 1]);
+      glm::vec3 p2 = vertexPosition(position, indices[t * 3 + 2]);
+      glm::vec3 n = glm::cross(p1 - p0, p2 - p0);
+      float a = glm::length(n);
+      centroid[c] += (p0 + p1 + p2) * (a / 3.f);
+      normal[c] += n;
+      area[c] += a;
+    }
+    meshCentroid += centroid[c];
+    meshArea += area[c];
+    if(area[c] > 0.f)centroid[c] /= area[c];
+  }
+  if(meshArea > 0.f)meshCentroid /= meshArea;
+
+  std::vector<float   > key(nofClusters);
+  std::vector<uint32_t> order(nofClusters);
+  for(size_t c = 0; c < nofClusters; c++){
+    float const len = glm::length(normal[c]);
+    key[c] = len > 0.f ? glm::dot(centroid[c] - meshCentroid, normal[c] / len) : 0.f;
+    order[c] = (uint32_t)c;
+  }
+  std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b){return key[a] > key[b];});
+
+  std::vector<uint32_t> result;
+  result.reserve(indices.size());
+  for(uint32_t c : order)
+    result.insert(result.end(), indices.begin() + clusters[c] * 3, indices.begin() + clusters[c + 1] * 3);
+  indices.swap(result);
+}
+
+/**
+ * @brief This function reorders vertices of mesh in order of their first use by indices.
+ * Vertex puller then reads attributes mostly sequentially. Attributes are copied into new tightly packed buffers,
+ * unused vertices are dropped.
+ *
+ * @param mesh mesh, its attributes are redirected to new buffers
+ * @param indices triangle list, it is remapped in place
+ * @param storage storage that owns new buffers
+ *
+ * @return number of vertices
+ */
+uint32_t optimizeVertexFetch(Mesh &mesh, std::vector<uint32_t> &indices, BufferStorage &storage){
+  if(indices.empty())return 0;
+  uint32_t const nofVertices = *std::max_element(indices.begin(), indices.end()) + 1;
+  std::vector<uint32_t> remap(nofVertices, UINT32_MAX), original;
+  for(uint32_t &v : indices){
+    if(remap[v] == UINT32_MAX){
+      remap[v] = (uint32_t)original.size();
+      original.push_back(v);
+    }
+    v = remap[v];
+  }
+
+  for(VertexAttrib *att : {&mesh.position, &mesh.normal, &mesh.texCoord}){
+    if(!att->bufferData || att->type == AttributeType::EMPTY)continue;
+    size_t const size = sizeof(float) * (size_t)att->type;
+    storage.emplace_back(original.size() * size);
+    uint8_t *dst = storage.back().data();
+    for(size_t i = 0; i < original.size(); i++)
+      memcpy(dst + i * size, (uint8_t const*)att->bufferData + att->offset + att->stride * original[i], size);
+    att->bufferData = dst;
+    att->offset = 0;
+    att->stride = size;
+  }
+  return (uint32_t)original.size();
+}
+
+/**
+ * @brief This function optimizes index and vertex order of mesh.
+ * Non-indexed meshes and meshes without positions are left unchanged.
+ *
+ * @param mesh mesh, its indices and attributes are redirected to new buffers
+ * @param storage storage that owns new buffers
+ * @param stats accumulated cache statistics
+ */
+void optimizeMesh(Mesh &mesh, BufferStorage &storage, MeshOptimizationStats &stats){
+  if(!mesh.indices || mesh.nofIndices < 3 || !mesh.position.bufferData)return;
+  if(mesh.position.type != AttributeType::VEC3 && mesh.position.type != AttributeType::VEC4)return;
+
+  std::vector<uint32_t> indices = readIndices(mesh);
+  indices.resize(indices.size() - indices.size() % 3);
+  uint32_t const nofVertices = *std::max_element(indices.begin(), indices.end()) + 1;
+
+  stats.triangles    += indices.size() / 3;
+  stats.missesBefore += countCacheMisses(indices, nofVertices);
+  optimizeVertexCache(indices, nofVertices);
+  optimizeOverdraw(indices, mesh.position);
+  stats.missesAfter  += countCacheMisses(indices, nofVertices);
+  optimizeVertexFetch(mesh, indices, storage);
+
+  mesh.indices    = storeIndices(storage, indices, mesh.indexType);
+  mesh.nofIndices = (uint32_t)indices.size();
+}
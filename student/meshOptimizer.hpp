@@ -0,0 +1,35 @@
+/*!
+ * @file
+ * @brief This file contains load time reordering of mesh indices and vertices
+ *
+ * @author Martin Zmitko, xzmitk01@stud.fit.vutbr.cz
+ */
+#pragma once
+
+#include <student/fwd.hpp>
+#include <student/meshAccess.hpp>
+
+#include <vector>
+
+uint32_t const vertexCacheSize = 16;///< size of FIFO vertex cache used for ACMR measurement
+
+/**
+ * @brief This struct holds accumulated results of mesh optimization
+ */
+//! [MeshOptimizationStats]
+struct MeshOptimizationStats{
+  uint64_t triangles    = 0;///< number of optimized triangles
+  uint64_t missesBefore = 0;///< vertex cache misses of original index order
+  uint64_t missesAfter  = 0;///< vertex cache misses of optimized index order
+};
+//! [MeshOptimizationStats]
+
+uint64_t countCacheMisses(std::vector<uint32_t>const&indices,uint32_t nofVertices,uint32_t cacheSize = vertexCacheSize);
+
+void optimizeVertexCache(std::vector<uint32_t>&indices,uint32_t nofVertices);
+
+void optimizeOverdraw(std::vector<uint32_t>&indices,VertexAttrib const&position,float threshold = 1.05f);
+
+uint32_t optimizeVertexFetch(Mesh&mesh,std::vector<uint32_t>&indices,BufferStorage&storage);
+
+void optimizeMesh(Mesh&mesh,BufferStorage&storage,MeshOptimizationStats&stats);
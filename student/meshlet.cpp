@@ -0,0 +1,208 @@
+/*!
+ * @file
+ * @brief This file contains meshlet construction and per meshlet culling
+ *
+ * @author Martin Zmitko, xzmitk01@stud.fit.vutbr.cz
+ */
+#include <student/meshlet.hpp>
+
+#include <cmath>
+#include <cstring>
+
+void computeMeshletBounds(Meshlet &meshlet, std::vector<uint32_t> const &indices, VertexAttrib const &position){
+  glm::vec3 min = glm::vec3(+INFINITY), max = glm::vec3(-INFINITY);
+  glm::vec3 normalSum = glm::vec3(0.f);
+  for(uint32_t i = meshlet.firstIndex; i < meshlet.firstIndex + meshlet.nofIndices; i += 3){
+    glm::vec3 p[3];
+    for(uint32_t k = 0; k < 3; k++){
+      p[k] = vertexPosition(position, indices[i + k]);
+      min = glm::min(min, p[k]);
+      max = glm::max(max, p[k]);
+    }
+    glm::vec3 n = glm::cross(p[1] - p[0], p[2] - p[0]);
+    float len = glm::length(n);
+    if(len > 0.f)normalSum += n / len;
+  }
+
+  glm::vec3 const center = (min + max) * .5f;
+  float radius = 0.f;
+  for(uint32_t i = meshlet.firstIndex; i < meshlet.firstIndex + meshlet.nofIndices; i++)
+    radius = glm::max(radius, glm::length(vertexPosition(position, indices[i]) - center));
+  meshlet.boundingSphere = glm::vec4(center, radius);
+
+  meshlet.coneCutoff = 1.f;
+  float const sumLength = glm::length(normalSum);
+  if(sumLength <= 0.f)return;
+  meshlet.coneAxis = normalSum / sumLength;
+  float minDot = 1.f;
+  for(uint32_t i = meshlet.firstIndex; i < meshlet.firstIndex + meshlet.nofIndices; i += 3){
+    glm::vec3 p0 = vertexPosition(position, indices[i + 0]);
+    glm::vec3 p1 = vertexPosition(position, indices[i + 1]);
+    glm::vec3 p2 = vertexPosition(position, indices[i + 2]);
+    glm::vec3 n = glm::cross(p1 - p0, p2 - p0);
+    float len = glm::length(n);
+    if(len > 0.f)minDot = glm::min(minDot, glm::dot(n / len, meshlet.coneAxis));
+  }
+  // normals spread over more than ~84 degrees, the cone would never cull anything
+  if(minDot > .1f)
+    meshlet.coneCutoff = std::sqrt(1.f - minDot * minDot);
+}
+
+/**
+ * @brief This function splits triangle list into meshlets.
+ * Meshlet grows by neighbouring triangle that adds the fewest new vertices,
+ * until it runs out of neighbours or reaches vertex or triangle limit.
+ *
+ * @param indices triangle list, it is reordered so that triangles of each meshlet are contiguous
+ * @param position position attribute
+ *
+ * @return meshlets
+ */
+std::vector<Meshlet> buildMeshlets(std::vector<uint32_t> &indices, VertexAttrib const &position){
+  std::vector<Meshlet> meshlets;
+  size_t const nofTriangles = indices.size() / 3;
+  if(!nofTriangles)return meshlets;
+  uint32_t nofVertices = 0;
+  for(size_t i = 0; i < nofTriangles * 3; i++)nofVertices = glm::max(nofVertices, indices[i] + 1);
+
+  std::vector<uint32_t> offset(nofVertices + 1, 0), adjacency(nofTriangles * 3);
+  for(size_t i = 0; i < nofTriangles * 3; i++)offset[indices[i] + 1]++;
+  for(uint32_t v = 0; v < nofVertices; v++)offset[v + 1] += offset[v];
+  std::vector<uint32_t> fill(offset.begin(), offset.end() - 1);
+  for(size_t i = 0; i < nofTriangles * 3; i++)
+    adjacency[fill[indices[i]]++] = (uint32_t)(i / 3);
+
+  std::vector<bool    > used(nofTriangles, false);
+  std::vector<uint32_t> owner(nofVertices, UINT32_MAX); // meshlet that already contains vertex
+  std::vector<uint32_t> vertices, result;
+  result.reserve(nofTriangles * 3);
+
+  auto newVertices = [&](uint32_t t, uint32_t meshlet){
+    uint32_t count = 0;
+    for(uint32_t k = 0; k < 3; k++)
+      count += owner[indices[t * 3 + k]] != meshlet;
+    return count;
+  };
+
+  size_t scan = 0;
+  while(result.size() < nofTriangles * 3){
+    while(used[scan])scan++;
+    uint32_t const id = (uint32_t)meshlets.size();
+    Meshlet meshlet;
+    meshlet.firstIndex = (uint32_t)result.size();
+    vertices.clear();
+
+    int64_t next = (int64_t)scan;
+    while(next >= 0){
+      uint32_t const t = (uint32_t)next;
+      used[t] = true;
+      for(uint32_t k = 0; k < 3; k++){
+        uint32_t const v = indices[t * 3 + k];
+        result.push_back(v);
+        if(owner[v] == id)continue;
+        owner[v] = id;
+        vertices.push_back(v);
+      }
+      meshlet.nofIndices += 3;
+      if(meshlet.nofIndices / 3 >= maxMeshletTriangles)break;
+
+      next = -1;
+      uint32_t best = 4;
+      for(uint32_t v : vertices){
+        for(uint32_t k = offset[v]; k < offset[v + 1] && best; k++){
+          uint32_t const c = adjacency[k];
+          if(used[c])continue;
+          uint32_t const added = newVertices(c, id);
+          if(added >= best || vertices.size() + added > maxMeshletVertices)continue;
+          best = added;
+          next = c;
+        }
+        if(!best)break;
+      }
+    }
+    meshlet.nofVertices = (uint32_t)vertices.size();
+    meshlets.push_back(meshlet);
+  }
+
+  indices.swap(result);
+  for(Meshlet &meshlet : meshlets)
+    computeMeshletBounds(meshlet, indices, position);
+  return meshlets;
+}
+
+/**
+ * @brief This function splits mesh into meshlets.
+ * Index buffer of the mesh is replaced by reordered copy, non-indexed meshes are left unchanged.
+ *
+ * @param mesh mesh
+ * @param storage storage that owns new index buffer and meshlets
+ */
+void buildMeshMeshlets(Mesh &mesh, BufferStorage &storage){
+  mesh.meshlets = nullptr;
+  mesh.nofMeshlets = 0;
+  if(!mesh.indices || mesh.nofIndices < 3 || !mesh.position.bufferData)return;
+  if(mesh.position.type != AttributeType::VEC3 && mesh.position.type != AttributeType::VEC4)return;
+
+  std::vector<uint32_t> indices = readIndices(mesh);
+  indices.resize(indices.size() - indices.size() % 3);
+  std::vector<Meshlet> meshlets = buildMeshlets(indices, mesh.position);
+
+  mesh.indices = storeIndices(storage, indices, mesh.indexType);
+  mesh.nofIndices = (uint32_t)indices.size();
+  storage.emplace_back(meshlets.size() * sizeof(Meshlet));
+  memcpy(storage.back().data(), meshlets.data(), meshlets.size() * sizeof(Meshlet));
+  mesh.meshlets = (Meshlet const*)storage.back().data();
+  mesh.nofMeshlets = (uint32_t)meshlets.size();
+}
+
+/**
+ * @brief This function prepares per node data for meshlet tests.
+ *
+ * @param worldMatrix world matrix of node
+ * @param normalMatrix inverse transposed world matrix of node
+ * @param camera camera position in world space
+ *
+ * @return instance data
+ */
+MeshletInstance makeMeshletInstance(glm::mat4 const &worldMatrix, glm::mat4 const &normalMatrix, glm::vec3 const &camera){
+  MeshletInstance res;
+  res.worldMatrix = worldMatrix;
+  res.camera = glm::vec3(glm::transpose(normalMatrix) * glm::vec4(camera, 1.f));
+  res.scale = glm::max(glm::length(glm::vec3(worldMatrix[0])),
+              glm::max(glm::length(glm::vec3(worldMatrix[1])), glm::length(glm::vec3(worldMatrix[2]))));
+  // backfacing is affine invariant, but mirroring swaps the rasterized winding
+  res.coneCulling = glm::determinant(glm::mat3(worldMatrix)) > 0.f;
+  return res;
+}
+
+/**
+ * @brief This function tests whether meshlet can produce any fragment.
+ * All tests are conservative: meshlet is rejected if its bounding sphere is outside of the frustum,
+ * if all its triangles face away from the camera (normal cone) or if bounds of the sphere
+ * do not contain any pixel center (small or offscreen meshlet).
+ *
+ * @param meshlet meshlet
+ * @param instance node that draws the meshlet
+ * @param view view of the frame
+ *
+ * @return false if meshlet can be skipped
+ */
+bool isMeshletVisible(Meshlet const &meshlet, MeshletInstance const &instance, MeshletView const &view){
+  glm::vec3 const center = glm::vec3(instance.worldMatrix * glm::vec4(glm::vec3(meshlet.boundingSphere), 1.f));
+  float const radius = meshlet.boundingSphere.w * instance.scale;
+  if(!isVisible(view.frustum, glm::vec4(center, radius)))return false;
+
+  if(instance.coneCulling){
+    glm::vec3 const d = glm::vec3(meshlet.boundingSphere) - instance.camera;
+    if(glm::dot(d, meshlet.coneAxis) >= meshlet.coneCutoff * glm::length(d) + meshlet.boundingSphere.w)return false;
+  }
+
+  ScreenRect rect;
+  if(!projectAABB(view.viewProj, AABB{center - radius, center + radius}, rect))return true;
+  // one pixel margin covers rounding of the rasterizer
+  glm::vec2 const lo = glm::ceil ((rect.min * .5f + .5f) * view.viewport - .5f - 1.f);
+  glm::vec2 const hi = glm::floor((rect.max * .5f + .5f) * view.viewport - .5f + 1.f);
+  glm::vec2 const first = glm::max(lo, glm::vec2(0.f));
+  glm::vec2 const last  = glm::min(hi, view.viewport - 1.f);
+  return first.x <= last.x && first.y <= last.y;
+}
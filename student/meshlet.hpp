@@ -0,0 +1,48 @@
+/*!
+ * @file
+ * @brief This file contains meshlet construction and per meshlet culling
+ *
+ * @author Martin Zmitko, xzmitk01@stud.fit.vutbr.cz
+ */
+#pragma once
+
+#include <student/fwd.hpp>
+#include <student/culling.hpp>
+#include <student/meshAccess.hpp>
+
+#include <vector>
+
+uint32_t const maxMeshletVertices  = 64 ;///< maximal number of unique vertices of meshlet
+uint32_t const maxMeshletTriangles = 124;///< maximal number of triangles of meshlet
+
+/**
+ * @brief This struct holds view data shared by all meshlet tests of one frame
+ */
+//! [MeshletView]
+struct MeshletView{
+  glm::mat4 viewProj = glm::mat4(1.f);///< proj*view matrix
+  Frustum   frustum                  ;///< view frustum in world space
+  glm::vec3 camera   = glm::vec3(0.f);///< camera position in world space
+  glm::vec2 viewport = glm::vec2(0.f);///< size of framebuffer in pixels
+};
+//! [MeshletView]
+
+/**
+ * @brief This struct holds per node data of meshlet tests
+ */
+//! [MeshletInstance]
+struct MeshletInstance{
+  glm::mat4 worldMatrix = glm::mat4(1.f);///< transformation from model to world space
+  glm::vec3 camera      = glm::vec3(0.f);///< camera position in model space
+  float     scale       = 1.f           ;///< largest scale of world matrix
+  bool      coneCulling = false         ;///< backface cone test is valid (world matrix does not mirror)
+};
+//! [MeshletInstance]
+
+std::vector<Meshlet>buildMeshlets(std::vector<uint32_t>&indices,VertexAttrib const&position);
+
+void buildMeshMeshlets(Mesh&mesh,BufferStorage&storage);
+
+MeshletInstance makeMeshletInstance(glm::mat4 const&worldMatrix,glm::mat4 const&normalMatrix,glm::vec3 const&camera);
+
+bool isMeshletVisible(Meshlet const&meshlet,MeshletInstance const&instance,MeshletView const&view);
@@ -0,0 +1,142 @@
+/*!
+ * @file
+ * @brief This file contains functions for flattening of model node tree
+ *
+ * @author Martin Zmitko, xzmitk01@stud.fit.vutbr.cz
+ */
+#include <student/scene.hpp>
+
+uint32_t countNodes(Node const &node){
+  uint32_t count = 1;
+  for(Node const &n : node.children)
+    count += countNodes(n);
+  return count;
+}
+
+void flattenNode(Scene &scene, Node const &node, int32_t parent){
+  uint32_t const id = (uint32_t)scene.nodes.size();
+  scene.nodes.emplace_back();
+  SceneNode &sn = scene.nodes.back();
+  sn.modelMatrix = node.modelMatrix;
+  sn.parent = parent;
+  sn.mesh = node.mesh;
+  if(parent >= 0)
+    sn.worldMatrix = scene.nodes[parent].worldMatrix * node.modelMatrix;
+  else
+    sn.worldMatrix = node.modelMatrix;
+  sn.normalMatrix = glm::transpose(glm::inverse(sn.worldMatrix));
+
+  for(Node const &n : node.children)
+    flattenNode(scene, n, id);
+  scene.nodes[id].subtreeEnd = (uint32_t)scene.nodes.size();
+}
+
+void updateBounds(Scene &scene, Model const &model){
+  for(SceneNode &sn : scene.nodes){
+    sn.bounds = AABB{};
+    if(sn.mesh < 0)continue;
+    Mesh const &mesh = model.meshes[sn.mesh];
+    if(hasBounds(mesh))
+      sn.bounds = transformAABB(sn.worldMatrix, mesh.aabbMin, mesh.aabbMax);
+    else
+      sn.bounds = AABB{glm::vec3(-INFINITY), glm::vec3(+INFINITY)};
+  }
+
+  // children follow their parent, so reverse order finishes every subtree before its root
+  for(size_t i = scene.nodes.size(); i-- > 0;){
+    SceneNode &sn = scene.nodes[i];
+    sn.subtreeBounds = sn.bounds;
+    for(uint32_t c = (uint32_t)i + 1; c < sn.subtreeEnd; c = scene.nodes[c].subtreeEnd)
+      sn.subtreeBounds = unite(sn.subtreeBounds, scene.nodes[c].subtreeBounds);
+  }
+}
+
+/**
+ * @brief This function flattens node trees of model into scene.
+ * Memory of the scene is reused, so rebuilding scene of the same (or smaller) model does not allocate.
+ *
+ * @param scene output scene
+ * @param model model
+ */
+void buildScene(Scene &scene, Model const &model){
+  uint32_t nofNodes = 0;
+  for(Node const &root : model.roots)
+    nofNodes += countNodes(root);
+
+  scene.nodes.clear();
+  scene.nodes.reserve(nofNodes);
+  for(Node const &root : model.roots)
+    flattenNode(scene, root, -1);
+  updateBounds(scene, model);
+  scene.dirty = false;
+}
+
+/**
+ * @brief This function changes local transformation of node.
+ * World matrices are recomputed lazily by updateScene.
+ *
+ * @param scene scene
+ * @param node index of node
+ * @param modelMatrix new local transformation matrix
+ */
+void setNodeMatrix(Scene &scene, uint32_t node, glm::mat4 const &modelMatrix){
+  SceneNode &sn = scene.nodes.at(node);
+  sn.modelMatrix = modelMatrix;
+  sn.dirty = true;
+  scene.dirty = true;
+}
+
+bool syncNode(Scene &scene, Node const &node, uint32_t &id){
+  if(id >= scene.nodes.size())return false;
+  uint32_t const current = id++;
+  SceneNode const &sn = scene.nodes[current];
+  if(sn.mesh != node.mesh)return false;
+  if(sn.modelMatrix != node.modelMatrix)
+    setNodeMatrix(scene, current, node.modelMatrix);
+  for(Node const &n : node.children)
+    if(!syncNode(scene, n, id))return false;
+  return scene.nodes[current].subtreeEnd == id;
+}
+
+/**
+ * @brief This function marks nodes whose local matrix in model differs from the scene as changed.
+ * Nothing is recomputed, so it is much cheaper than buildScene for model that only moves its nodes.
+ *
+ * @param scene scene built from the model
+ * @param model model
+ *
+ * @return false if node tree of model does not match the scene and the scene has to be rebuilt
+ */
+bool syncScene(Scene &scene, Model const &model){
+  uint32_t id = 0;
+  for(Node const &root : model.roots)
+    if(!syncNode(scene, root, id))return false;
+  return id == scene.nodes.size();
+}
+
+/**
+ * @brief This function recomputes world and normal matrices of changed nodes and their subtrees.
+ *
+ * @param scene scene
+ * @param model model the scene was built from
+ */
+void updateScene(Scene &scene, Model const &model){
+  if(!scene.dirty)return;
+
+  // parent precedes its children, so dirty flag propagates in one pass
+  for(SceneNode &sn : scene.nodes){
+    if(sn.parent >= 0 && scene.nodes[sn.parent].dirty)
+      sn.dirty = true;
+    if(!sn.dirty)continue;
+    if(sn.parent >= 0)
+      sn.worldMatrix = scene.nodes[sn.parent].worldMatrix * sn.modelMatrix;
+    else
+      sn.worldMatrix = sn.modelMatrix;
+    sn.normalMatrix = glm::transpose(glm::inverse(sn.worldMatrix));
+  }
+
+  for(SceneNode &sn : scene.nodes)
+    sn.dirty = false;
+  updateBounds(scene, model);
+  scene.dirty = false;
+}
@@ -0,0 +1,80 @@
+/*!
+ * @file
+ * @brief This file contains flattened representation of model node tree
+ *
+ * @author Martin Zmitko, xzmitk01@stud.fit.vutbr.cz
+ */
+#pragma once
+
+#include <student/fwd.hpp>
+#include <student/culling.hpp>
+
+/**
+ * @brief This struct represents one node of flattened model tree
+ */
+//! [SceneNode]
+struct SceneNode{
+  glm::mat4 modelMatrix  = glm::mat4(1.f);///< local transformation matrix
+  glm::mat4 worldMatrix  = glm::mat4(1.f);///< transformation from node to world space
+  glm::mat4 normalMatrix = glm::mat4(1.f);///< inverse transposed world matrix
+  int32_t   parent       = -1            ;///< index of parent node or -1 if the node is root
+  int32_t   mesh         = -1            ;///< id of mesh or -1 if no mesh
+  uint32_t  subtreeEnd   = 0             ;///< index one past the last node of subtree
+  bool      dirty        = false         ;///< local matrix has changed since last update
+  AABB      bounds                       ;///< world space bounds of mesh (unbounded if unknown)
+  AABB      subtreeBounds                ;///< world space bounds of all meshes in subtree
+};
+//! [SceneNode]
+
+/**
+ * @brief This struct represents one mesh draw collected into render queue
+ */
+//! [DrawItem]
+struct DrawItem{
+  uint64_t sortKey = 0;///< key by which items are submitted (lowest first)
+  uint32_t node    = 0;///< index of scene node that references the mesh
+  int32_t  lod     = -1;///< index of selected level of detail or -1 for full mesh
+};
+//! [DrawItem]
+
+/**
+ * @brief This struct holds statistics of the last drawScene call
+ */
+//! [DrawStats]
+struct DrawStats{
+  uint32_t drawnMeshes           = 0;///< number of submitted meshes
+  uint32_t frustumCulledMeshes   = 0;///< number of meshes skipped by frustum culling
+  uint32_t occlusionCulledMeshes = 0;///< number of meshes skipped by occlusion culling
+  uint32_t occluders             = 0;///< number of meshes rasterized into occlusion buffer
+  uint64_t submittedTriangles    = 0;///< number of triangles sent to drawTriangles
+  uint64_t lodTrianglesSaved     = 0;///< number of triangles removed by level of detail selection
+  uint32_t drawnMeshlets         = 0;///< number of meshlets that passed meshlet culling
+  uint32_t culledMeshlets        = 0;///< number of meshlets skipped by meshlet culling
+};
+//! [DrawStats]
+
+/**
+ * @brief This struct represents model node tree flattened into one array.
+ * Nodes are stored in pre-order, parent always precedes its children
+ * and the subtree of node i occupies range [i,subtreeEnd).
+ */
+//! [Scene]
+struct Scene{
+  std::vector<SceneNode>nodes         ;///< all nodes of all trees in pre-order
+  std::vector<DrawItem> queue         ;///< render queue storage reused between frames
+  std::vector<ScreenRect>rects        ;///< projected bounds of queued meshes (occlusion culling)
+  std::vector<uint32_t> occluders     ;///< queue items selected as occluders (occlusion culling)
+  OcclusionBuffer       occlusion     ;///< low resolution depth of occluders
+  DrawStats             stats         ;///< statistics of the last drawScene
+  std::vector<uint32_t> textureLevels ;///< finest mip level of each texture needed by the last drawScene, UINT32_MAX if unused (texture streaming)
+  bool                  dirty = false ;///< some node has changed local matrix
+};
+//! [Scene]
+
+void buildScene(Scene&scene,Model const&model);
+
+void setNodeMatrix(Scene&scene,uint32_t node,glm::mat4 const&modelMatrix);
+
+bool syncScene(Scene&scene,Model const&model);
+
+void updateScene(Scene&scene,Model const&model);
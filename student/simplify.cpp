@@ -0,0 +1,381 @@
+/*!
+ * @file
+ * @brief This file contains mesh simplification using quadric error metrics
+ *
+ * @author Martin Zmitko, xzmitk01@stud.fit.vutbr.cz
+ */
+#include <student/simplify.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+
+/**
+ * @brief This struct represents symmetric 4x4 error quadric with accumulated weight
+ */
+struct Quadric{
+  double a00 = 0, a01 = 0, a02 = 0, a03 = 0;
+  double a11 = 0, a12 = 0, a13 = 0;
+  double a22 = 0, a23 = 0;
+  double a33 = 0;
+  double w   = 0;
+};
+
+Quadric planeQuadric(glm::dvec3 const &n, double d, double w){
+  Quadric q;
+  q.a00 = w * n.x * n.x; q.a01 = w * n.x * n.y; q.a02 = w * n.x * n.z; q.a03 = w * n.x * d;
+  q.a11 = w * n.y * n.y; q.a12 = w * n.y * n.z; q.a13 = w * n.y * d;
+  q.a22 = w * n.z * n.z; q.a23 = w * n.z * d;
+  q.a33 = w * d * d;
+  q.w   = w;
+  return q;
+}
+
+void addQuadric(Quadric &q, Quadric const &o){
+  q.a00 += o.a00; q.a01 += o.a01; q.a02 += o.a02; q.a03 += o.a03;
+  q.a11 += o.a11; q.a12 += o.a12; q.a13 += o.a13;
+  q.a22 += o.a22; q.a23 += o.a23;
+  q.a33 += o.a33;
+  q.w   += o.w;
+}
+
+/**
+ * @brief This function evaluates mean squared distance of point to planes of quadric.
+ */
+double quadricError(Quadric const &q, glm::dvec3 const &v){
+  double e =
+      q.a00 * v.x * v.x + 2 * q.a01 * v.x * v.y + 2 * q.a02 * v.x * v.z + 2 * q.a03 * v.x +
+      q.a11 * v.y * v.y + 2 * q.a12 * v.y * v.z + 2 * q.a13 * v.y +
+      q.a22 * v.z * v.z + 2 * q.a23 * v.z +
+      q.a33;
+  return q.w > 0 ? std::fabs(e) / q.w : 0;
+}
+
+/**
+ * @brief This struct holds state of simplification that is carried between levels of detail
+ */
+struct SimplifyState{
+  std::vector<Quadric>  quadrics     ;///< accumulated quadrics of vertices
+  std::vector<uint32_t> collapsedInto;///< vertex that the vertex was collapsed onto, itself if it was not collapsed
+};
+
+/**
+ * @brief This function computes distance of point to triangle.
+ */
+double pointTriangleDistance(glm::dvec3 const &p, glm::dvec3 const &a, glm::dvec3 const &b, glm::dvec3 const &c){
+  auto segment = [&](glm::dvec3 const &s0, glm::dvec3 const &s1){
+    glm::dvec3 d = s1 - s0;
+    double t = glm::dot(d, d) > 0 ? glm::clamp(glm::dot(p - s0, d) / glm::dot(d, d), 0., 1.) : 0.;
+    return glm::length(p - s0 - t * d);
+  };
+  glm::dvec3 n = glm::cross(b - a, c - a);
+  if(glm::dot(n, n) > 0){
+    n = glm::normalize(n);
+    glm::dvec3 q = p - glm::dot(p - a, n) * n;
+    if(glm::dot(glm::cross(b - a, q - a), n) >= 0 &&
+       glm::dot(glm::cross(c - b, q - b), n) >= 0 &&
+       glm::dot(glm::cross(a - c, q - c), n) >= 0)
+      return std::fabs(glm::dot(p - a, n));
+  }
+  return std::min(std::min(segment(a, b), segment(b, c)), segment(c, a));
+}
+
+/**
+ * @brief This function simplifies triangle list by collapsing edges with the lowest quadric error.
+ * Vertices only collapse onto other existing vertices, so the result references a subset of input vertices.
+ * Vertices on open borders and on attribute seams (several vertices with the same position) are locked.
+ * Quadrics of collapsed vertices are accumulated in their targets, so state passed to the next call
+ * keeps measuring the error against the planes of the original mesh.
+ *
+ * @param dst output indices
+ * @param indices input triangle list
+ * @param position position attribute (VEC3 or VEC4)
+ * @param targetIndices stop when number of indices gets to this count
+ * @param targetError stop before any collapse with larger error (model space units)
+ * @param state quadrics and collapses of vertices, they are initialized from indices if empty
+ *
+ * @return largest error of performed collapses
+ */
+float simplifyIndices(
+    std::vector<uint32_t>      &dst          ,
+    std::vector<uint32_t>const &indices      ,
+    VertexAttrib         const &position     ,
+    size_t                      targetIndices,
+    float                       targetError  ,
+    SimplifyState              &state        ){
+  dst.assign(indices.begin(), indices.end() - indices.size() % 3);
+  if(dst.empty())return 0.f;
+
+  uint32_t nofVertices = *std::max_element(dst.begin(), dst.end()) + 1;
+  std::vector<glm::dvec3> pos(nofVertices);
+  for(uint32_t v = 0; v < nofVertices; v++)
+    pos[v] = glm::dvec3(vertexPosition(position, v));
+
+  std::vector<bool> locked(nofVertices, false);
+
+  // attribute seams, vertices sharing position with another vertex
+  std::unordered_map<std::string, uint32_t> firstWithPosition;
+  std::vector<bool> used(nofVertices, false);
+  for(uint32_t v : dst)used[v] = true;
+  for(uint32_t v = 0; v < nofVertices; v++){
+    if(!used[v])continue;
+    glm::vec3 p = vertexPosition(position, v);
+    std::string key((char const*)&p, sizeof(p));
+    auto it = firstWithPosition.find(key);
+    if(it == firstWithPosition.end()){
+      firstWithPosition[key] = v;
+      continue;
+    }
+    locked[v] = true;
+    locked[it->second] = true;
+  }
+
+  // open borders, edges used by exactly one triangle
+  std::unordered_map<uint64_t, int32_t> edgeUse;
+  for(size_t t = 0; t < dst.size(); t += 3)
+    for(uint32_t e = 0; e < 3; e++){
+      uint32_t a = dst[t + e], b = dst[t + (e + 1) % 3];
+      edgeUse[((uint64_t)std::min(a, b) << 32) | std::max(a, b)]++;
+    }
+  for(auto const &e : edgeUse)
+    if(e.second == 1){
+      locked[e.first >> 32] = true;
+      locked[e.first & 0xffffffffu] = true;
+    }
+
+  std::vector<Quadric> &quadrics = state.quadrics;
+  if(quadrics.size() < nofVertices)quadrics.clear();
+  if(quadrics.empty()){
+    quadrics.resize(nofVertices);
+    state.collapsedInto.resize(nofVertices);
+    for(uint32_t v = 0; v < nofVertices; v++)state.collapsedInto[v] = v;
+    for(size_t t = 0; t < dst.size(); t += 3){
+      glm::dvec3 const &p0 = pos[dst[t]], &p1 = pos[dst[t + 1]], &p2 = pos[dst[t + 2]];
+      glm::dvec3 n = glm::cross(p1 - p0, p2 - p0);
+      double area = glm::length(n);
+      if(area <= 0)continue;
+      n /= area;
+      Quadric q = planeQuadric(n, -glm::dot(n, p0), area);
+      for(uint32_t i = 0; i < 3; i++)
+        addQuadric(quadrics[dst[t + i]], q);
+    }
+  }
+
+  struct Collapse{
+    uint32_t from;
+    uint32_t to;
+    double   error;
+  };
+  std::vector<Collapse> collapses;
+  std::vector<uint32_t> adjOffset, adjTriangles, remap(nofVertices);
+  std::vector<bool> touched(nofVertices);
+  double const errorLimit = (double)targetError * targetError;
+  double resultError = 0;
+
+  while(dst.size() > targetIndices){
+    // vertex to triangle adjacency
+    adjOffset.assign(nofVertices + 1, 0);
+    for(uint32_t v : dst)adjOffset[v + 1]++;
+    for(uint32_t v = 0; v < nofVertices; v++)adjOffset[v + 1] += adjOffset[v];
+    adjTriangles.resize(dst.size());
+    std::vector<uint32_t> fill(adjOffset.begin(), adjOffset.end() - 1);
+    for(size_t i = 0; i < dst.size(); i++)
+      adjTriangles[fill[dst[i]]++] = (uint32_t)(i / 3);
+
+    collapses.clear();
+    for(size_t t = 0; t < dst.size(); t += 3)
+      for(uint32_t e = 0; e < 3; e++){
+        uint32_t a = dst[t + e], b = dst[t + (e + 1) % 3];
+        Quadric q = quadrics[a];
+        addQuadric(q, quadrics[b]);
+        double ea = locked[a] ? INFINITY : quadricError(q, pos[b]); // a moves onto b
+        double eb = locked[b] ? INFINITY : quadricError(q, pos[a]); // b moves onto a
+        if(std::isinf(ea) && std::isinf(eb))continue;
+        if(ea <= eb)collapses.push_back({a, b, ea});
+        else        collapses.push_back({b, a, eb});
+      }
+    std::sort(collapses.begin(), collapses.end(), [](Collapse const &x, Collapse const &y){return x.error < y.error;});
+
+    for(uint32_t v = 0; v < nofVertices; v++)remap[v] = v;
+    std::fill(touched.begin(), touched.end(), false);
+
+    size_t triangles = dst.size() / 3;
+    size_t const targetTriangles = targetIndices / 3;
+    size_t performed = 0;
+    for(Collapse const &c : collapses){
+      if(c.error > errorLimit || triangles <= targetTriangles)break;
+      if(touched[c.from] || touched[c.to])continue;
+
+      // reject collapses that flip a triangle around the moved vertex
+      bool flips = false;
+      uint32_t removed = 0;
+      for(uint32_t k = adjOffset[c.from]; k < adjOffset[c.from + 1] && !flips; k++){
+        uint32_t const *tri = &dst[adjTriangles[k] * 3];
+        if(tri[0] == c.to || tri[1] == c.to || tri[2] == c.to){
+          removed++;
+          continue;
+        }
+        glm::dvec3 p[3], q[3];
+        for(uint32_t i = 0; i < 3; i++){
+          p[i] = pos[tri[i]];
+          q[i] = tri[i] == c.from ? pos[c.to] : p[i];
+        }
+        glm::dvec3 n0 = glm::cross(p[1] - p[0], p[2] - p[0]);
+        glm::dvec3 n1 = glm::cross(q[1] - q[0], q[2] - q[0]);
+        flips = glm::dot(n0, n1) <= 0;
+      }
+      if(flips)continue;
+
+      remap[c.from] = c.to;
+      state.collapsedInto[c.from] = c.to;
+      addQuadric(quadrics[c.to], quadrics[c.from]);
+      touched[c.to] = true;
+      for(uint32_t k = adjOffset[c.from]; k < adjOffset[c.from + 1]; k++)
+        for(uint32_t i = 0; i < 3; i++)
+          touched[dst[adjTriangles[k] * 3 + i]] = true;
+      triangles -= removed;
+      resultError = std::max(resultError, c.error);
+      performed++;
+    }
+    if(!performed)break;
+
+    size_t kept = 0;
+    for(size_t t = 0; t < dst.size(); t += 3){
+      uint32_t a = remap[dst[t]], b = remap[dst[t + 1]], c = remap[dst[t + 2]];
+      if(a == b || b == c || c == a)continue;
+      dst[kept++] = a;
+      dst[kept++] = b;
+      dst[kept++] = c;
+    }
+    dst.resize(kept);
+  }
+
+  return (float)std::sqrt(resultError);
+}
+
+float simplifyIndices(
+    std::vector<uint32_t>      &dst          ,
+    std::vector<uint32_t>const &indices      ,
+    VertexAttrib         const &position     ,
+    size_t                      targetIndices,
+    float                       targetError  ){
+  SimplifyState state;
+  return simplifyIndices(dst, indices, position, targetIndices, targetError, state);
+}
+
+/**
+ * @brief This function measures how far vertices of the original mesh are from simplified surface.
+ * Every original vertex is compared with simplified triangles near vertices that it and its original neighbours
+ * were collapsed onto, so the result is an upper bound of its distance to the simplified surface.
+ *
+ * @param original original triangle list
+ * @param simplified simplified triangle list
+ * @param position position attribute (VEC3 or VEC4)
+ * @param state state of simplification that produced simplified triangle list
+ *
+ * @return largest distance of original vertex (model space units)
+ */
+float surfaceDeviation(
+    std::vector<uint32_t>const &original  ,
+    std::vector<uint32_t>const &simplified,
+    VertexAttrib         const &position  ,
+    SimplifyState        const &state     ){
+  uint32_t const nofVertices = (uint32_t)state.collapsedInto.size();
+  auto adjacency = [&](std::vector<uint32_t> const &indices, std::vector<uint32_t> &offset, std::vector<uint32_t> &triangles){
+    offset.assign(nofVertices + 1, 0);
+    for(uint32_t v : indices)offset[v + 1]++;
+    for(uint32_t v = 0; v < nofVertices; v++)offset[v + 1] += offset[v];
+    triangles.resize(indices.size());
+    std::vector<uint32_t> fill(offset.begin(), offset.end() - 1);
+    for(size_t i = 0; i < indices.size(); i++)
+      triangles[fill[indices[i]]++] = (uint32_t)(i / 3);
+  };
+  std::vector<uint32_t> originalOffset, originalTriangles, simplifiedOffset, simplifiedTriangles;
+  adjacency(original, originalOffset, originalTriangles);
+  adjacency(simplified, simplifiedOffset, simplifiedTriangles);
+
+  std::vector<uint32_t> representative(nofVertices);
+  for(uint32_t v = 0; v < nofVertices; v++){
+    uint32_t r = v;
+    while(state.collapsedInto[r] != r)r = state.collapsedInto[r];
+    representative[v] = r;
+  }
+
+  std::vector<glm::dvec3> pos(nofVertices);
+  for(uint32_t v = 0; v < nofVertices; v++)
+    pos[v] = glm::dvec3(vertexPosition(position, v));
+
+  std::vector<uint32_t> vertices, candidates;
+  auto distanceToTrianglesAround = [&](glm::dvec3 const &p){
+    candidates.clear();
+    for(uint32_t r : vertices)
+      candidates.insert(candidates.end(), simplifiedTriangles.begin() + simplifiedOffset[r], simplifiedTriangles.begin() + simplifiedOffset[r + 1]);
+    std::sort(candidates.begin(), candidates.end());
+    candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+    double distance = INFINITY;
+    for(uint32_t t : candidates){
+      uint32_t const *tri = &simplified[t * 3];
+      distance = std::min(distance, pointTriangleDistance(p, pos[tri[0]], pos[tri[1]], pos[tri[2]]));
+    }
+    return distance;
+  };
+
+  double result = 0;
+  for(uint32_t v = 0; v < nofVertices; v++){
+    if(representative[v] == v)continue; // vertex is part of simplified surface
+    // every step only tightens the bound, so the search widens only while it can raise the result
+    vertices.assign(1, representative[v]);
+    double distance = distanceToTrianglesAround(pos[v]);
+    if(distance <= result)continue;
+
+    // vertices that the original one-ring was collapsed onto
+    vertices.clear();
+    for(uint32_t k = originalOffset[v]; k < originalOffset[v + 1]; k++)
+      for(uint32_t i = 0; i < 3; i++)
+        vertices.push_back(representative[original[originalTriangles[k] * 3 + i]]);
+    distance = std::min(distance, distanceToTrianglesAround(pos[v]));
+    if(distance <= result)continue;
+
+    // and their simplified one-ring
+    vertices.clear();
+    for(uint32_t t : candidates)
+      vertices.insert(vertices.end(), &simplified[t * 3], &simplified[t * 3] + 3);
+    distance = std::min(distance, distanceToTrianglesAround(pos[v]));
+    if(!std::isinf(distance))result = std::max(result, distance);
+  }
+  return (float)result;
+}
+
+/**
+ * @brief This function generates simplified levels of detail of mesh.
+ * Each level halves triangle count of the previous one, as long as the error stays below maxError.
+ * Levels are simplified one from another with quadrics carried between them
+ * and error of every level is measured as distance of the full mesh vertices from its surface.
+ *
+ * @param mesh mesh, its lods are filled
+ * @param storage storage that owns generated index buffers
+ * @param maxError maximal allowed error relative to radius of the mesh bounding sphere
+ */
+void generateMeshLods(Mesh &mesh, BufferStorage &storage, float maxError){
+  mesh.nofLods = 0;
+  if(!mesh.indices || !mesh.position.bufferData)return;
+  if(mesh.position.type != AttributeType::VEC3 && mesh.position.type != AttributeType::VEC4)return;
+
+  float const radius = mesh.boundingSphere.w > 0.f ? mesh.boundingSphere.w : 1.f;
+  std::vector<uint32_t> const original = readIndices(mesh);
+  std::vector<uint32_t> current = original, simplified;
+  SimplifyState state;
+  for(uint32_t l = 0; l < maxLods; l++){
+    simplifyIndices(simplified, current, mesh.position, current.size() / 2, maxError * radius, state);
+    if(simplified.empty() || simplified.size() * 10 > current.size() * 9)break; // does not reduce enough
+    float error = glm::max(surfaceDeviation(original, simplified, mesh.position, state), l ? mesh.lods[l - 1].error : 0.f);
+    if(error > maxError * radius)break;
+    MeshLod &lod = mesh.lods[mesh.nofLods++];
+    lod.indices = storeIndices(storage, simplified, mesh.indexType);
+    lod.nofIndices = (uint32_t)simplified.size();
+    lod.error = error;
+    current.swap(simplified);
+  }
+}
@@ -0,0 +1,21 @@
+/*!
+ * @file
+ * @brief This file contains mesh simplification and level of detail generation
+ *
+ * @author Martin Zmitko, xzmitk01@stud.fit.vutbr.cz
+ */
+#pragma once
+
+#include <student/fwd.hpp>
+#include <student/meshAccess.hpp>
+
+#include <vector>
+
+float simplifyIndices(
+    std::vector<uint32_t>      &dst        ,
+    std::vector<uint32_t>const &indices    ,
+    VertexAttrib         const &position   ,
+    size_t                      targetIndices,
+    float                       targetError);
+
+void generateMeshLods(Mesh&mesh,BufferStorage&storage,float maxError = .05f);
@@ -0,0 +1,314 @@
+/*!
+ * @file
+ * @brief This file contains BC1/BC3 block compression of textures and decoding of blocks for sampling
+ *
+ * @author Martin Zmitko, xzmitk01@stud.fit.vutbr.cz
+ */
+#include <student/textureCompression.hpp>
+
+#include <cstring>
+
+/**
+ * @brief This function returns size of texture data in bytes.
+ *
+ * @param width width of texture
+ * @param height height of texture
+ * @param channels number of channels (only used by raw textures)
+ * @param format layout of data
+ *
+ * @return number of bytes
+ */
+size_t textureDataSize(uint32_t width,uint32_t height,uint32_t channels,TextureFormat format){
+  size_t const blocks = (size_t)((width+3)/4)*((height+3)/4);
+  switch(format){
+    case TextureFormat::BC1:return blocks*8;
+    case TextureFormat::BC3:return blocks*16;
+    default                :return (size_t)width*height*channels;
+  }
+}
+
+/**
+ * @brief This function returns size of texture data in bytes.
+ *
+ * @param texture texture
+ *
+ * @return number of bytes
+ */
+size_t textureDataSize(Texture const&texture){
+  return textureDataSize(texture.width,texture.height,texture.channels,texture.format);
+}
+
+uint16_t packColor565(glm::vec3 const&c){
+  auto const q = glm::uvec3(glm::clamp(c,0.f,255.f)*glm::vec3(31.f,63.f,31.f)/255.f+.5f);
+  return (uint16_t)(q.r<<11 | q.g<<5 | q.b);
+}
+
+glm::uvec3 unpackColor565(uint16_t c){
+  uint32_t const r = c>>11&31,g = c>>5&63,b = c&31;
+  return glm::uvec3(r<<3|r>>2,g<<2|g>>4,b<<3|b>>2);
+}
+
+/**
+ * @brief This function computes palette of BC1 color block.
+ *
+ * @param palette 4 colors
+ * @param c0 the first endpoint
+ * @param c1 the second endpoint
+ * @param fourColors interpolate two colors (BC3 or c0 > c1), otherwise the last entry is transparent black
+ */
+void colorPalette(glm::uvec4*palette,uint16_t c0,uint16_t c1,bool fourColors){
+  glm::uvec3 const a = unpackColor565(c0),b = unpackColor565(c1);
+  palette[0] = glm::uvec4(a,255);
+  palette[1] = glm::uvec4(b,255);
+  if(fourColors){
+    palette[2] = glm::uvec4((2u*a+b)/3u,255);
+    palette[3] = glm::uvec4((a+2u*b)/3u,255);
+  }else{
+    palette[2] = glm::uvec4((a+b)/2u,255);
+    palette[3] = glm::uvec4(0);
+  }
+}
+
+/**
+ * @brief This function encodes colors of 4x4 pixels into 8 byte BC1 block.
+ * Endpoints are the extremes of projection onto the principal axis of the colors,
+ * the block is always written in four color mode.
+ *
+ * @param out block
+ * @param px 16 pixels
+ */
+void encodeColorBlock(uint8_t*out,glm::vec3 const*px){
+  glm::vec3 mean = glm::vec3(0.f);
+  for(int i=0;i<16;++i)mean += px[i];
+  mean /= 16.f;
+
+  float cov[6] = {};
+  for(int i=0;i<16;++i){
+    glm::vec3 const d = px[i]-mean;
+    cov[0] += d.r*d.r;cov[1] += d.r*d.g;cov[2] += d.r*d.b;
+    cov[3] += d.g*d.g;cov[4] += d.g*d.b;cov[5] += d.b*d.b;
+  }
+  // power iteration starts from column of the channel with the largest variance, it is never orthogonal to the principal axis
+  glm::vec3 axis = glm::vec3(cov[0],cov[1],cov[2]);
+  if(cov[3] > cov[0] && cov[3] >= cov[5])axis = glm::vec3(cov[1],cov[3],cov[4]);
+  if(cov[5] > cov[0] && cov[5] >  cov[3])axis = glm::vec3(cov[2],cov[4],cov[5]);
+  for(int it=0;it<4;++it){
+    float const len = glm::length(axis);
+    if(len < 1e-6f){axis = glm::vec3(1.f);break;}
+    axis /= len;
+    axis = glm::vec3(cov[0]*axis.r+cov[1]*axis.g+cov[2]*axis.b,
+                     cov[1]*axis.r+cov[3]*axis.g+cov[4]*axis.b,
+                     cov[2]*axis.r+cov[4]*axis.g+cov[5]*axis.b);
+  }
+
+  float minT = +1e30f,maxT = -1e30f;
+  glm::vec3 minC = px[0],maxC = px[0];
+  for(int i=0;i<16;++i){
+    float const t = glm::dot(px[i]-mean,axis);
+    if(t < minT){minT = t;minC = px[i];}
+    if(t > maxT){maxT = t;maxC = px[i];}
+  }
+
+  uint16_t c0 = packColor565(maxC),c1 = packColor565(minC);
+  if(c0 < c1)std::swap(c0,c1);
+  uint32_t indices = 0;
+  if(c0 != c1){
+    glm::uvec4 palette[4];
+    colorPalette(palette,c0,c1,true);
+    for(int i=0;i<16;++i){
+      uint32_t best = 0;
+      float bestDist = 1e30f;
+      for(uint32_t k=0;k<4;++k){
+        glm::vec3 const d = glm::vec3(palette[k])-px[i];
+        float const dist = glm::dot(d,d);
+        if(dist < bestDist){bestDist = dist;best = k;}
+      }
+      indices |= best << (2*i);
+    }
+  }
+  out[0] = (uint8_t)c0;out[1] = (uint8_t)(c0>>8);
+  out[2] = (uint8_t)c1;out[3] = (uint8_t)(c1>>8);
+  for(int i=0;i<4;++i)out[4+i] = (uint8_t)(indices>>(8*i));
+}
+
+/**
+ * @brief This function computes palette of BC3 alpha block.
+ *
+ * @param palette 8 values
+ * @param a0 the first endpoint
+ * @param a1 the second endpoint
+ */
+void alphaPalette(uint32_t*palette,uint32_t a0,uint32_t a1){
+  palette[0] = a0;
+  palette[1] = a1;
+  if(a0 > a1){
+    for(uint32_t k=1;k<7;++k)palette[k+1] = ((7-k)*a0+k*a1)/7;
+  }else{
+    for(uint32_t k=1;k<5;++k)palette[k+1] = ((5-k)*a0+k*a1)/5;
+    palette[6] = 0;
+    palette[7] = 255;
+  }
+}
+
+/**
+ * @brief This function encodes alpha of 4x4 pixels into 8 byte BC3 alpha block.
+ *
+ * @param out block
+ * @param alpha 16 values
+ */
+void encodeAlphaBlock(uint8_t*out,uint8_t const*alpha){
+  uint32_t a0 = 0,a1 = 255;
+  for(int i=0;i<16;++i){
+    a0 = glm::max(a0,(uint32_t)alpha[i]);
+    a1 = glm::min(a1,(uint32_t)alpha[i]);
+  }
+  uint64_t indices = 0;
+  if(a0 != a1){
+    uint32_t palette[8];
+    alphaPalette(palette,a0,a1);
+    for(int i=0;i<16;++i){
+      uint64_t best = 0;
+      uint32_t bestDist = 256;
+      for(uint32_t k=0;k<8;++k){
+        uint32_t const dist = (uint32_t)glm::abs((int)palette[k]-(int)alpha[i]);
+        if(dist < bestDist){bestDist = dist;best = k;}
+      }
+      indices |= best << (3*i);
+    }
+  }
+  out[0] = (uint8_t)a0;
+  out[1] = (uint8_t)a1;
+  for(int i=0;i<6;++i)out[2+i] = (uint8_t)(indices>>(8*i));
+}
+
+/**
+ * @brief This function compresses image into BC1 or BC3 blocks.
+ * Blocks on the right and bottom border repeat the last column and row of image.
+ *
+ * @param pixels image, rows from top to bottom
+ * @param width width of image
+ * @param height height of image
+ * @param channels number of channels of image (3 or 4, BC3 treats missing alpha as 255)
+ * @param format BC1 or BC3
+ *
+ * @return blocks in row major order
+ */
+std::vector<uint8_t>compressTexture(uint8_t const*pixels,uint32_t width,uint32_t height,uint32_t channels,TextureFormat format){
+  std::vector<uint8_t>res(textureDataSize(width,height,channels,format));
+  if(format == TextureFormat::RAW || !width || !height)return res;
+  uint32_t const blocksX = (width+3)/4,blocksY = (height+3)/4;
+  uint8_t*out = res.data();
+  for(uint32_t by=0;by<blocksY;++by)
+    for(uint32_t bx=0;bx<blocksX;++bx){
+      glm::vec3 colors[16];
+      uint8_t   alpha [16];
+      for(uint32_t i=0;i<16;++i){
+        uint32_t const x = glm::min(bx*4+(i&3),width-1),y = glm::min(by*4+(i>>2),height-1);
+        uint8_t const*p = pixels+((size_t)y*width+x)*channels;
+        colors[i] = glm::vec3(p[0],channels > 1 ? p[1] : p[0],channels > 2 ? p[2] : p[0]);
+        alpha [i] = channels > 3 ? p[3] : 255;
+      }
+      if(format == TextureFormat::BC3){
+        encodeAlphaBlock(out,alpha);
+        out += 8;
+      }
+      encodeColorBlock(out,colors);
+      out += 8;
+    }
+  return res;
+}
+
+/**
+ * @brief This function decodes one BC1 or BC3 block.
+ *
+ * @param rgba 16 decoded pixels with 4 channels, rows from top to bottom
+ * @param block compressed block
+ * @param format BC1 or BC3
+ */
+void decodeTextureBlock(uint8_t*rgba,uint8_t const*block,TextureFormat format){
+  uint32_t alpha[8] = {255,255,255,255,255,255,255,255};
+  uint64_t alphaIndices = 0;
+  if(format == TextureFormat::BC3){
+    alphaPalette(alpha,block[0],block[1]);
+    for(int i=0;i<6;++i)alphaIndices |= (uint64_t)block[2+i] << (8*i);
+    block += 8;
+  }
+  uint16_t const c0 = (uint16_t)(block[0] | block[1]<<8);
+  uint16_t const c1 = (uint16_t)(block[2] | block[3]<<8);
+  uint32_t const indices = (uint32_t)block[4] | (uint32_t)block[5]<<8 | (uint32_t)block[6]<<16 | (uint32_t)block[7]<<24;
+  glm::uvec4 palette[4];
+  colorPalette(palette,c0,c1,format == TextureFormat::BC3 || c0 > c1);
+  for(uint32_t i=0;i<16;++i){
+    glm::uvec4 const&c = palette[indices>>(2*i)&3];
+    rgba[i*4+0] = (uint8_t)c.r;
+    rgba[i*4+1] = (uint8_t)c.g;
+    rgba[i*4+2] = (uint8_t)c.b;
+    rgba[i*4+3] = format == TextureFormat::BC3 ? (uint8_t)alpha[alphaIndices>>(3*i)&7] : (uint8_t)c.a;
+  }
+}
+
+/**
+ * @brief This function decodes whole BC1 or BC3 texture into interleaved pixels.
+ *
+ * @param data compressed blocks
+ * @param width width of texture
+ * @param height height of texture
+ * @param channels number of channels of decoded pixels (1-4)
+ * @param format BC1 or BC3, RAW data are copied
+ *
+ * @return pixels, rows from top to bottom
+ */
+std::vector<uint8_t>decompressTexture(uint8_t const*data,uint32_t width,uint32_t height,uint32_t channels,TextureFormat format){
+  if(format == TextureFormat::RAW)return std::vector<uint8_t>(data,data+(size_t)width*height*channels);
+  std::vector<uint8_t>res((size_t)width*height*channels);
+  uint32_t const blocksX = (width+3)/4,blocksY = (height+3)/4;
+  size_t   const blockSize = format == TextureFormat::BC1 ? 8 : 16;
+  uint8_t rgba[64];
+  for(uint32_t by=0;by<blocksY;++by)
+    for(uint32_t bx=0;bx<blocksX;++bx){
+      decodeTextureBlock(rgba,data+((size_t)by*blocksX+bx)*blockSize,format);
+      for(uint32_t i=0;i<16;++i){
+        uint32_t const x = bx*4+(i&3),y = by*4+(i>>2);
+        if(x >= width || y >= height)continue;
+        memcpy(res.data()+((size_t)y*width+x)*channels,rgba+i*4,channels);
+      }
+    }
+  return res;
+}
+
+/**
+ * @brief This struct holds one decoded block of texture cache
+ */
+struct DecodedBlock{
+  uint64_t      key[2]                    ;///< compressed block (BC1 only uses the first word)
+  TextureFormat format = TextureFormat::RAW;///< format of compressed block, RAW marks empty entry
+  uint8_t       rgba[64]                  ;///< decoded pixels
+};
+
+/**
+ * @brief This function returns decoded block of compressed texture.
+ * Every thread has small direct mapped cache of recently decoded blocks.
+ * Entries are keyed by the compressed bytes, so the cache never returns stale data
+ * even if texture memory is freed and reused.
+ *
+ * @param texture BC1 or BC3 texture
+ * @param blockX x coordinate of block
+ * @param blockY y coordinate of block
+ *
+ * @return 16 pixels with 4 channels
+ */
+uint8_t const*decodedTextureBlock(Texture const&texture,uint32_t blockX,uint32_t blockY){
+  thread_local DecodedBlock cache[16];
+  bool const bc1 = texture.format == TextureFormat::BC1;
+  uint8_t const*block = texture.data + ((size_t)blockY*((texture.width+3)/4)+blockX)*(bc1 ? 8 : 16);
+  uint64_t key[2] = {0,0};
+  memcpy(key,block,8);
+  if(!bc1)memcpy(key+1,block+8,8);
+  DecodedBlock&entry = cache[(blockX&3) | (blockY&3)<<2];
+  if(entry.format == texture.format && entry.key[0] == key[0] && entry.key[1] == key[1])return entry.rgba;
+  entry.key[0] = key[0];
+  entry.key[1] = key[1];
+  entry.format = texture.format;
+  decodeTextureBlock(entry.rgba,block,texture.format);
+  return entry.rgba;
+}
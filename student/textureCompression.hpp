@@ -0,0 +1,23 @@
+/*!
+ * @file
+ * @brief This file contains BC1/BC3 block compression of textures and decoding of blocks for sampling
+ *
+ * @author Martin Zmitko, xzmitk01@stud.fit.vutbr.cz
+ */
+#pragma once
+
+#include <student/fwd.hpp>
+
+#include <vector>
+
+size_t textureDataSize(uint32_t width,uint32_t height,uint32_t channels,TextureFormat format);
+
+size_t textureDataSize(Texture const&texture);
+
+std::vector<uint8_t>compressTexture(uint8_t const*pixels,uint32_t width,uint32_t height,uint32_t channels,TextureFormat format);
+
+std::vector<uint8_t>decompressTexture(uint8_t const*data,uint32_t width,uint32_t height,uint32_t channels,TextureFormat format);
+
+void decodeTextureBlock(uint8_t*rgba,uint8_t const*block,TextureFormat format);
+
+uint8_t const*decodedTextureBlock(Texture const&texture,uint32_t blockX,uint32_t blockY);
@@ -0,0 +1,156 @@
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+
+#include <framework/imageWriter.hpp>
+#include <framework/offscreenRenderer.hpp>
+#include <framework/threadPool.hpp>
+#include <framework/timer.hpp>
+#include <tests/batchRender.hpp>
+
+#include <json.hpp>
+
+namespace batchRender{
+
+/**
+ * @brief This struct holds one image of batch
+ */
+struct View{
+  uint32_t    width  = 500;///< width of image
+  uint32_t    height = 500;///< height of image
+  RenderView  view        ;///< camera and light
+  std::string file        ;///< output file
+};
+
+glm::vec3 toVec3(nlohmann::json const&j){
+  return glm::vec3(j.at(0).get<float>(),j.at(1).get<float>(),j.at(2).get<float>());
+}
+
+/**
+ * @brief This function parses view of job file.
+ * Missing keys keep default scene parameters of the application.
+ *
+ * @param j view
+ *
+ * @return view with empty file name if it is not specified
+ */
+View parseView(nlohmann::json const&j){
+  View res;
+  res.width  = j.value("width" ,res.width );
+  res.height = j.value("height",res.height);
+  basicCamera::OrbitCamera       orbit;
+  basicCamera::PerspectiveCamera proj;
+  glm::vec3                      light;
+  defaultSceneParameters(orbit,proj,light,res.width,res.height);
+  if(j.count("yaw"     ))orbit.setYAngle  (glm::radians(j["yaw"  ].get<float>()));
+  if(j.count("pitch"   ))orbit.setXAngle  (glm::radians(j["pitch"].get<float>()));
+  if(j.count("distance"))orbit.setDistance(j["distance"].get<float>());
+  if(j.count("focus"   ))orbit.setFocus   (-toVec3(j["focus"]));
+  if(j.count("fovy"    ))proj .setFovy    (glm::radians(j["fovy" ].get<float>()));
+  if(j.count("near"    ))proj .setNear    (j["near"].get<float>());
+  if(j.count("far"     ))proj .setFar     (j["far" ].get<float>());
+  if(j.count("light"   ))light = toVec3(j["light"]);
+  res.view = renderView(orbit,proj,light);
+  res.file = j.value("file",std::string());
+  return res;
+}
+
+}
+
+using namespace batchRender;
+
+void runBatchRender(std::string const&jobFile,DrawSettings const&drawSettings,ModelLoadOptions const&loadOptions,ImageWriterOptions const&imageOptions){
+  std::ifstream input(jobFile);
+  if(!input.is_open()){
+    std::cerr << "batch: job file \"" << jobFile << "\" cannot be opened" << std::endl;
+    return;
+  }
+  nlohmann::json job;
+  input >> job;
+
+  std::filesystem::path const output = job.value("output",std::string("."));
+  std::filesystem::create_directories(output);
+  glm::vec4 background = glm::vec4(.5f,.5f,1.f,0.f);
+  if(job.count("background"))
+    for(int c=0;c<4;++c)background[c] = job["background"].at(c).get<float>();
+
+  std::vector<View>defaultViews;
+  if(job.count("views"))
+    for(auto const&v:job["views"])defaultViews.push_back(parseView(v));
+  if(defaultViews.empty())defaultViews.push_back(View());
+
+  std::string const format = job.value("format",std::string("png"));
+  ImageWriterOptions writerOptions = imageOptions;
+  writerOptions.pngLevel   = job.value("pngLevel"  ,writerOptions.pngLevel  );
+  writerOptions.pngFilters = job.value("pngFilters",writerOptions.pngFilters);
+
+  ThreadPool  renderPool(job.value("threads",0u));
+  ImageWriter writer(writerOptions);
+
+  // drawing does not stream textures, every view needs its own scene and all of them are drawn from one model
+  DrawSettings settings = drawSettings;
+  settings.textureStreaming = false;
+  ModelLoadOptions options = loadOptions;
+  options.textureBudget = 0;
+  options.lazyImages    = false;
+
+  size_t nofImages = 0;
+  size_t nofFailed = 0;
+  Timer<float>total;
+  for(auto const&m:job.value("models",nlohmann::json::array())){
+    std::string file;
+    std::vector<View>views;
+    std::unique_ptr<OffscreenModel>model;
+    Timer<float>timer;
+    // broken entry of job file or model that cannot be loaded must not stop the whole batch
+    try{
+      file = m.is_string() ? m.get<std::string>() : m.at("file").get<std::string>();
+      if(!std::filesystem::exists(file)){
+        std::cerr << "batch: model " << file << " does not exist, skipped" << std::endl;
+        ++nofFailed;
+        continue;
+      }
+      if(m.is_object() && m.count("views"))
+        for(auto const&v:m["views"])views.push_back(parseView(v));
+      if(views.empty())views = defaultViews;
+      std::string const stem = std::filesystem::path(file).stem().string();
+      for(size_t i=0;i<views.size();++i)
+        if(views[i].file.empty())views[i].file = (output/(stem+"_"+std::to_string(i)+"."+format)).string();
+
+      timer.reset();
+      model = std::make_unique<OffscreenModel>(file,settings,options);
+      model->modelData.updateTextures(model->model);
+    }catch(std::exception const&e){
+      std::cerr << "batch: model " << (file.empty() ? m.dump() : file) << " failed: " << e.what() << ", skipped" << std::endl;
+      ++nofFailed;
+      continue;
+    }
+    float const loadTime = timer.elapsedFromStart();
+
+    timer.reset();
+    for(auto const&v:views)
+      renderPool.add([&,v]{
+        OffscreenRenderer renderer(v.width,v.height);
+        Scene scene = model->scene;
+        renderer.render(model->model,scene,model->drawSettings,v.view,background);
+        writer.write(v.file,std::vector<uint8_t>(renderer.getColor()),v.width,v.height);
+      });
+    renderPool.wait();
+    nofImages += views.size();
+
+    std::cout << file << ": " << views.size() << " views, load " << std::fixed << std::setprecision(1)
+              << loadTime*1000.f << " ms, render " << timer.elapsedFromStart()*1000.f << " ms" << std::endl;
+  }
+  writer.wait();
+  if(nofFailed)
+    std::cerr << "batch: " << nofFailed << " models could not be rendered" << std::endl;
+  if(writer.getFailed())
+    std::cerr << "batch: " << writer.getFailed() << " images could not be written" << std::endl;
+
+  float const seconds = total.elapsedFromStart();
+  std::cout << "batch: " << nofImages << " images in " << std::fixed << std::setprecision(2) << seconds << " s ("
+            << (seconds > 0.f ? (float)nofImages/seconds : 0.f) << " images/s)" << std::endl;
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <string>
+
+#include <framework/imageWriter.hpp>
+#include <framework/model.hpp>
+#include <student/drawModel.hpp>
+
+/**
+ * @brief This function renders all views of all models listed in JSON job file.
+ *
+ * Job file:
+ * {
+ *   "output"    : "thumbnails",           // directory of images without explicit file, default "."
+ *   "threads"   : 0,                      // rendering threads, 0 = number of hardware threads
+ *   "format"    : "png",                  // extension of images without explicit file: png, ppm, qoi, raw
+ *   "pngLevel"  : 8,                      // deflate level, 0 = uncompressed (overrides --png-level)
+ *   "pngFilters": true,                   // choose PNG filter per row (overrides --png-no-filters)
+ *   "background": [0.5,0.5,1.0,0.0],
+ *   "views"     : [ VIEW, ... ],          // views of models that do not list their own
+ *   "models"    : [ {"file":"a.glb","views":[ VIEW, ... ]}, "b.glb", ... ]
+ * }
+ * VIEW (every key is optional, missing keys keep default scene parameters):
+ * {"width":256,"height":256,"yaw":-20,"pitch":0,"distance":36,"focus":[0,0,0],
+ *  "fovy":90,"near":0.1,"far":1.57,"light":[100,100,100],"file":"a_front.png"}
+ * Angles are in degrees, images without "file" are stored as output/<model>_<view>.<format>.
+ * Format of image is selected by extension of its file.
+ *
+ * @param jobFile JSON job file
+ * @param drawSettings optional stages of model rendering
+ * @param loadOptions optional processing of loaded models
+ * @param imageOptions encoding of written images
+ */
+void runBatchRender(std::string const&jobFile,DrawSettings const&drawSettings = DrawSettings{},ModelLoadOptions const&loadOptions = ModelLoadOptions{},ImageWriterOptions const&imageOptions = ImageWriterOptions{});
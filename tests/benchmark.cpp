@@ -0,0 +1,220 @@
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <thread>
+
+#include <BasicCamera/OrbitCamera.h>
+#include <BasicCamera/PerspectiveCamera.h>
+#include <examples/modelMethod.hpp>
+#include <examples/phongMethod.hpp>
+#include <framework/application.hpp>
+#include <framework/frameTimes.hpp>
+#include <framework/framebuffer.hpp>
+#include <framework/timer.hpp>
+#include <tests/benchmark.hpp>
+#include <json.hpp>
+
+namespace benchmark{
+
+/**
+ * @brief This function writes .glb file with UV sphere of radius 10 (procedural stress mesh).
+ *
+ * @param fileName file name
+ * @param segments number of segments around sphere, there are segments/2 rings
+ *
+ * @return number of triangles
+ */
+size_t writeSphereGlb(std::string const&fileName,uint32_t segments){
+  segments = std::max(segments,3u);
+  uint32_t const rings = std::max(segments/2,2u);
+  float const pi = glm::pi<float>();
+  std::vector<float>vertices; // positions followed by normals
+  std::vector<float>normals;
+  for(uint32_t r=0;r<=rings;++r)
+    for(uint32_t s=0;s<=segments;++s){
+      float const theta = pi*(float)r/(float)rings,phi = 2.f*pi*(float)s/(float)segments;
+      glm::vec3 const n = glm::vec3(glm::sin(theta)*glm::cos(phi),glm::cos(theta),glm::sin(theta)*glm::sin(phi));
+      for(int k=0;k<3;++k){
+        vertices.push_back(n[k]*10.f);
+        normals .push_back(n[k]);
+      }
+    }
+  std::vector<uint32_t>indices;
+  for(uint32_t r=0;r<rings;++r)
+    for(uint32_t s=0;s<segments;++s){
+      uint32_t const a = r*(segments+1)+s,b = a+segments+1;
+      indices.insert(indices.end(),{a,a+1,b, a+1,b+1,b});
+    }
+  uint32_t const nofVertices = (uint32_t)vertices.size()/3;
+  vertices.insert(vertices.end(),normals.begin(),normals.end());
+
+  size_t const indexBytes  = indices.size()*sizeof(uint32_t);
+  size_t const vertexBytes = (size_t)nofVertices*3*sizeof(float);
+  std::string json = std::string()+
+    R".({"asset":{"version":"2.0"},"scenes":[{"nodes":[0]}],"nodes":[{"mesh":0}],)."+
+    R".("meshes":[{"primitives":[{"attributes":{"POSITION":1,"NORMAL":2},"indices":0}]}],)."+
+    R".("buffers":[{"byteLength":)."+std::to_string(indexBytes+2*vertexBytes)+R".(}],)."+
+    R".("bufferViews":[{"buffer":0,"byteLength":)."+std::to_string(indexBytes)+R".(},)."+
+    R".({"buffer":0,"byteOffset":)."+std::to_string(indexBytes)+R".(,"byteLength":)."+std::to_string(vertexBytes)+R".(},)."+
+    R".({"buffer":0,"byteOffset":)."+std::to_string(indexBytes+vertexBytes)+R".(,"byteLength":)."+std::to_string(vertexBytes)+R".(}],)."+
+    R".("accessors":[{"bufferView":0,"componentType":5125,"count":)."+std::to_string(indices.size())+R".(,"type":"SCALAR"},)."+
+    R".({"bufferView":1,"componentType":5126,"count":)."+std::to_string(nofVertices)+R".(,"type":"VEC3","min":[-10,-10,-10],"max":[10,10,10]},)."+
+    R".({"bufferView":2,"componentType":5126,"count":)."+std::to_string(nofVertices)+R".(,"type":"VEC3"}]}).";
+  json.resize((json.size()+3)&~size_t(3),' ');
+
+  std::ofstream file(fileName,std::ios::binary);
+  uint32_t const binLength = (uint32_t)(indexBytes+2*vertexBytes);
+  uint32_t const header[] = {0x46546C67u,2u,(uint32_t)(28+json.size()+binLength),(uint32_t)json.size(),0x4E4F534Au};
+  uint32_t const binHeader[] = {binLength,0x004E4942u};
+  file.write((char const*)header,sizeof(header));
+  file.write(json.data(),json.size());
+  file.write((char const*)binHeader,sizeof(binHeader));
+  file.write((char const*)indices.data(),indexBytes);
+  file.write((char const*)vertices.data(),2*vertexBytes);
+  return indices.size()/3;
+}
+
+/**
+ * @brief This function creates rendering method of benchmarked model.
+ *
+ * @param model model file, "bunny" or "sphere:N"
+ * @param temporaryFile generated file that has to be removed, empty if there is none
+ *
+ * @return method, nullptr if model file does not exist
+ */
+std::shared_ptr<Method>createMethod(std::string const&model,std::string&temporaryFile,DrawSettings const&drawSettings,ModelLoadOptions const&loadOptions){
+  if(model == "bunny")
+    return std::make_shared<phongMethod::Method>();
+  std::string file = model;
+  if(model.rfind("sphere:",0) == 0){
+    file = temporaryFile = (std::filesystem::temp_directory_path()/("izgBench"+model.substr(7)+".glb")).string();
+    writeSphereGlb(file,(uint32_t)std::stoul(model.substr(7)));
+  }
+  if(!std::filesystem::exists(file))return nullptr;
+  auto cd = std::make_shared<modelMethod::ConstructionData>(file,drawSettings,loadOptions);
+  return std::make_shared<modelMethod::Method>(&*cd);
+}
+
+/**
+ * @brief This function places camera on scripted path.
+ *
+ * @param path static, orbit (one turn around model) or zoom (from 1.5x to 0.5x of default distance)
+ * @param t position on path in range [0,1)
+ */
+void cameraOnPath(basicCamera::OrbitCamera&orbit,basicCamera::PerspectiveCamera&proj,glm::vec3&light,
+                  std::string const&path,float t,uint32_t width,uint32_t height){
+  orbit = basicCamera::OrbitCamera();
+  proj  = basicCamera::PerspectiveCamera();
+  defaultSceneParameters(orbit,proj,light,width,height);
+  if(path == "orbit")orbit.addYAngle(2.f*glm::pi<float>()*t);
+  if(path == "zoom" )orbit.setDistance(orbit.getDistance()*(1.5f-t));
+}
+
+}
+
+using namespace benchmark;
+
+/**
+ * @brief This function renders every combination of model, framebuffer size and camera path.
+ * Each scenario renders warmup frames first, then measured frames along its camera path.
+ * Median, 95th percentile and standard deviation are printed and optionally stored as JSON.
+ *
+ * @param settings scenarios
+ * @param drawSettings optional stages of model rendering
+ * @param loadOptions optional processing of loaded models
+ */
+void runBenchmark(BenchmarkSettings const&settings,DrawSettings const&drawSettings,ModelLoadOptions const&loadOptions){
+  nlohmann::json results;
+  results["version"] = 1;
+  results["frames" ] = settings.frames;
+  results["warmup" ] = settings.warmup;
+  results["hardwareThreads"] = std::thread::hardware_concurrency();
+  results["drawSettings"] = {
+    {"sortDrawCalls"   ,drawSettings.sortDrawCalls   },
+    {"frustumCulling"  ,drawSettings.frustumCulling  },
+    {"occlusionCulling",drawSettings.occlusionCulling},
+    {"lodSelection"    ,drawSettings.lodSelection    },
+    {"meshletCulling"  ,drawSettings.meshletCulling  },
+    {"textureStreaming",drawSettings.textureStreaming},
+  };
+  results["scenarios"] = nlohmann::json::array();
+
+  for(auto const&model:settings.models){
+    std::string temporaryFile;
+    Timer<float>loadTimer;
+    auto method = createMethod(model,temporaryFile,drawSettings,loadOptions);
+    float const loadTime = loadTimer.elapsedFromStart();
+    if(!method){
+      std::cerr << "benchmark: model " << model << " does not exist, skipped" << std::endl;
+      continue;
+    }
+
+    for(auto const&size:settings.sizes){
+      uint32_t width = 0,height = 0;
+      if(sscanf(size.c_str(),"%ux%u",&width,&height) != 2 || !width || !height){
+        std::cerr << "benchmark: size " << size << " is not WIDTHxHEIGHT, skipped" << std::endl;
+        continue;
+      }
+      Framebuffer framebuffer(width,height);
+      auto frame = framebuffer.getFrame();
+
+      for(auto const&path:settings.paths){
+        basicCamera::OrbitCamera       orbit;
+        basicCamera::PerspectiveCamera proj;
+        glm::vec3                      light;
+        auto draw = [&](float t){
+          cameraOnPath(orbit,proj,light,path,t,width,height);
+          auto const view   = orbit.getView();
+          auto const camera = glm::vec3(glm::inverse(view)*glm::vec4(0.f,0.f,0.f,1.f));
+          method->onDraw(frame,proj.getProjection(),view,light,camera);
+        };
+
+        for(uint32_t f=0;f<settings.warmup;++f)draw(0.f);
+
+        FrameTimes times;
+        Timer<float>timer;
+        for(uint32_t f=0;f<settings.frames;++f){
+          float const t = (float)f/(float)std::max(settings.frames,1u);
+          timer.reset();
+          draw(t);
+          times.add(timer.elapsedFromStart());
+        }
+
+        std::string const name = model+" "+std::to_string(width)+"x"+std::to_string(height)+" "+path;
+        std::cout << std::left << std::setw(36) << name << std::right << std::fixed << std::setprecision(3)
+                  << " median " << std::setw(9) << times.percentile(50.f)*1000.f << " ms"
+                  << "  p95 "   << std::setw(9) << times.percentile(95.f)*1000.f << " ms"
+                  << "  stddev "<< std::setw(8) << times.stddev()*1000.f          << " ms" << std::endl;
+
+        nlohmann::json scenario;
+        scenario["name"     ] = name;
+        scenario["model"    ] = model;
+        scenario["width"    ] = width;
+        scenario["height"   ] = height;
+        scenario["path"     ] = path;
+        scenario["loadMs"   ] = loadTime*1000.f;
+        scenario["meanMs"   ] = times.mean()*1000.f;
+        scenario["medianMs" ] = times.percentile(50.f)*1000.f;
+        scenario["p95Ms"    ] = times.percentile(95.f)*1000.f;
+        scenario["stddevMs" ] = times.stddev()*1000.f;
+        scenario["minMs"    ] = times.percentile(0.f)*1000.f;
+        scenario["maxMs"    ] = times.percentile(100.f)*1000.f;
+        std::vector<float>frameMs;
+        for(auto const&t:times.getTimes())frameMs.push_back(t*1000.f);
+        scenario["framesMs" ] = frameMs;
+        results["scenarios"].push_back(scenario);
+      }
+    }
+    method = nullptr;
+    if(!temporaryFile.empty())std::filesystem::remove(temporaryFile);
+  }
+
+  if(settings.jsonFile.empty())return;
+  std::ofstream file(settings.jsonFile);
+  file << results.dump(2) << std::endl;
+  std::cerr << "benchmark: results stored to \"" << settings.jsonFile << "\"" << std::endl;
+}
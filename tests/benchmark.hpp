@@ -0,0 +1,21 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <framework/model.hpp>
+#include <student/drawModel.hpp>
+
+/**
+ * @brief This struct holds scenarios of benchmark
+ */
+struct BenchmarkSettings{
+  std::vector<std::string>models     ;///< model files, "bunny" selects phong bunny, "sphere:N" procedural sphere with N segments
+  std::vector<std::string>sizes      ;///< framebuffer sizes as WIDTHxHEIGHT
+  std::vector<std::string>paths      ;///< camera paths: static, orbit, zoom
+  uint32_t                frames = 20;///< measured frames per scenario
+  uint32_t                warmup = 3 ;///< frames rendered before measurement
+  std::string             jsonFile   ;///< file with machine readable results, empty = no file
+};
+
+void runBenchmark(BenchmarkSettings const&settings,DrawSettings const&drawSettings = DrawSettings{},ModelLoadOptions const&loadOptions = ModelLoadOptions{});
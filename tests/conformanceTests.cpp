@@ -1,6 +1,18 @@
 #include <iostream>
 #include <sstream>
 #include <iomanip>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <thread>
+
+#if !defined(_WIN32)
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
 
 #include <tests/conformanceTests.hpp>
 
@@ -10,43 +22,193 @@
 std::string groundTruthFile;
 std::string modelFile      ;
 
-void runConformanceTests(std::string const&groundTruth,std::string const&model,int test,bool upTo) {
+/**
+ * @brief This function returns model loaded with default settings, every file is loaded only once per process.
+ * Worker processes of conformance tests inherit models loaded before they are started.
+ *
+ * @param file model file
+ *
+ * @return model
+ */
+OffscreenModel&cachedModel(std::string const&file){
+  static std::map<std::string,std::unique_ptr<OffscreenModel>>models;
+  auto&model = models[file];
+  if(!model)model = std::make_unique<OffscreenModel>(file);
+  return *model;
+}
+
+namespace conformanceTests{
+
+size_t const nofGradedTests = 39;///< scenarios 00-38 are graded, later scenarios test optional optimizations and are reported separately
+
+/**
+ * @brief This struct holds result of one scenario
+ */
+struct ScenarioRun{
+  size_t      scenario = 0    ;///< index of scenario
+  bool        passed   = false;///< scenario passed
+  double      ms       = 0.   ;///< wall time in milliseconds
+  std::string output          ;///< captured stdout and stderr of scenario
+};
+
+std::string scenarioArg(size_t i){
+  std::stringstream ss;
+  ss << "\"Scenario: " << std::setfill('0') << std::setw(2) << i << "\",";
+  return ss.str();
+}
+
+int runCatch(std::vector<std::string>const&tests){
+  std::vector<std::string>argvs = {"test"};
+  argvs.insert(argvs.end(),tests.begin(),tests.end());
+  std::vector<char const*>argv;
+  for(auto const&s:argvs)argv.push_back(s.c_str());
+  return Catch::Session().run((int)argv.size(), argv.data());
+}
+
+#if !defined(_WIN32)
+/**
+ * @brief This function runs every scenario in its own forked process, at most jobs processes run at once.
+ * Catch session can be run only once per process, so a process per scenario also gives wall time of every scenario
+ * and a crashing scenario does not stop the others. Output of scenarios is printed in order of scenarios.
+ *
+ * @param scenarios selected scenarios
+ * @param jobs maximal number of running processes
+ *
+ * @return results of scenarios
+ */
+std::vector<ScenarioRun>runForked(std::vector<size_t>const&scenarios,uint32_t jobs){
+  using Clock = std::chrono::steady_clock;
+  struct Worker{
+    size_t            run   ;
+    FILE*             output;
+    Clock::time_point start ;
+  };
+  std::vector<ScenarioRun>runs(scenarios.size());
+  std::map<pid_t,Worker>workers;
+  size_t started = 0,printed = 0;
+  std::vector<bool>finished(scenarios.size(),false);
+
+  std::cout.flush();
+  std::cerr.flush();
+  while(printed < scenarios.size()){
+    while(started < scenarios.size() && workers.size() < jobs){
+      size_t const run = started++;
+      runs[run].scenario = scenarios[run];
+      FILE*output = std::tmpfile();
+      auto const start = Clock::now();
+      pid_t const pid = output ? fork() : -1;
+      if(pid == 0){
+        dup2(fileno(output),STDOUT_FILENO);
+        dup2(fileno(output),STDERR_FILENO);
+        int const result = runCatch({scenarioArg(scenarios[run])});
+        std::cout.flush();
+        std::cerr.flush();
+        std::_Exit(result ? 1 : 0);
+      }
+      if(pid < 0){
+        if(output)std::fclose(output);
+        runs[run].output = "conformance tests: worker process cannot be started\n";
+        finished[run] = true;
+        continue;
+      }
+      workers[pid] = Worker{run,output,start};
+    }
+
+    if(!workers.empty()){
+      int status = 0;
+      pid_t const pid = wait(&status);
+      auto const it = workers.find(pid);
+      if(it == workers.end())continue;
+      Worker const w = it->second;
+      workers.erase(it);
+      auto&r = runs[w.run];
+      r.ms     = std::chrono::duration<double,std::milli>(Clock::now()-w.start).count();
+      r.passed = WIFEXITED(status) && WEXITSTATUS(status) == 0;
+      std::rewind(w.output);
+      char buffer[4096];
+      size_t n;
+      while((n = std::fread(buffer,1,sizeof(buffer),w.output)) > 0)r.output.append(buffer,n);
+      std::fclose(w.output);
+      if(WIFSIGNALED(status))r.output += "\nconformance tests: scenario was killed by signal "+std::to_string(WTERMSIG(status))+"\n";
+      finished[w.run] = true;
+    }
+
+    for(;printed < scenarios.size() && finished[printed];++printed){
+      auto const&r = runs[printed];
+      if(!r.passed)std::cerr << r.output;
+      std::cerr << "  " << std::setw(2) << std::setfill('0') << r.scenario << std::setfill(' ') << (r.passed ? " passed " : " FAILED ")
+                << std::fixed << std::setprecision(1) << std::setw(9) << r.ms << " ms" << std::endl;
+    }
+  }
+  return runs;
+}
+#endif
+
+void printTimes(std::vector<ScenarioRun>runs,double wallMs,uint32_t jobs){
+  double sum = 0.;
+  for(auto const&r:runs)sum += r.ms;
+  std::sort(runs.begin(),runs.end(),[](ScenarioRun const&a,ScenarioRun const&b){return a.ms > b.ms;});
+  std::cerr << "slowest scenarios:";
+  for(size_t i=0;i<std::min(runs.size(),(size_t)5);++i)
+    std::cerr << " " << std::setw(2) << std::setfill('0') << runs[i].scenario << std::setfill(' ') << " (" << std::fixed << std::setprecision(1) << runs[i].ms << " ms)";
+  std::cerr << std::endl << "scenarios took " << std::setprecision(2) << sum/1000. << " s, wall time " << wallMs/1000. << " s with " << jobs << " worker processes" << std::endl;
+}
+
+}
+
+using namespace conformanceTests;
+
+void runConformanceTests(std::string const&groundTruth,std::string const&model,int test,bool upTo,uint32_t jobs) {
   groundTruthFile = groundTruth;
   modelFile       = model      ;
-  //int         argc   = 1;
-  //char const* argv[1] = {"test"};
 
   Catch::Config cfg;
   auto tests = Catch::getAllTestCasesSorted(cfg);
   auto nofTests = tests.size();
 
-  std::vector<char const*>argv;
-  std::vector<std::string>argvs;
-  argvs.push_back("test");
-
-  auto insertTest = [&](size_t i){
-    std::stringstream ss;
-    ss << "\"Scenario: " << std::setfill('0') << std::setw(2) << i << "\",";
-    argvs.push_back(ss.str().c_str());
-  };
-
+  std::vector<size_t>scenarios;
   if(test>=0&&(size_t)test<nofTests){
     if(upTo){
       for(size_t i=0;i<=(size_t)test;++i)
-        insertTest(i);
+        scenarios.push_back(i);
     }else{
-      insertTest(test);
+      scenarios.push_back(test);
     }
   }else{
     for(size_t i=0;i<nofTests;++i)
-      insertTest(i);
+      scenarios.push_back(i);
   }
 
-  for(auto const&s:argvs)argv.push_back(s.c_str());
-  int result = Catch::Session().run((int)argv.size(), argv.data());
+  auto const nofGraded = std::min(nofTests,nofGradedTests);
+  int result = 0;
+#if defined(_WIN32)
+  // failures of one Catch session cannot be assigned to scenarios, so only graded scenarios are run
+  (void)jobs;
+  std::vector<std::string>argvs;
+  for(auto const&i:scenarios)if(i<nofGraded)argvs.push_back(scenarioArg(i));
+  result = runCatch(argvs);
+#else
+  if(!jobs)jobs = std::max(std::thread::hardware_concurrency(),1u);
+  // the model is loaded once, forked workers share it
+  if(scenarios.size() > 1 && std::filesystem::exists(modelFile))cachedModel(modelFile);
+  auto const start = std::chrono::steady_clock::now();
+  auto const runs = runForked(scenarios,jobs);
+  double const wallMs = std::chrono::duration<double,std::milli>(std::chrono::steady_clock::now()-start).count();
+  size_t nofExtra = 0,extraFailed = 0;
+  for(auto const&r:runs){
+    if(r.scenario<nofGraded){
+      result += !r.passed;
+    }else{
+      nofExtra++;
+      extraFailed += !r.passed;
+    }
+  }
+  printTimes(runs,wallMs,jobs);
+  if(nofExtra)std::cerr << "optimization scenarios (not graded): " << nofExtra-extraFailed << "/" << nofExtra << " passed" << std::endl;
+#endif
 
   size_t maxPoints = 18;
-  std::cout << std::fixed << std::setprecision(1) << maxPoints * (float)(nofTests-result)/(float)nofTests << std::endl;
+  std::cout << std::fixed << std::setprecision(1) << maxPoints * (float)(nofGraded-result)/(float)nofGraded << std::endl;
 
   //if(test>=0 && test < (int)nofTests){
   //  if(upTo){
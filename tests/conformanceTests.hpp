@@ -1,6 +1,11 @@
 #pragma once
 
+#include <cstdint>
 #include <iostream>
 
-void runConformanceTests(std::string const&groundTruthFile,std::string const&modelFile,int test=-1,bool upTo = false);
+#include <framework/offscreenRenderer.hpp>
+
+void runConformanceTests(std::string const&groundTruthFile,std::string const&modelFile,int test=-1,bool upTo = false,uint32_t jobs = 0);
+
+OffscreenModel&cachedModel(std::string const&file);
 
@@ -2,6 +2,7 @@
 
 #include <iostream>
 #include <string.h>
+#include <filesystem>
 
 #include <algorithm>
 #include <numeric>
@@ -9,7 +10,9 @@
 #include <student/gpu.hpp>
 #include <tests/testCommon.hpp>
 #include <tests/renderMethodFrame.hpp>
+#include <tests/conformanceTests.hpp>
 #include <framework/textureData.hpp>
+#include <framework/imageDiff.hpp>
 
 std::string extern groundTruthFile;
 std::string extern modelFile;
@@ -18,7 +21,7 @@ SCENARIO("38"){
   std::cerr << "38 - image to image comparison" << std::endl;
   uint32_t width = 500;
   uint32_t height = 500;
-  auto frame = renderMethodFrame(width,height,modelFile);
+  auto frame = renderMethodFrame(width,height,cachedModel(modelFile));
 
   auto ref = loadTexture(groundTruthFile);
 
@@ -33,19 +36,15 @@ SCENARIO("38"){
     REQUIRE(false);
   }
 
-  float meanSquareError = 0;
-  for (uint32_t y = 0; y < height; ++y)
-    for (uint32_t x = 0; x < width; ++x){
-      for (uint32_t c = 0; c < 3; ++c) {
-        uint8_t ucol = frame[(y*width+x)*4+c];
-        uint8_t gcol = ref.data.at((y*ref.width+x)*ref.channels+c);
-        float diff = glm::abs((float)ucol - (float)gcol);
-        diff *= diff;
-        meanSquareError += diff;
-      }
-    }
-
-  meanSquareError /= (float)(width * height * 3);
+  Texture frameTexture;
+  frameTexture.data     = frame.data();
+  frameTexture.width    = width;
+  frameTexture.height   = height;
+  frameTexture.channels = 4;
+  ImageDiffOptions const diffOptions;
+  ImageDiff const diff = compareImages(frameTexture,ref.getTexture(),diffOptions);
+  float meanSquareError = (float)diff.mse;
+
   float tol = 40.f;
 
   if(meanSquareError >= tol){
@@ -53,7 +52,14 @@ SCENARIO("38"){
     Finální obrázek se moc liší od reference!
     MSE je: )."<<meanSquareError<<R".(
     Akceptovatelná chyba je: )."<<tol<<R".(
+    PSNR je: )."<<diff.psnr<<R".( dB, SSIM je: )."<<diff.ssim<<R".(
+    Počet odlišných pixelů: )."<<diff.differentPixels<<R".(
+    Nejvíce se liší dlaždice )."<<diff.worstTile%diff.tilesX<<","<<diff.worstTile/diff.tilesX
+    <<" ("<<diff.tileSize<<"x"<<diff.tileSize<<R".( pixelů, počítáno zdola) s MSE )."<<diff.tileMse[diff.worstTile]<<R".(
     ).";
+    auto const heatmap = (std::filesystem::temp_directory_path()/"izgFinalImageDiff.png").string();
+    if(writeDiffHeatmap(heatmap,frameTexture,ref.getTexture(),diff,diffOptions))
+      std::cerr << "Mapa rozdílů je uložena v: " << heatmap << std::endl;
     REQUIRE(false);
   }
 }
@@ -0,0 +1,540 @@
+#include <tests/catch.hpp>
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+#include <framework/imageDiff.hpp>
+#include <framework/imageWriter.hpp>
+#include <framework/model.hpp>
+#include <framework/sceneCache.hpp>
+#include <framework/surface.hpp>
+#include <framework/textureData.hpp>
+#include <framework/textureStreamer.hpp>
+#include <student/gpu.hpp>
+#include <student/textureCompression.hpp>
+#include <tests/testCommon.hpp>
+#include <libs/stb_image/stb_image.h>
+#include <libs/stb_image/stb_image_write.h>
+
+using namespace tests;
+
+namespace mlt{
+
+/**
+ * @brief This function writes .glb file with one textured triangle.
+ *
+ * @param fileName file name
+ * @param imageAfterGeometry embedded image is stored after geometry in binary chunk, otherwise before it
+ */
+void writeTriangleGlb(std::string const&fileName,bool imageAfterGeometry = false){
+  uint8_t const pixels[] = {255,0,0,255, 0,255,0,255, 0,0,255,255, 255,255,255,255};
+  std::vector<uint8_t>bin;
+  size_t pngOffset = 0,pngLength = 0;
+  auto writePng = [&]{
+    pngOffset = bin.size();
+    stbi_write_png_to_func([](void*context,void*data,int size){
+      auto&bin = *(std::vector<uint8_t>*)context;
+      bin.insert(bin.end(),(uint8_t*)data,(uint8_t*)data+size);
+    },&bin,2,2,4,pixels,0);
+    pngLength = bin.size()-pngOffset;
+    bin.resize((bin.size()+3)&~size_t(3));
+  };
+  if(!imageAfterGeometry)writePng();
+  size_t const indicesOffset = bin.size();
+  uint16_t const indices[] = {0,1,2,0};
+  bin.insert(bin.end(),(uint8_t const*)indices,(uint8_t const*)indices+sizeof(indices));
+  size_t const positionsOffset = bin.size();
+  float const positions[] = {-1.f,-1.f,0.f, 1.f,-1.f,0.f, 0.f,1.f,0.f};
+  bin.insert(bin.end(),(uint8_t const*)positions,(uint8_t const*)positions+sizeof(positions));
+  if(imageAfterGeometry)writePng();
+
+  std::string json = std::string()+
+    R".({"asset":{"version":"2.0"},"scenes":[{"nodes":[0]}],"nodes":[{"mesh":0}],)."+
+    R".("meshes":[{"primitives":[{"attributes":{"POSITION":1},"indices":0,"material":0}]}],)."+
+    R".("materials":[{"pbrMetallicRoughness":{"baseColorTexture":{"index":0}}}],)."+
+    R".("textures":[{"source":0}],"images":[{"bufferView":0,"mimeType":"image/png"}],)."+
+    R".("buffers":[{"byteLength":)."+std::to_string(bin.size())+R".(}],)."+
+    R".("bufferViews":[{"buffer":0,"byteOffset":)."+std::to_string(pngOffset)+R".(,"byteLength":)."+std::to_string(pngLength)+R".(},)."+
+    R".({"buffer":0,"byteOffset":)."+std::to_string(indicesOffset  )+R".(,"byteLength":6},)."+
+    R".({"buffer":0,"byteOffset":)."+std::to_string(positionsOffset)+R".(,"byteLength":36}],)."+
+    R".("accessors":[{"bufferView":1,"componentType":5123,"count":3,"type":"SCALAR"},)."+
+    R".({"bufferView":2,"componentType":5126,"count":3,"type":"VEC3","min":[-1,-1,0],"max":[1,1,0]}]}).";
+  json.resize((json.size()+3)&~size_t(3),' ');
+
+  std::ofstream file(fileName,std::ios::binary);
+  uint32_t const header[] = {0x46546C67u,2u,(uint32_t)(28+json.size()+bin.size()),(uint32_t)json.size(),0x4E4F534Au};
+  uint32_t const binHeader[] = {(uint32_t)bin.size(),0x004E4942u};
+  file.write((char const*)header,sizeof(header));
+  file.write(json.data(),json.size());
+  file.write((char const*)binHeader,sizeof(binHeader));
+  file.write((char const*)bin.data(),bin.size());
+}
+
+/**
+ * @brief This function compares two models loaded from file written by writeTriangleGlb.
+ *
+ * @return true if meshes and textures contain the same data
+ */
+bool sameTriangleModels(Model const&a,Model const&b){
+  bool same = a.meshes.size() == 1 && b.meshes.size() == 1 && a.textures.size() == 1 && b.textures.size() == 1;
+  same &= a.roots.size() == 1 && b.roots.size() == 1;
+  if(!same)return false;
+  same &= a.roots[0].mesh == b.roots[0].mesh && a.roots[0].modelMatrix == b.roots[0].modelMatrix;
+  Mesh const&ma = a.meshes[0],&mb = b.meshes[0];
+  same &= ma.nofIndices == mb.nofIndices && ma.indexType == mb.indexType && ma.position.type == mb.position.type;
+  same &= ma.diffuseTexture == mb.diffuseTexture && ma.aabbMin == mb.aabbMin && ma.aabbMax == mb.aabbMax;
+  same &= memcmp((uint8_t const*)ma.indices,(uint8_t const*)mb.indices,ma.nofIndices*sizeof(uint16_t)) == 0;
+  for(uint32_t v=0;v<3;++v)
+    same &= equalVec3(*(glm::vec3 const*)((uint8_t const*)ma.position.bufferData+ma.position.offset+ma.position.stride*v),
+                      *(glm::vec3 const*)((uint8_t const*)mb.position.bufferData+mb.position.offset+mb.position.stride*v));
+  Texture const&ta = a.textures[0],&tb = b.textures[0];
+  same &= ta.data && tb.data && ta.width == tb.width && ta.height == tb.height && ta.channels == tb.channels;
+  return same && memcmp(ta.data,tb.data,ta.width*ta.height*ta.channels) == 0;
+}
+
+
+/**
+ * @brief This function reads whole file.
+ *
+ * @param fileName file name
+ *
+ * @return content of file
+ */
+std::vector<uint8_t>readFile(std::string const&fileName){
+  std::ifstream file(fileName,std::ios::binary);
+  return std::vector<uint8_t>(std::istreambuf_iterator<char>(file),std::istreambuf_iterator<char>());
+}
+
+/**
+ * @brief This function decodes QOI image into RGBA8 pixels.
+ *
+ * @param data content of .qoi file
+ * @param nofPixels expected number of pixels
+ *
+ * @return pixels, rows from top to bottom
+ */
+std::vector<uint8_t>decodeQoi(std::vector<uint8_t>const&data,size_t nofPixels){
+  std::vector<uint8_t>res;
+  uint8_t index[64][4] = {};
+  uint8_t px[4] = {0,0,0,255};
+  size_t p = 14;
+  while(res.size() < nofPixels*4 && p+8 < data.size()){
+    uint8_t const b = data[p++];
+    uint32_t run = 1;
+    if     (b == 0xfe){px[0] = data[p];px[1] = data[p+1];px[2] = data[p+2];p += 3;}
+    else if(b == 0xff){memcpy(px,&data[p],4);p += 4;}
+    else if((b>>6) == 0)memcpy(px,index[b],4);
+    else if((b>>6) == 1){px[0] += (b>>4&3)-2;px[1] += (b>>2&3)-2;px[2] += (b&3)-2;}
+    else if((b>>6) == 2){
+      int const dg = (b&63)-32,b2 = data[p++];
+      px[0] += dg+(b2>>4)-8;px[1] += dg;px[2] += dg+(b2&15)-8;
+    }
+    else run = (b&63)+1;
+    memcpy(index[(px[0]*3+px[1]*5+px[2]*7+px[3]*11)%64],px,4);
+    for(uint32_t r=0;r<run;++r)res.insert(res.end(),px,px+4);
+  }
+  return res;
+}
+
+}
+
+using namespace mlt;
+
+SCENARIO("46"){
+  std::cerr << "46 - model loading - memory mapped glb" << std::endl;
+
+  std::string const fileName = (std::filesystem::temp_directory_path()/"izgMappedTriangle.glb").string();
+  bool same = true;
+  // only images are copied out of binary chunk, wherever they are stored
+  for(bool imageAfterGeometry:{false,true}){
+    writeTriangleGlb(fileName,imageAfterGeometry);
+    ModelData copied,mapped;
+    ModelLoadOptions options;
+    copied.load(fileName,options);
+    options.mapFile = true;
+    mapped.load(fileName,options);
+    Model a = copied.getModel();
+    Model b = mapped.getModel();
+    std::remove(fileName.c_str());
+    same &= sameTriangleModels(a,b);
+  }
+
+  if(!same){
+    std::cerr << R".(
+    Model načtený přes mapování souboru do paměti se musí shodovat s modelem načteným kopírováním.
+    Soubor obsahuje jeden trojúhelník s 16 bitovými indexy a vloženou texturou 2x2
+    uloženou v binárních datech před geometrií i za ní.)." << std::endl;
+    REQUIRE(false);
+  }
+}
+
+SCENARIO("47"){
+  std::cerr << "47 - model loading - binary scene cache" << std::endl;
+
+  std::string const fileName  = (std::filesystem::temp_directory_path()/"izgCachedTriangle.glb").string();
+  std::string const cacheFile = sceneCacheFile(fileName);
+  std::remove(cacheFile.c_str());
+  writeTriangleGlb(fileName);
+
+  ModelLoadOptions options;
+  ModelData reference;
+  reference.load(fileName,options);
+  Model expected = reference.getModel();
+
+  options.sceneCache = true;
+  ModelData missed,hit,corrupted;
+  missed.load(fileName,options); // cache is written when model is built
+  bool ok = sameTriangleModels(expected,missed.getModel());
+  ok &= std::filesystem::exists(cacheFile);
+
+  hit.load(fileName,options);
+  ok &= sameTriangleModels(expected,hit.getModel());
+
+  // damaged cache has to be detected by checksum and rebuilt
+  {
+    std::fstream file(cacheFile,std::ios::binary|std::ios::in|std::ios::out);
+    file.seekp(-1,std::ios::end);
+    file.put('\x5a');
+  }
+  corrupted.load(fileName,options);
+  ok &= sameTriangleModels(expected,corrupted.getModel());
+
+  std::remove(fileName.c_str());
+  std::remove(cacheFile.c_str());
+
+  if(!ok){
+    std::cerr << R".(
+    Model načtený z cache .izgscene se musí shodovat s modelem načteným z glb.
+    Cache se má vytvořit při prvním načtení a poškozená cache se nesmí použít.)." << std::endl;
+    REQUIRE(false);
+  }
+}
+
+SCENARIO("48"){
+  std::cerr << "48 - model loading - texture streaming under budget" << std::endl;
+
+  std::atomic<uint32_t>decodes{0};
+  auto decoder = [&](std::vector<uint8_t>&pixels,uint32_t&width,uint32_t&height,uint32_t&channels){
+    decodes++;
+    width = height = 256;
+    channels = 4;
+    pixels.assign(256*256*4,77);
+    return true;
+  };
+  // decoding of full resolution reserves space for temporary copy of the image
+  size_t const fullLevel = 256*256*4;
+  size_t const budget    = 2*fullLevel+fullLevel/4;
+  TextureStreamer streamer(budget,0,1);
+  streamer.addTexture(decoder);
+  streamer.addTexture(decoder);
+  streamer.finishLoading();
+
+  std::vector<Texture>textures;
+  bool ok = streamer.nofLevels(0) == 3 && streamer.getTexture(0).level == 2 && streamer.getTexture(0).width == 64;
+
+  // the first texture at full resolution
+  std::vector<uint32_t>levels = {0,UINT32_MAX};
+  streamer.update(textures,levels);
+  ok &= textures.size() == 2 && textures[0].level == 2;
+  streamer.wait();
+  streamer.update(textures,levels);
+  ok &= textures[0].level == 0 && textures[0].width == 256 && textures[0].data && textures[0].data[fullLevel-1] == 77;
+
+  // the second one does not fit next to it, the first one has to be evicted
+  levels = {UINT32_MAX,0};
+  streamer.update(textures,levels);
+  streamer.wait();
+  streamer.update(textures,levels);
+  ok &= textures[1].level == 0 && textures[0].level == 2;
+
+  // coarser levels are created from stored blocks without decoding the image, one load at a time
+  levels = {1,1};
+  streamer.update(textures,levels);
+  streamer.wait();
+  streamer.update(textures,levels);
+  ok &= (textures[0].level == 1) != (textures[1].level == 1);
+  streamer.wait();
+  streamer.update(textures,levels);
+  ok &= textures[0].level == 1 && textures[1].level == 1 && textures[0].width == 128;
+  ok &= textures[0].data && std::abs(textures[0].data[128*128*4-1]-77) <= 4;
+
+  auto const stats = streamer.getStats();
+  ok &= decodes == 4 && stats.storedBytes == 2*128*128 && stats.evictions == 1 && stats.loads == 4 && stats.peakBytes <= budget;
+
+  if(!ok){
+    std::cerr << R".(
+    Streamer textur drží trvale jen nejmenší úroveň (nejvýše 64x64) a ostatní úrovně načítá na vyžádání.
+    Mezilehlé úrovně se vytvoří jednou při načtení a uloží se komprimované (BC1/BC3),
+    obrázek se znovu dekóduje jen pro plné rozlišení.
+    Dokud požadovaná úroveň není načtená, použije se hrubší úroveň.
+    Pokud se nová úroveň nevejde do rozpočtu, uvolní se nejdéle nepoužitá úroveň.)." << std::endl;
+    REQUIRE(false);
+  }
+}
+
+SCENARIO("49"){
+  std::cerr << "49 - model loading - BC1/BC3 compressed textures" << std::endl;
+
+  // blocks with two colors that are exact in 565 and alpha 0/255 are lossless
+  uint32_t const size = 8;
+  std::vector<uint8_t>checker(size*size*4);
+  for(uint32_t y=0;y<size;++y)
+    for(uint32_t x=0;x<size;++x){
+      bool const odd = (x+y)&1;
+      uint8_t const texel[] = {uint8_t(odd?255:0),0,uint8_t(odd?0:255),uint8_t(odd?255:0)};
+      memcpy(checker.data()+(y*size+x)*4,texel,4);
+    }
+  auto blocks = compressTexture(checker.data(),size,size,4,TextureFormat::BC3);
+  Texture tex;
+  tex.data     = blocks.data();
+  tex.width    = size;
+  tex.height   = size;
+  tex.channels = 4;
+  tex.format   = TextureFormat::BC3;
+  bool ok = blocks.size() == 4*16 && textureDataSize(tex) == blocks.size();
+  for(uint32_t y=0;y<size;++y)
+    for(uint32_t x=0;x<size;++x){
+      glm::vec4 const c = read_texture(tex,glm::vec2(x+.5f,y+.5f)/(float)size);
+      uint8_t const*e = checker.data()+(y*size+x)*4;
+      ok &= equalVec4(c,glm::vec4(e[0],e[1],e[2],e[3])/255.f);
+    }
+
+  // smooth gradient stays close to the source
+  std::vector<uint8_t>gradient(size*size*3);
+  for(uint32_t i=0;i<size*size;++i){
+    gradient[i*3+0] = (uint8_t)(i%size*32);
+    gradient[i*3+1] = (uint8_t)(i%size*16);
+    gradient[i*3+2] = 100;
+  }
+  blocks = compressTexture(gradient.data(),size,size,3,TextureFormat::BC1);
+  tex.data     = blocks.data();
+  tex.channels = 3;
+  tex.format   = TextureFormat::BC1;
+  ok &= blocks.size() == 4*8;
+  float maxError = 0.f;
+  for(uint32_t y=0;y<size;++y)
+    for(uint32_t x=0;x<size;++x){
+      glm::vec4 const c = read_texture(tex,glm::vec2(x+.5f,y+.5f)/(float)size);
+      uint8_t const*e = gradient.data()+(y*size+x)*3;
+      for(int k=0;k<3;++k)
+        maxError = glm::max(maxError,glm::abs(c[k]-e[k]/255.f));
+      ok &= c.a == 1.f;
+    }
+  ok &= maxError < 8.f/255.f;
+
+  // model loader stores RGBA image as BC3
+  std::string const fileName = (std::filesystem::temp_directory_path()/"izgCompressedTriangle.glb").string();
+  writeTriangleGlb(fileName);
+  ModelData modelData;
+  ModelLoadOptions options;
+  options.compressTextures = true;
+  modelData.load(fileName,options);
+  Model const model = modelData.getModel();
+  std::remove(fileName.c_str());
+  ok &= model.textures.size() == 1 && model.textures[0].format == TextureFormat::BC3 && model.textures[0].data;
+
+  if(!ok){
+    std::cerr << R".(
+    Komprimované textury jsou uložené po blocích 4x4 pixelů (BC1 8 bajtů, BC3 16 bajtů).
+    Funkce read_texture musí blok dekódovat a vrátit barvu texelu.
+    Blok se dvěma barvami přesně vyjádřitelnými v 565 a alfou 0/255 se musí dekódovat bezeztrátově,
+    plynulý gradient se smí lišit nejvýše o 8/255.
+    Model načtený s compressTextures má mít RGBA texturu ve formátu BC3.)." << std::endl;
+    REQUIRE(false);
+  }
+}
+
+SCENARIO("50"){
+  std::cerr << "50 - texture loading - row flip and RGBA expansion" << std::endl;
+
+  uint32_t const width = 3,height = 2;
+  uint8_t const pixels[] = {
+    10,11,12, 20,21,22, 30,31,32,
+    40,41,42, 50,51,52, 60,61,62,
+  };
+  std::string const fileName = (std::filesystem::temp_directory_path()/"izgTexture.png").string();
+  stbi_write_png(fileName.c_str(),width,height,3,pixels,0);
+
+  TextureLoadOptions options;
+  auto const rgb = loadTexture(fileName,options);
+  options.expandToRGBA = true;
+  auto const rgba = loadTexture(fileName,options);
+  std::remove(fileName.c_str());
+
+  bool ok = rgb .width == width && rgb .height == height && rgb .channels == 3 && rgb .data.size() == width*height*3;
+  ok     &= rgba.width == width && rgba.height == height && rgba.channels == 4 && rgba.data.size() == width*height*4;
+  for(uint32_t y=0;ok && y<height;++y)
+    for(uint32_t x=0;x<width;++x)
+      for(uint32_t c=0;c<4;++c){
+        uint8_t const expected = c < 3 ? pixels[((height-y-1)*width+x)*3+c] : 255;
+        if(c < 3)ok &= rgb.data[(y*width+x)*3+c] == expected;
+        ok &= rgba.data[(y*width+x)*4+c] == expected;
+      }
+
+  if(!ok){
+    std::cerr << R".(
+    Funkce loadTexture ukládá řádky obrázku odspodu nahoru.
+    S volbou expandToRGBA má mít textura 4 kanály, chybějící alfa je 255.)." << std::endl;
+    REQUIRE(false);
+  }
+}
+
+SCENARIO("51"){
+  std::cerr << "51 - image writer - formats and row flipping" << std::endl;
+
+  uint32_t const width = 17,height = 5;
+  std::vector<uint8_t>frame(width*height*4);
+  for(size_t i=0;i<frame.size();++i)frame[i] = (uint8_t)(i%7 == 0 ? 200 : i*13);
+
+  auto const dir = std::filesystem::temp_directory_path();
+  std::string const files[] = {
+    (dir/"izgImage.png").string(),(dir/"izgImageStored.png").string(),
+    (dir/"izgImage.ppm").string(),(dir/"izgImage.qoi").string(),(dir/"izgImage.raw").string(),
+  };
+  ImageWriterOptions options;
+  options.opaque = false;
+  {
+    ImageWriter writer(options);
+    for(auto const&f:files){
+      options.pngLevel = f == files[1] ? 0 : 8;
+      std::vector<uint8_t>copy = frame;
+      if(f == files[1])writeImage(f,copy.data(),width,height,true,options);
+      else writer.write(f,std::move(copy),width,height);
+    }
+  }
+
+  // expected pixel of image row y (top to bottom)
+  auto const expected = [&](uint32_t x,uint32_t y,uint32_t c){return frame[((height-1-y)*width+x)*4+c];};
+  bool ok = true;
+  for(int i=0;i<2;++i){
+    int w = 0,h = 0,n = 0;
+    uint8_t*png = stbi_load(files[i].c_str(),&w,&h,&n,4);
+    ok &= png && w == (int)width && h == (int)height;
+    for(uint32_t y=0;ok && y<height;++y)
+      for(uint32_t x=0;x<width;++x)
+        for(uint32_t c=0;c<4;++c)ok &= png[(y*width+x)*4+c] == expected(x,y,c);
+    if(png)stbi_image_free(png);
+  }
+  auto const ppm = readFile(files[2]);
+  std::string const ppmHeader = "P6\n"+std::to_string(width)+" "+std::to_string(height)+"\n255\n";
+  ok &= ppm.size() == ppmHeader.size()+width*height*3 && memcmp(ppm.data(),ppmHeader.data(),ppmHeader.size()) == 0;
+  auto const qoi = decodeQoi(readFile(files[3]),width*height);
+  auto const raw = readFile(files[4]);
+  ok &= qoi.size() == width*height*4 && raw.size() == width*height*4;
+  for(uint32_t y=0;ok && y<height;++y)
+    for(uint32_t x=0;x<width;++x)
+      for(uint32_t c=0;c<4;++c){
+        if(c < 3)ok &= ppm[ppmHeader.size()+(y*width+x)*3+c] == expected(x,y,c);
+        ok &= qoi[(y*width+x)*4+c] == expected(x,y,c);
+        ok &= raw[(y*width+x)*4+c] == expected(x,y,c);
+      }
+  for(auto const&f:files)std::remove(f.c_str());
+
+  if(!ok){
+    std::cerr << R".(
+    ImageWriter má zapsat snímek (řádky odspodu nahoru) do PNG, nekomprimovaného PNG, PPM, QOI a RAW
+    s řádky shora dolů a beze změny pixelů.)." << std::endl;
+    REQUIRE(false);
+  }
+}
+
+SCENARIO("52"){
+  std::cerr << "52 - image comparison - MSE, tiles and SSIM" << std::endl;
+
+  uint32_t const width = 600,height = 500;
+  std::vector<uint8_t>a(width*height*4),b(width*height*3);
+  uint32_t seed = 12345;
+  for(auto&v:a){seed = seed*1103515245u+12345u;v = (uint8_t)(seed>>16);}
+  for(uint32_t i=0;i<width*height;++i)
+    for(uint32_t c=0;c<3;++c)b[i*3+c] = a[i*4+c];
+
+  Texture ta,tb;
+  ta.data = a.data();ta.width = width;ta.height = height;ta.channels = 4;
+  tb.data = b.data();tb.width = width;tb.height = height;tb.channels = 3;
+
+  bool ok = true;
+  ImageDiff same = compareImages(ta,tb);
+  ok &= same.mse == 0. && std::isinf(same.psnr) && same.ssim > .9999 && same.differentPixels == 0;
+
+  // one pixel differs in tile 5,3
+  b[(100*width+170)*3+1] += 20;
+  ImageDiff const one = compareImages(ta,tb);
+  ok &= one.differentPixels == 1 && one.worstTile == 3*one.tilesX+5 && one.tilesX == 19 && one.tilesY == 16;
+  ok &= std::abs(one.mse-400./(width*height*3.)) < 1e-9 && std::abs(one.tileMse[one.worstTile]-400.f/(32*32*3)) < 1e-4f;
+
+  // random images, vectorized and parallel comparison has to match scalar one
+  Texture tc = ta;
+  std::vector<uint8_t>c(a.size());
+  for(auto&v:c){seed = seed*1103515245u+12345u;v = (uint8_t)(seed>>16);}
+  tc.data = c.data();
+  double reference = 0.;
+  for(uint32_t i=0;i<width*height;++i)
+    for(uint32_t k=0;k<3;++k)reference += (double)((int)a[i*4+k]-(int)c[i*4+k])*((int)a[i*4+k]-(int)c[i*4+k]);
+  reference /= width*height*3.;
+  for(uint32_t threads:{1u,3u}){
+    ImageDiffOptions options;
+    options.threads = threads;
+    ImageDiff const noise = compareImages(ta,tc,options);
+    ok &= std::abs(noise.mse-reference) < 1e-6 && noise.ssim < .1 && noise.ssim > -.1;
+    if(threads == 1)same = noise;
+    else ok &= std::abs(same.ssim-noise.ssim) < 1e-9 && same.tileMse == noise.tileMse;
+  }
+
+  if(!ok){
+    std::cerr << R".(
+    compareImages má spočítat MSE (bez alfa kanálu), PSNR a SSIM, najít dlaždici s největší chybou
+    a paralelní i vektorizovaný výpočet má dát stejný výsledek jako skalární.)." << std::endl;
+    REQUIRE(false);
+  }
+}
+
+SCENARIO("53"){
+  std::cerr << "53 - surface - copy of frame into SDL surface formats" << std::endl;
+
+  uint32_t const formats[] = {
+    SDL_PIXELFORMAT_RGB888  ,SDL_PIXELFORMAT_BGR888  ,SDL_PIXELFORMAT_ARGB8888,
+    SDL_PIXELFORMAT_RGBA8888,SDL_PIXELFORMAT_RGB24   ,SDL_PIXELFORMAT_BGR24   ,
+  };
+  // odd widths leave pixels for scalar tail, the last size is large enough to be split between threads
+  uint32_t const sizes[][2] = {{1,2},{3,3},{5,2},{17,4},{700,375}};
+  ThreadPool pool1(1),pool4(4);
+  ThreadPool*const pools[] = {nullptr,&pool1,&pool4};
+
+  bool ok = true;
+  for(auto const format:formats)
+    for(auto const&size:sizes){
+      uint32_t const width = size[0],height = size[1];
+      std::vector<uint8_t>frame(width*height*4);
+      for(size_t i=0;i<frame.size();++i)frame[i] = (uint8_t)(i*7+i/5);
+      SDL_Surface*const surface = SDL_CreateRGBSurfaceWithFormat(0,width,height,SDL_BITSPERPIXEL(format),format);
+      REQUIRE(surface != nullptr);
+      for(auto const pool:pools){
+        memset(surface->pixels,0,(size_t)surface->pitch*height);
+        copyToSDLSurface(surface,frame.data(),width,height,pool);
+        uint32_t const bytesPerPixel = surface->format->BytesPerPixel;
+        for(uint32_t y=0;ok && y<height;++y)
+          for(uint32_t x=0;ok && x<width;++x){
+            Uint32 pixel = 0;
+            memcpy(&pixel,(uint8_t const*)surface->pixels+(height-1-y)*surface->pitch+x*bytesPerPixel,bytesPerPixel);
+            Uint8 rgb[3];
+            SDL_GetRGB(pixel,surface->format,rgb+0,rgb+1,rgb+2);
+            ok &= memcmp(rgb,frame.data()+(y*width+x)*4,3) == 0;
+            if(!ok)std::cerr << "    " << SDL_GetPixelFormatName(format) << " " << width << "x" << height
+                             << " threads: " << (pool ? pool->size() : 0) << " pixel: " << x << " " << y << std::endl;
+          }
+      }
+      SDL_FreeSurface(surface);
+    }
+
+  if(!ok){
+    std::cerr << R".(
+    copyToSDLSurface má převrátit řádky snímku a uložit barvu každého pixelu ve formátu surface
+    (32 i 24 bitové formáty, libovolná šířka, s vlákny i bez nich).)." << std::endl;
+    REQUIRE(false);
+  }
+}
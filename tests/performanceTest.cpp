@@ -8,16 +8,19 @@
 #include <BasicCamera/OrbitCamera.h>
 #include <BasicCamera/PerspectiveCamera.h>
 #include <examples/modelMethod.hpp>
+#include <framework/frameTimes.hpp>
 #include <framework/timer.hpp>
 #include <framework/framebuffer.hpp>
+#include <framework/perfCounters.hpp>
+#include <framework/trace.hpp>
 #include <tests/performanceTest.hpp>
 
 #define ___ std::cerr << __FILE__ << "/" << __LINE__ << std::endl
 
-void runPerformanceTest(std::string const&modelFile,size_t framesPerMeasurement) {
+void runPerformanceTest(std::string const&modelFile,size_t framesPerMeasurement,DrawSettings const&drawSettings,ModelLoadOptions const&loadOptions,bool perfCounters) {
   uint32_t width = 500;
   uint32_t height = 500;
-  auto cd = std::make_shared<modelMethod::ConstructionData>(modelFile);
+  auto cd = std::make_shared<modelMethod::ConstructionData>(modelFile,drawSettings,loadOptions);
   auto method = std::make_shared<modelMethod::Method>(&*cd);
 
   auto framebuffer = std::make_shared<Framebuffer>(width,height);
@@ -38,14 +41,46 @@ void runPerformanceTest(std::string const&modelFile,size_t framesPerMeasurement)
   auto const camera = glm::vec3(glm::inverse(view)*glm::vec4(0.f,0.f,0.f,1.f));
 
 
+  std::unique_ptr<PerfCounters>counters;
+  if(perfCounters)counters = std::make_unique<PerfCounters>();
+  gpuCounters = GPUCounters{};
+
   Timer<float>timer;
+  Timer<float>frameTimer;
+  FrameTimes  frameTimes;
   timer.reset();
+  if(counters)counters->start();
   for (size_t i   = 0; i < framesPerMeasurement; ++i){
+    frameTimer.reset();
+    traceNextFrame();
+    IZG_TRACE_ZONE("frame");
     method->onDraw(frame,proj,view,light,camera);
+    frameTimes.add(frameTimer.elapsedFromStart());
   }
   auto const time = timer.elapsedFromStart() / static_cast<float>(framesPerMeasurement);
+  PerfCounterValues const events = counters ? counters->stop() : PerfCounterValues{};
 
   std::cout << "Seconds per frame: " << std::scientific << std::setprecision(10)
             << time << std::endl;
+  frameTimes.report(std::cout,"Frame time");
+
+  if(counters){
+    if(!counters->available())
+      std::cout << "Hardware counters are not available: " << counters->getError() << std::endl;
+    else{
+      if(!counters->getError().empty())
+        std::cout << "Some hardware counters are not available: " << counters->getError() << std::endl;
+      std::cout << "Triangles per frame: " << gpuCounters.triangles/framesPerMeasurement
+                << ", fragments per frame: " << gpuCounters.fragments/framesPerMeasurement << std::endl;
+      reportPerfCounters(std::cout,events,(double)framesPerMeasurement,gpuCounters.triangles,gpuCounters.fragments);
+    }
+  }
+
+  auto const&stats = method->scene.stats;
+  if(drawSettings.lodSelection || drawSettings.meshletCulling)
+    std::cout << "Submitted triangles: " << stats.submittedTriangles
+              << " (saved by levels of detail: " << stats.lodTrianglesSaved << ")" << std::endl;
+  if(drawSettings.meshletCulling)
+    std::cout << "Meshlets drawn: " << stats.drawnMeshlets << " culled: " << stats.culledMeshlets << std::endl;
 
 }
@@ -2,5 +2,8 @@
 
 #include <iostream>
 
-void runPerformanceTest(std::string const&modelFile,size_t framesPerMeasurement = 100);
+#include <framework/model.hpp>
+#include <student/drawModel.hpp>
+
+void runPerformanceTest(std::string const&modelFile,size_t framesPerMeasurement = 100,DrawSettings const&drawSettings = DrawSettings{},ModelLoadOptions const&loadOptions = ModelLoadOptions{},bool perfCounters = false);
 
@@ -4,4 +4,9 @@
 #include <cstdint>
 #include <string>
 
-std::vector<uint8_t>renderMethodFrame(uint32_t width,uint32_t height,std::string const&modelFile);
+#include <framework/model.hpp>
+#include <framework/offscreenRenderer.hpp>
+#include <student/drawModel.hpp>
+
+std::vector<uint8_t>renderMethodFrame(uint32_t width,uint32_t height,std::string const&modelFile,DrawSettings const&drawSettings = DrawSettings{},ModelLoadOptions const&loadOptions = ModelLoadOptions{});
+std::vector<uint8_t>renderMethodFrame(uint32_t width,uint32_t height,OffscreenModel&model);
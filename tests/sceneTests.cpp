@@ -0,0 +1,571 @@
+#include <tests/catch.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <random>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <student/gpu.hpp>
+#include <student/scene.hpp>
+#include <student/drawModel.hpp>
+#include <student/meshOptimizer.hpp>
+#include <student/meshlet.hpp>
+#include <student/simplify.hpp>
+#include <tests/testCommon.hpp>
+
+using namespace tests;
+
+void drawTrianglesImpl(GPUContext&,uint32_t);
+
+namespace sct{
+
+std::vector<glm::mat4>drawnMatrices;
+std::vector<uint32_t >drawnIndices;
+
+void drawTrianglesInject(GPUContext&ctx,uint32_t nofVertices){
+  drawnMatrices.push_back(ctx.prg.uniforms.uniform[1].m4);
+  drawnIndices.push_back(nofVertices);
+}
+
+struct ReplaceDrawTriangle{
+  ReplaceDrawTriangle(){
+    drawTriangles = drawTrianglesInject;
+  }
+  ~ReplaceDrawTriangle(){
+    drawTriangles = drawTrianglesImpl;
+  }
+};
+
+}
+
+using namespace sct;
+
+SCENARIO("39"){
+  std::cerr << "39 - scene - flattened node tree and matrix updates" << std::endl;
+
+  Model model;
+
+  std::vector<glm::mat4>m;
+  m.push_back(glm::translate(glm::mat4(1),glm::vec3(1,2,3)));
+  m.push_back(glm::rotate(glm::mat4(1),glm::radians(30.f),glm::vec3(0,1,0)));
+  m.push_back(glm::scale(glm::mat4(1),glm::vec3(2,3,4)));
+  m.push_back(glm::translate(glm::mat4(1),glm::vec3(-5,0,7)));
+
+  model.meshes.resize(3);
+  model.roots.resize(2);
+  model.roots[0].mesh = 0;
+  model.roots[0].modelMatrix = m[0];
+  model.roots[0].children.resize(1);
+  model.roots[0].children[0].mesh = -1;
+  model.roots[0].children[0].modelMatrix = m[1];
+  model.roots[0].children[0].children.resize(1);
+  model.roots[0].children[0].children[0].mesh = 1;
+  model.roots[0].children[0].children[0].modelMatrix = m[2];
+  model.roots[1].mesh = 2;
+  model.roots[1].modelMatrix = m[3];
+
+  auto it = [&](glm::mat4 const&m){return glm::transpose(glm::inverse(m));};
+
+  Scene scene;
+  buildScene(scene,model);
+
+  auto printInfo = [&](){
+    std::cerr<<R".(
+    Strom uzlů modelu se převádí do pole uzlů v pre order pořadí.
+    Ale něco se pokazilo...)."<<std::endl;
+    printModel(model);
+  };
+
+  if(scene.nodes.size() != 4){
+    printInfo();
+    std::cerr << R".(
+    Scéna by měla obsahovat 4 uzly, obsahuje: )."<<scene.nodes.size()<<std::endl;
+    REQUIRE(false);
+  }
+
+  bool success = true;
+  success &= scene.nodes[0].parent == -1 && scene.nodes[0].mesh ==  0 && scene.nodes[0].subtreeEnd == 3;
+  success &= scene.nodes[1].parent ==  0 && scene.nodes[1].mesh == -1 && scene.nodes[1].subtreeEnd == 3;
+  success &= scene.nodes[2].parent ==  1 && scene.nodes[2].mesh ==  1 && scene.nodes[2].subtreeEnd == 3;
+  success &= scene.nodes[3].parent == -1 && scene.nodes[3].mesh ==  2 && scene.nodes[3].subtreeEnd == 4;
+  if(!success){
+    printInfo();
+    std::cerr << R".(
+    Uzly mají špatné rodiče, meshe nebo rozsahy podstromů.
+    ).";
+    REQUIRE(false);
+  }
+
+  success &= scene.nodes[0].worldMatrix  == m[0]          ;
+  success &= scene.nodes[1].worldMatrix  == m[0]*m[1]     ;
+  success &= scene.nodes[2].worldMatrix  == m[0]*m[1]*m[2];
+  success &= scene.nodes[3].worldMatrix  == m[3]          ;
+  success &= scene.nodes[2].normalMatrix == it(m[0]*m[1]*m[2]);
+  if(!success){
+    printInfo();
+    std::cerr << R".(
+    Světové matice uzlů jsou špatně vypočítané.
+    ).";
+    REQUIRE(false);
+  }
+
+  auto n = glm::translate(glm::mat4(1),glm::vec3(0,10,0));
+  setNodeMatrix(scene,1,n);
+  updateScene(scene,model);
+
+  success &= scene.nodes[0].worldMatrix  == m[0]          ;
+  success &= scene.nodes[1].worldMatrix  == m[0]*n        ;
+  success &= scene.nodes[2].worldMatrix  == m[0]*n*m[2]   ;
+  success &= scene.nodes[3].worldMatrix  == m[3]          ;
+  success &= scene.nodes[2].normalMatrix == it(m[0]*n*m[2]);
+  success &= !scene.dirty && !scene.nodes[1].dirty && !scene.nodes[2].dirty;
+  if(!success){
+    printInfo();
+    std::cerr << R".(
+    Po změně lokální matice uzlu 1 se měly přepočítat matice celého jeho podstromu.
+    ).";
+    REQUIRE(false);
+  }
+}
+
+SCENARIO("40"){
+  std::cerr << "40 - scene - sorted render queue" << std::endl;
+
+  auto mm = ReplaceDrawTriangle();
+  drawnMatrices.clear();
+
+  Model model;
+  model.meshes.resize(2);
+  model.meshes[0].nofIndices = 3;
+  model.meshes[1].nofIndices = 3;
+  model.meshes[1].diffuseColor = glm::vec4(1.f,1.f,1.f,.5f);
+
+  std::vector<glm::mat4>m;
+  m.push_back(glm::translate(glm::mat4(1),glm::vec3(0,0,-30)));
+  m.push_back(glm::translate(glm::mat4(1),glm::vec3(0,0,-10)));
+  m.push_back(glm::translate(glm::mat4(1),glm::vec3(0,0,-5 )));
+  m.push_back(glm::translate(glm::mat4(1),glm::vec3(0,0,-20)));
+
+  int32_t meshes[] = {0,1,1,0};
+  for(size_t i=0;i<m.size();++i){
+    model.roots.push_back({});
+    model.roots.back().mesh = meshes[i];
+    model.roots.back().modelMatrix = m[i];
+  }
+
+  Scene scene;
+  buildScene(scene,model);
+
+  DrawSettings settings;
+  settings.sortDrawCalls = true;
+  GPUContext ctx;
+  drawScene(ctx,model,scene,glm::mat4(1.f),glm::mat4(1.f),glm::vec3(1.f),glm::vec3(0.f),settings);
+
+  std::vector<glm::mat4>expected = {m[3],m[0],m[1],m[2]};
+  if(drawnMatrices != expected){
+    std::cerr << R".(
+    Neprůhledné meshe se měly vykreslit od nejbližšího k nejvzdálenějšímu
+    a průhledné meshe až po nich v pořadí scény.
+    ).";
+    printModel(model);
+    REQUIRE(false);
+  }
+}
+
+SCENARIO("41"){
+  std::cerr << "41 - scene - view frustum culling" << std::endl;
+
+  auto mm = ReplaceDrawTriangle();
+  drawnMatrices.clear();
+
+  Model model;
+  model.meshes.resize(2);
+  model.meshes[0].nofIndices = 3;
+  model.meshes[0].aabbMin = glm::vec3(-1.f);
+  model.meshes[0].aabbMax = glm::vec3(+1.f);
+  model.meshes[1].nofIndices = 3;
+
+  std::vector<glm::mat4>m;
+  m.push_back(glm::translate(glm::mat4(1),glm::vec3(   0,0,-10)));// visible
+  m.push_back(glm::translate(glm::mat4(1),glm::vec3(   0,0, 10)));// behind camera
+  m.push_back(glm::translate(glm::mat4(1),glm::vec3(-100,0,-10)));// left of frustum
+  m.push_back(glm::translate(glm::mat4(1),glm::vec3(   0,0, 10)));// behind camera, unknown bounds
+
+  int32_t meshes[] = {0,0,0,1};
+  for(size_t i=0;i<m.size();++i){
+    model.roots.push_back({});
+    model.roots.back().mesh = meshes[i];
+    model.roots.back().modelMatrix = m[i];
+  }
+  model.roots[1].children.push_back({});
+  model.roots[1].children[0].mesh = 0;
+
+  Scene scene;
+  buildScene(scene,model);
+
+  DrawSettings settings;
+  settings.frustumCulling = true;
+  GPUContext ctx;
+  auto proj = glm::perspective(glm::radians(60.f),1.f,.1f,100.f);
+  drawScene(ctx,model,scene,proj,glm::mat4(1.f),glm::vec3(1.f),glm::vec3(0.f),settings);
+
+  std::vector<glm::mat4>expected = {m[0],m[3]};
+  if(drawnMatrices != expected){
+    std::cerr << R".(
+    Měl se vykreslit pouze mesh před kamerou a mesh bez známých hranic.
+    Počet vykreslených meshů: )."<<drawnMatrices.size()<<std::endl;
+    printModel(model);
+    REQUIRE(false);
+  }
+}
+
+SCENARIO("42"){
+  std::cerr << "42 - scene - occlusion culling" << std::endl;
+
+  auto mm = ReplaceDrawTriangle();
+  drawnMatrices.clear();
+
+  // wall drawn with both windings, so it does not depend on orientation of rasterized triangles
+  std::vector<glm::vec3>wall = {
+    {-10,-10,0},{ 10,-10,0},{ 10, 10,0},
+    {-10,-10,0},{ 10, 10,0},{-10, 10,0},
+    {-10,-10,0},{ 10, 10,0},{ 10,-10,0},
+    {-10,-10,0},{-10, 10,0},{ 10, 10,0},
+  };
+
+  Model model;
+  model.meshes.resize(3);
+  model.meshes[0].nofIndices = (uint32_t)wall.size();
+  model.meshes[0].position.bufferData = wall.data();
+  model.meshes[0].position.stride = sizeof(glm::vec3);
+  model.meshes[0].position.type = AttributeType::VEC3;
+  computeMeshBounds(model.meshes[0]);
+  model.meshes[1].nofIndices = 3;
+  model.meshes[1].aabbMin = glm::vec3(-1.f);
+  model.meshes[1].aabbMax = glm::vec3(+1.f);
+  model.meshes[2].nofIndices = 3;
+
+  std::vector<glm::mat4>m;
+  m.push_back(glm::translate(glm::mat4(1),glm::vec3(0,0,-5 )));// occluder
+  m.push_back(glm::translate(glm::mat4(1),glm::vec3(0,0,-20)));// hidden
+  m.push_back(glm::translate(glm::mat4(1),glm::vec3(0,0,-3 )));// in front of occluder
+  m.push_back(glm::translate(glm::mat4(1),glm::vec3(0,0,-20)));// unknown bounds
+
+  int32_t meshes[] = {0,1,1,2};
+  for(size_t i=0;i<m.size();++i){
+    model.roots.push_back({});
+    model.roots.back().mesh = meshes[i];
+    model.roots.back().modelMatrix = m[i];
+  }
+
+  Scene scene;
+  buildScene(scene,model);
+
+  DrawSettings settings;
+  settings.occlusionCulling = true;
+  GPUContext ctx;
+  auto proj = glm::perspective(glm::radians(60.f),1.f,.1f,100.f);
+  gpuCounters = GPUCounters{};
+  drawScene(ctx,model,scene,proj,glm::mat4(1.f),glm::vec3(1.f),glm::vec3(0.f),settings);
+
+  std::vector<glm::mat4>expected = {m[0],m[2],m[3]};
+  if(drawnMatrices != expected || scene.stats.occlusionCulledMeshes != 1){
+    std::cerr << R".(
+    Mesh schovaný za stěnou se neměl vykreslit, ostatní meshe ano.
+    Počet vykreslených meshů: )."<<drawnMatrices.size()<<std::endl;
+    printModel(model);
+    REQUIRE(false);
+  }
+
+  // drawTriangles is replaced, so anything counted comes from rasterization of occluders
+  if(gpuCounters.triangles != 0 || gpuCounters.fragments != 0){
+    std::cerr << R".(
+    Rasterizace okluderů do occlusion bufferu se nemá započítat do gpuCounters,
+    počítadla mají obsahovat jen práci vykreslení snímku.
+    Trojúhelníky: )."<<gpuCounters.triangles<<", fragmenty: "<<gpuCounters.fragments<<std::endl;
+    REQUIRE(false);
+  }
+}
+
+SCENARIO("43"){
+  std::cerr << "43 - scene - level of detail generation and selection" << std::endl;
+
+  // height field, its border is locked by the simplifier
+  uint32_t const n = 21;
+  std::vector<glm::vec3>vertices;
+  std::vector<uint16_t >indices;
+  for(uint32_t y=0;y<n;++y)
+    for(uint32_t x=0;x<n;++x)
+      vertices.push_back(glm::vec3(x,y,.3f*glm::sin(x*.5f)*glm::cos(y*.5f)));
+  for(uint32_t y=0;y+1<n;++y)
+    for(uint32_t x=0;x+1<n;++x){
+      uint16_t v = (uint16_t)(y*n+x);
+      for(uint16_t i:{v,uint16_t(v+1),uint16_t(v+n+1),v,uint16_t(v+n+1),uint16_t(v+n)})
+        indices.push_back(i);
+    }
+
+  Model model;
+  model.meshes.resize(1);
+  Mesh&mesh = model.meshes[0];
+  mesh.nofIndices = (uint32_t)indices.size();
+  mesh.indices = indices.data();
+  mesh.indexType = IndexType::UINT16;
+  mesh.position.bufferData = vertices.data();
+  mesh.position.stride = sizeof(glm::vec3);
+  mesh.position.type = AttributeType::VEC3;
+  computeMeshBounds(mesh);
+
+  BufferStorage storage;
+  generateMeshLods(mesh,storage,.1f);
+
+  auto segmentDistance = [](glm::vec3 const&p,glm::vec3 const&a,glm::vec3 const&b){
+    float t = glm::clamp(glm::dot(p-a,b-a)/glm::dot(b-a,b-a),0.f,1.f);
+    return glm::length(p-a-t*(b-a));
+  };
+  auto triangleDistance = [&](glm::vec3 const&p,glm::vec3 const&a,glm::vec3 const&b,glm::vec3 const&c){
+    glm::vec3 n = glm::normalize(glm::cross(b-a,c-a));
+    glm::vec3 q = p-glm::dot(p-a,n)*n;
+    if(glm::dot(glm::cross(b-a,q-a),n)>=0 && glm::dot(glm::cross(c-b,q-b),n)>=0 && glm::dot(glm::cross(a-c,q-c),n)>=0)
+      return glm::abs(glm::dot(p-a,n));
+    return glm::min(glm::min(segmentDistance(p,a,b),segmentDistance(p,b,c)),segmentDistance(p,c,a));
+  };
+
+  bool lodsOk = mesh.nofLods > 0;
+  uint32_t prevIndices = mesh.nofIndices;
+  float    prevError   = 0.f;
+  float    deviation   = 0.f;
+  for(uint32_t l=0;l<mesh.nofLods;++l){
+    MeshLod const&lod = mesh.lods[l];
+    uint16_t const*lodIndices = (uint16_t const*)lod.indices;
+    lodsOk &= lod.nofIndices < prevIndices && lod.nofIndices%3 == 0 && lod.error >= prevError;
+    lodsOk &= lod.error <= .1f*mesh.boundingSphere.w;
+    for(uint32_t i=0;i<lod.nofIndices;++i)
+      lodsOk &= lodIndices[i] < vertices.size();
+    if(!lodsOk)break;
+
+    // distance of the full mesh vertices from simplified surface
+    deviation = 0.f;
+    for(auto const&p:vertices){
+      float d = 1e10f;
+      for(uint32_t t=0;t<lod.nofIndices;t+=3)
+        d = glm::min(d,triangleDistance(p,vertices[lodIndices[t]],vertices[lodIndices[t+1]],vertices[lodIndices[t+2]]));
+      deviation = glm::max(deviation,d);
+    }
+    lodsOk &= deviation <= lod.error+1e-4f;
+    prevIndices = lod.nofIndices;
+    prevError   = lod.error;
+  }
+
+  if(!lodsOk){
+    std::cerr << R".(
+    Zjednodušené úrovně detailu musí mít postupně méně trojúhelníků,
+    neklesající chybu omezenou maximální chybou a platné indexy.
+    Chyba úrovně musí být alespoň tak velká jako vzdálenost vrcholů
+    původního modelu od zjednodušeného povrchu.
+    Počet úrovní: )."<<mesh.nofLods<<std::endl;
+    std::cerr << "    Vzdálenost od povrchu: "<<deviation<<std::endl;
+    REQUIRE(false);
+  }
+
+  auto mm = ReplaceDrawTriangle();
+
+  model.roots.resize(1);
+  model.roots[0].mesh = 0;
+
+  Scene scene;
+  buildScene(scene,model);
+
+  DrawSettings settings;
+  settings.lodSelection = true;
+  settings.lodErrorThreshold = 1.f;
+  GPUContext ctx;
+  ctx.frame.height = 500;
+  auto proj = glm::perspective(glm::radians(60.f),1.f,.1f,10000.f);
+
+  auto drawFrom = [&](glm::vec3 const&camera){
+    drawnIndices.clear();
+    auto view = glm::lookAt(camera,glm::vec3(10,10,0),glm::vec3(0,1,0));
+    drawScene(ctx,model,scene,proj,view,glm::vec3(1.f),camera,settings);
+    return drawnIndices.size() == 1 ? drawnIndices[0] : 0u;
+  };
+
+  uint32_t const nearIndices = drawFrom(glm::vec3(10,10,1));
+  uint32_t const farIndices  = drawFrom(glm::vec3(10,10,5000));
+  uint64_t const saved       = scene.stats.lodTrianglesSaved;
+
+  if(nearIndices != mesh.nofIndices || farIndices != mesh.lods[mesh.nofLods-1].nofIndices || saved != (mesh.nofIndices-farIndices)/3){
+    std::cerr << R".(
+    Blízký mesh se má vykreslit v plném rozlišení, vzdálený v nejhrubší úrovni detailu.
+    Počet indexů blízko: )."<<nearIndices<<R".(, daleko: )."<<farIndices<<std::endl;
+    REQUIRE(false);
+  }
+}
+
+SCENARIO("44"){
+  std::cerr << "44 - scene - vertex cache, overdraw and vertex fetch optimization" << std::endl;
+
+  // grid with randomly shuffled triangles, small enough for 8-bit indices
+  uint32_t const n = 12;
+  std::vector<glm::vec3>vertices;
+  for(uint32_t y=0;y<n;++y)
+    for(uint32_t x=0;x<n;++x)
+      vertices.push_back(glm::vec3(x,y,.1f*x*y));
+  std::vector<glm::uvec3>triangles;
+  for(uint32_t y=0;y+1<n;++y)
+    for(uint32_t x=0;x+1<n;++x){
+      uint32_t v = y*n+x;
+      triangles.push_back(glm::uvec3(v,v+1,v+n+1));
+      triangles.push_back(glm::uvec3(v,v+n+1,v+n));
+    }
+  std::shuffle(triangles.begin(),triangles.end(),std::mt19937(1));
+  std::vector<uint32_t>original;
+  for(auto const&t:triangles)
+    for(uint32_t i=0;i<3;++i)original.push_back(t[i]);
+
+  // triangles as rotation invariant position triplets
+  auto triangleSet = [](Mesh const&mesh){
+    std::vector<uint32_t>ind = readIndices(mesh);
+    std::vector<std::vector<float>>res;
+    for(size_t t=0;t+2<ind.size();t+=3){
+      glm::vec3 p[3];
+      for(uint32_t i=0;i<3;++i)p[i] = vertexPosition(mesh.position,ind[t+i]);
+      uint32_t first = 0;
+      for(uint32_t i=1;i<3;++i)
+        if(std::lexicographical_compare(&p[i].x,&p[i].x+3,&p[first].x,&p[first].x+3))first = i;
+      std::vector<float>tri;
+      for(uint32_t i=0;i<3;++i)
+        for(uint32_t c=0;c<3;++c)tri.push_back(p[(first+i)%3][c]);
+      res.push_back(tri);
+    }
+    std::sort(res.begin(),res.end());
+    return res;
+  };
+
+  for(IndexType type:{IndexType::UINT8,IndexType::UINT16,IndexType::UINT32}){
+    BufferStorage storage;
+    Mesh mesh;
+    mesh.position.bufferData = vertices.data();
+    mesh.position.stride = sizeof(glm::vec3);
+    mesh.position.type = AttributeType::VEC3;
+    mesh.indexType = type;
+    mesh.indices = storeIndices(storage,original,type);
+    mesh.nofIndices = (uint32_t)original.size();
+    auto const expected = triangleSet(mesh);
+
+    MeshOptimizationStats stats;
+    optimizeMesh(mesh,storage,stats);
+
+    std::vector<uint32_t>ind = readIndices(mesh);
+    bool fetchOrdered = true;
+    uint32_t next = 0;
+    for(uint32_t v:ind){
+      fetchOrdered &= v <= next;
+      if(v == next)next++;
+    }
+
+    if(triangleSet(mesh) != expected || !fetchOrdered || stats.missesAfter >= stats.missesBefore || stats.missesAfter > stats.triangles){
+      std::cerr << R".(
+    Optimalizace musí zachovat trojúhelníky a index type (tady )."<<(uint32_t)type<<R".(B),
+    snížit ACMR a vrcholy přečíslovat v pořadí prvního použití.
+    ACMR před: )."<<(float)stats.missesBefore/stats.triangles<<R".(, po: )."<<(float)stats.missesAfter/stats.triangles<<std::endl;
+      REQUIRE(false);
+    }
+  }
+}
+
+SCENARIO("45"){
+  std::cerr << "45 - scene - meshlets and per meshlet culling" << std::endl;
+
+  // uv sphere with normals, so that lighting and depth test produce detailed image
+  uint32_t const rings = 20,segments = 40;
+  std::vector<glm::vec3>vertices;
+  std::vector<uint32_t >indices;
+  for(uint32_t r=0;r<=rings;++r)
+    for(uint32_t s=0;s<=segments;++s){
+      float theta = glm::pi<float>()*r/rings,phi = 2.f*glm::pi<float>()*s/segments;
+      vertices.push_back(glm::vec3(glm::sin(theta)*glm::cos(phi),glm::cos(theta),glm::sin(theta)*glm::sin(phi)));
+    }
+  for(uint32_t r=0;r<rings;++r)
+    for(uint32_t s=0;s<segments;++s){
+      uint32_t v = r*(segments+1)+s,w = v+segments+1;
+      // triangles touching poles would be degenerate
+      if(r > 0      )for(uint32_t i:{v,v+1,w})indices.push_back(i);
+      if(r+1 < rings)for(uint32_t i:{v+1,w+1,w})indices.push_back(i);
+    }
+
+  Model model;
+  model.meshes.resize(1);
+  Mesh&mesh = model.meshes[0];
+  mesh.nofIndices = (uint32_t)indices.size();
+  mesh.indices = indices.data();
+  mesh.indexType = IndexType::UINT32;
+  mesh.position.bufferData = vertices.data();
+  mesh.position.stride = sizeof(glm::vec3);
+  mesh.position.type = AttributeType::VEC3;
+  mesh.normal = mesh.position;
+  computeMeshBounds(mesh);
+
+  BufferStorage storage;
+  buildMeshMeshlets(mesh,storage);
+
+  bool meshletsOk = mesh.nofMeshlets > 0;
+  uint32_t nextIndex = 0;
+  for(uint32_t m=0;m<mesh.nofMeshlets;++m){
+    Meshlet const&meshlet = mesh.meshlets[m];
+    meshletsOk &= meshlet.firstIndex == nextIndex;
+    meshletsOk &= meshlet.nofIndices/3 <= maxMeshletTriangles && meshlet.nofVertices <= maxMeshletVertices;
+    nextIndex += meshlet.nofIndices;
+  }
+  meshletsOk &= nextIndex == indices.size();
+
+  if(!meshletsOk){
+    std::cerr << R".(
+    Meshlety musí pokrývat celý index buffer za sebou a dodržet limity
+    )."<<maxMeshletVertices<<R".( vrcholů a )."<<maxMeshletTriangles<<R".( trojúhelníků.)."<<std::endl;
+    REQUIRE(false);
+  }
+
+  model.roots.resize(1);
+  model.roots[0].mesh = 0;
+  model.roots[0].modelMatrix = glm::scale(glm::mat4(1.f),glm::vec3(2.f,1.f,1.5f));
+
+  Scene scene;
+  buildScene(scene,model);
+
+  uint32_t const size = 100;
+  auto proj = glm::perspective(glm::radians(60.f),1.f,.1f,100.f);
+  auto render = [&](glm::vec3 const&camera,DrawSettings const&settings){
+    std::vector<uint8_t>color(size*size*4);
+    std::vector<float  >depth(size*size);
+    GPUContext ctx;
+    ctx.frame.color  = color.data();
+    ctx.frame.depth  = depth.data();
+    ctx.frame.width  = size;
+    ctx.frame.height = size;
+    clear(ctx,0,0,0,0);
+    auto view = glm::lookAt(camera,glm::vec3(.5f,.2f,0),glm::vec3(0,1,0));
+    drawScene(ctx,model,scene,proj,view,glm::vec3(10.f),camera,settings);
+    return color;
+  };
+
+  // rasterizer fills triangles smaller than a pixel regardless of their winding,
+  // so skipping back facing meshlets may remove a few such pixels
+  DrawSettings meshletSettings;
+  meshletSettings.meshletCulling = true;
+  for(glm::vec3 camera:{glm::vec3(0,0,5),glm::vec3(3,1,2),glm::vec3(.5f,.3f,1.8f),glm::vec3(0,60,1)}){
+    auto expected = render(camera,DrawSettings{});
+    auto image    = render(camera,meshletSettings);
+    uint32_t differentPixels = 0;
+    for(size_t i=0;i<image.size();i+=4)
+      differentPixels += memcmp(&image[i],&expected[i],4) != 0;
+    if(differentPixels*100 > size*size || scene.stats.culledMeshlets == 0){
+      std::cerr << R".(
+    Ořezání meshletů nesmí viditelně změnit obraz a mělo by přeskočit meshlety odvrácené od kamery.
+    Kamera: )."<<camera.x<<" "<<camera.y<<" "<<camera.z<<R".(, přeskočené meshlety: )."<<scene.stats.culledMeshlets
+              <<R".(, rozdílné pixely: )."<<differentPixels<<std::endl;
+      REQUIRE(false);
+    }
+  }
+}
@@ -0,0 +1,452 @@
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <framework/framebuffer.hpp>
+#include <framework/perfCounters.hpp>
+#include <framework/surface.hpp>
+#include <framework/timer.hpp>
+#include <student/gpu.hpp>
+#include <student/gpuStages.hpp>
+#include <student/textureCompression.hpp>
+
+namespace stageBenchmark{
+
+volatile float sink     = 0.f;///< results of benchmarked functions that would be optimized out otherwise
+size_t         fragments = 0 ;///< number of fragment shader invocations
+
+std::string filter;///< only stages that contain this string are run
+
+std::unique_ptr<PerfCounters>counters;///< hardware counters of measured runs, nullptr if they are not requested or available
+
+void passThroughVS(OutVertex&out,InVertex const&in,Uniforms const&){
+  out.gl_Position = in.attributes[0].v4;
+  for(uint32_t i=1;i<4;++i)out.attributes[i] = in.attributes[i];
+}
+
+void constantFS(OutFragment&out,InFragment const&,Uniforms const&){
+  out.gl_FragColor = glm::vec4(1.f,.5f,.25f,1.f);
+  ++fragments;
+}
+
+/**
+ * @brief This function measures workload and prints its throughput.
+ * Workload is repeated until it takes at least quarter of second, the fastest run is reported.
+ * Hardware counters are averaged over all repeated runs and divided by primitives (or pixels if stage works on pixels).
+ *
+ * @param stage benchmarked stage
+ * @param workload description of workload
+ * @param primitives number of triangles processed by one run, 0 if stage works on pixels
+ * @param pixels number of pixels processed by one run
+ * @param run one run of workload
+ */
+void measure(std::string const&stage,std::string const&workload,size_t primitives,size_t pixels,std::function<void()>const&run){
+  if(stage.find(filter) == std::string::npos)return;
+  run();
+  Timer<double>total;
+  Timer<double>timer;
+  double best = 1e30;
+  uint32_t runs = 0;
+  if(counters)counters->start();
+  do{
+    timer.reset();
+    run();
+    best = std::min(best,timer.elapsedFromStart());
+    ++runs;
+  }while(total.elapsedFromStart() < .25 && runs < 1000);
+  PerfCounterValues const events = counters ? counters->stop() : PerfCounterValues{};
+
+  auto const rate = [&](size_t n){
+    if(!n)return std::string("-");
+    double const perSecond = (double)n/best;
+    char const*const units[] = {"","K","M","G"};
+    uint32_t unit = 0;
+    double value = perSecond;
+    while(value >= 1000. && unit < 3){value /= 1000.;++unit;}
+    std::ostringstream ss;
+    ss << std::fixed << std::setprecision(2) << value << units[unit];
+    return ss.str();
+  };
+  std::cout << std::left  << std::setw(14) << stage << std::setw(32) << workload
+            << std::right << std::fixed << std::setprecision(3) << std::setw(11) << best*1000. << " ms"
+            << std::setw(12) << rate(primitives) << std::setw(12) << rate(pixels);
+  if(counters){
+    double const items = (double)runs*(double)(primitives ? primitives : pixels);
+    auto const perItem = [&](PerfEvent e,int precision){
+      std::ostringstream ss;
+      if(events.has(e) && items > 0.)ss << std::fixed << std::setprecision(precision) << events.get(e)/items;
+      else ss << "-";
+      return ss.str();
+    };
+    std::ostringstream ipc;
+    if(events.has(PerfEvent::INSTRUCTIONS) && events.has(PerfEvent::CYCLES) && events.get(PerfEvent::CYCLES) > 0.)
+      ipc << std::fixed << std::setprecision(2) << events.get(PerfEvent::INSTRUCTIONS)/events.get(PerfEvent::CYCLES);
+    else ipc << "-";
+    std::cout << std::setw(7) << ipc.str() << std::setw(11) << perItem(PerfEvent::INSTRUCTIONS,1)
+              << std::setw(11) << perItem(PerfEvent::CACHE_MISSES,4) << std::setw(11) << perItem(PerfEvent::BRANCH_MISSES,4);
+  }
+  std::cout << std::endl;
+}
+
+/**
+ * @brief This function returns clip space triangles that cover one pixel each.
+ *
+ * @param width width of frame
+ * @param height height of frame
+ *
+ * @return vertices of triangles, one triangle per pixel
+ */
+std::vector<glm::vec4>tinyTriangles(uint32_t width,uint32_t height){
+  std::vector<glm::vec4>res;
+  res.reserve((size_t)width*height*3);
+  auto const ndc = [&](float x,float y){return glm::vec4(x/width*2.f-1.f,y/height*2.f-1.f,.5f,1.f);};
+  for(uint32_t y=0;y<height;++y)
+    for(uint32_t x=0;x<width;++x){
+      res.push_back(ndc(x    ,y    ));
+      res.push_back(ndc(x+1.f,y    ));
+      res.push_back(ndc(x    ,y+1.f));
+    }
+  return res;
+}
+
+/**
+ * @brief This function returns clip space triangles of the same size spread over the frame.
+ *
+ * @param count number of triangles
+ * @param size length of triangle legs in pixels
+ * @param width width of frame
+ * @param height height of frame
+ *
+ * @return vertices of triangles
+ */
+std::vector<glm::vec4>squareTriangles(size_t count,float size,uint32_t width,uint32_t height){
+  std::vector<glm::vec4>res;
+  res.reserve(count*3);
+  std::mt19937 rng(42);
+  std::uniform_real_distribution<float>px(0.f,std::max((float)width -size,0.f));
+  std::uniform_real_distribution<float>py(0.f,std::max((float)height-size,0.f));
+  auto const ndc = [&](float x,float y,float z){return glm::vec4(x/width*2.f-1.f,y/height*2.f-1.f,z,1.f);};
+  for(size_t i=0;i<count;++i){
+    float const x = std::floor(px(rng)),y = std::floor(py(rng)),z = 1.f-(float)i/(float)count;
+    res.push_back(ndc(x     ,y     ,z));
+    res.push_back(ndc(x+size,y     ,z));
+    res.push_back(ndc(x     ,y+size,z));
+  }
+  return res;
+}
+
+/**
+ * @brief This function returns triangles that cover whole frame with decreasing depth, every fragment passes depth test.
+ *
+ * @param count number of triangles
+ *
+ * @return vertices of triangles
+ */
+std::vector<glm::vec4>fullScreenTriangles(size_t count){
+  std::vector<glm::vec4>res;
+  for(size_t i=0;i<count;++i){
+    float const z = 1.f-(float)i/(float)count;
+    res.push_back(glm::vec4(-1.f,-1.f,z,1.f));
+    res.push_back(glm::vec4(+3.f,-1.f,z,1.f));
+    res.push_back(glm::vec4(-1.f,+3.f,z,1.f));
+  }
+  return res;
+}
+
+std::vector<Triangle>toTriangles(std::vector<glm::vec4>const&vertices){
+  std::vector<Triangle>res(vertices.size()/3);
+  for(size_t i=0;i<res.size();++i)
+    for(int k=0;k<3;++k)
+      res[i].points[k].gl_Position = vertices[i*3+k];
+  return res;
+}
+
+void benchmarkVertexPulling(){
+  size_t const nofVertices = 3u<<20;
+  std::vector<float>buffer(nofVertices*4);
+  for(size_t i=0;i<buffer.size();++i)buffer[i] = (float)i;
+  // the same 256 vertices are referenced by every index type, so only decoding of indices differs
+  std::vector<uint32_t>indices32(nofVertices);
+  for(size_t i=0;i<nofVertices;++i)indices32[i] = (uint32_t)((i*97)&255);
+  std::vector<uint16_t>indices16(indices32.begin(),indices32.end());
+  std::vector<uint8_t >indices8 (indices32.begin(),indices32.end());
+
+  char const*const attribNames[] = {"","float","vec2","vec3","vec4"};
+  struct{char const*name;void const*data;IndexType type;}const indexings[] = {
+    {"no indices",nullptr         ,IndexType::UINT32},
+    {"uint8"     ,indices8 .data(),IndexType::UINT8 },
+    {"uint16"    ,indices16.data(),IndexType::UINT16},
+    {"uint32"    ,indices32.data(),IndexType::UINT32},
+  };
+  for(uint32_t a=1;a<=4;++a)
+    for(auto const&indexing:indexings){
+      VertexArray vao;
+      vao.vertexAttrib[0].bufferData = buffer.data();
+      vao.vertexAttrib[0].stride     = sizeof(float)*4;
+      vao.vertexAttrib[0].type       = (AttributeType)a;
+      vao.indexBuffer = indexing.data;
+      vao.indexType   = indexing.type;
+      measure("pull",std::string(attribNames[a])+", "+indexing.name,nofVertices/3,0,[&]{
+        InVertex vertex;
+        float sum = 0.f;
+        for(uint32_t i=0;i<nofVertices;++i){
+          vertex.gl_VertexID = computeVertexID(vao,i);
+          vertexPuller(vao,vertex);
+          sum += vertex.attributes[0].v1;
+        }
+        sink = sum;
+      });
+    }
+}
+
+void benchmarkClipping(){
+  size_t const count = 1u<<20;
+  std::mt19937 rng(7);
+  std::uniform_real_distribution<float>d(-1.f,1.f);
+  struct{char const*name;float zOffset;}const cases[] = {
+    {"all inside"   ,0.f },
+    {"crossing near",-.8f},
+    {"all outside"  ,-3.f},
+  };
+  for(auto const&c:cases){
+    std::vector<Triangle>triangles(count);
+    for(auto&t:triangles)
+      for(auto&p:t.points)p.gl_Position = glm::vec4(d(rng),d(rng),d(rng)+c.zOffset,1.f);
+    measure("clip",c.name,count,0,[&]{
+      Triangle second;
+      uint32_t kept = 0;
+      for(auto&t:triangles)kept += nearPlaneClipping(t,second);
+      sink = (float)kept;
+    });
+  }
+}
+
+void benchmarkSetup(){
+  auto const source = toTriangles(squareTriangles(1u<<20,8.f,1920,1080));
+  std::vector<Triangle>triangles(source.size());
+  measure("setup","divide + viewport",triangles.size(),0,[&]{
+    std::memcpy((void*)triangles.data(),source.data(),source.size()*sizeof(Triangle));
+    for(auto&t:triangles){
+      perspectiveDivision(t);
+      viewportTransformation(t,1920,1080);
+    }
+    sink = triangles.back().points[0].gl_Position.x;
+  });
+}
+
+void benchmarkCoverage(){
+  uint32_t const width = 1024,height = 1024;
+  Framebuffer framebuffer(width,height);
+  GPUContext ctx;
+  ctx.frame = framebuffer.getFrame();
+  ctx.prg.fragmentShader = constantFS;
+
+  struct{char const*name;std::vector<glm::vec4>vertices;}const cases[] = {
+    {"1M 1-pixel triangles"    ,tinyTriangles(width,height)                  },
+    {"16K 32x32 triangles"     ,squareTriangles(1u<<14,32.f,width,height)    },
+    {"100 full-screen triangles",fullScreenTriangles(100)                     },
+  };
+  for(auto const&c:cases){
+    auto triangles = toTriangles(c.vertices);
+    for(auto&t:triangles){
+      perspectiveDivision(t);
+      viewportTransformation(t,width,height);
+    }
+    fragments = 0;
+    clear(ctx,0.f,0.f,0.f,1.f);
+    for(auto&t:triangles)rasterize(ctx,t);
+    size_t const covered = fragments;
+    measure("coverage",c.name,triangles.size(),covered,[&]{
+      clear(ctx,0.f,0.f,0.f,1.f);
+      for(auto&t:triangles)rasterize(ctx,t);
+    });
+  }
+}
+
+void benchmarkInterpolation(){
+  size_t const count = 1u<<20;
+  Triangle triangle;
+  triangle.points[0].gl_Position = glm::vec4(   0.f,   0.f,.2f,1.f);
+  triangle.points[1].gl_Position = glm::vec4(1024.f,   0.f,.5f,2.f);
+  triangle.points[2].gl_Position = glm::vec4(   0.f,1024.f,.8f,4.f);
+  for(uint32_t a : {0u,1u,4u,16u}){
+    Program prg;
+    for(uint32_t i=0;i<maxAttributes;++i)prg.vs2fs[i] = i < a ? AttributeType::VEC4 : AttributeType::EMPTY;
+    measure("interpolate",std::to_string(a)+" vec4 attributes",0,count,[&]{
+      InFragment fragment;
+      float sum = 0.f;
+      for(size_t i=0;i<count;++i){
+        fragment.gl_FragCoord = glm::vec4((float)(i&511)+.5f,(float)((i>>9)&511)+.5f,0.f,1.f);
+        getBarCords(triangle,fragment);
+        getPerspectiveBarAttrs(triangle,fragment,prg);
+        sum += fragment.gl_FragCoord.z;
+      }
+      sink = sum;
+    });
+  }
+}
+
+void benchmarkTextures(){
+  uint32_t const size = 1024;
+  size_t const samples = 1u<<20;
+  std::vector<uint8_t>rgba((size_t)size*size*4);
+  for(size_t i=0;i<rgba.size();++i)rgba[i] = (uint8_t)((i*31)^(i>>12));
+  std::vector<uint8_t>rgb((size_t)size*size*3);
+  for(size_t i=0;i<(size_t)size*size;++i)std::memcpy(rgb.data()+i*3,rgba.data()+i*4,3);
+  auto const bc1 = compressTexture(rgb .data(),size,size,3,TextureFormat::BC1);
+  auto const bc3 = compressTexture(rgba.data(),size,size,4,TextureFormat::BC3);
+
+  struct{char const*name;uint8_t const*data;uint32_t channels;TextureFormat format;}const textures[] = {
+    {"raw rgb" ,rgb .data(),3,TextureFormat::RAW},
+    {"raw rgba",rgba.data(),4,TextureFormat::RAW},
+    {"bc1"     ,bc1 .data(),3,TextureFormat::BC1},
+    {"bc3"     ,bc3 .data(),4,TextureFormat::BC3},
+  };
+  std::vector<glm::vec2>coherent(samples),random(samples);
+  std::mt19937 rng(3);
+  std::uniform_real_distribution<float>d(0.f,1.f);
+  for(size_t i=0;i<samples;++i){
+    coherent[i] = glm::vec2((float)(i%size)+.5f,(float)(i/size)+.5f)/(float)size;
+    random  [i] = glm::vec2(d(rng),d(rng));
+  }
+  for(auto const&t:textures){
+    Texture texture;
+    texture.data     = t.data;
+    texture.width    = size;
+    texture.height   = size;
+    texture.channels = t.channels;
+    texture.format   = t.format;
+    for(auto const*uvs:{&coherent,&random})
+      measure("read_texture",std::string(t.name)+(uvs == &coherent ? ", scanline" : ", random"),0,samples,[&]{
+        float sum = 0.f;
+        for(auto const&uv:*uvs)sum += read_texture(texture,uv).r;
+        sink = sum;
+      });
+  }
+}
+
+void benchmarkPerFragment(){
+  uint32_t const width = 1920,height = 1080;
+  Framebuffer framebuffer(width,height);
+  GPUContext ctx;
+  ctx.frame = framebuffer.getFrame();
+  for(float alpha : {1.f,.5f}){
+    OutFragment out;
+    out.gl_FragColor = glm::vec4(.2f,.4f,.6f,alpha);
+    measure("perFragment",alpha == 1.f ? "1080p opaque" : "1080p blended",0,(size_t)width*height,[&]{
+      clear(ctx,0.f,0.f,0.f,1.f);
+      InFragment in;
+      in.gl_FragCoord.z = .5f;
+      for(uint32_t y=0;y<height;++y)
+        for(uint32_t x=0;x<width;++x){
+          in.gl_FragCoord.x = x+.5f;
+          in.gl_FragCoord.y = y+.5f;
+          perFragOperation(ctx.frame,in,out);
+        }
+    });
+  }
+}
+
+void benchmarkClear(){
+  for(auto const&size : {glm::uvec2(1920,1080),glm::uvec2(3840,2160)}){
+    Framebuffer framebuffer(size.x,size.y);
+    GPUContext ctx;
+    ctx.frame = framebuffer.getFrame();
+    measure("clear",std::to_string(size.x)+"x"+std::to_string(size.y),0,(size_t)size.x*size.y,[&]{
+      clear(ctx,.1f,.2f,.3f,1.f);
+    });
+  }
+}
+
+void benchmarkSurfaceCopy(){
+  uint32_t const width = 1920,height = 1080;
+  std::vector<uint8_t>color((size_t)width*height*4);
+  for(size_t i=0;i<color.size();++i)color[i] = (uint8_t)i;
+  ThreadPool pool;
+  struct{char const*name;uint32_t format;}const formats[] = {
+    {"xrgb8888",SDL_PIXELFORMAT_RGB888},
+    {"rgb24"   ,SDL_PIXELFORMAT_RGB24 },
+  };
+  for(auto const&f:formats){
+    SDL_Surface*surface = SDL_CreateRGBSurfaceWithFormat(0,width,height,SDL_BITSPERPIXEL(f.format),f.format);
+    if(!surface)continue;
+    measure("surface",std::string("1080p ")+f.name+", 1 thread",0,(size_t)width*height,[&]{
+      copyToSDLSurface(surface,color.data(),width,height);
+    });
+    if(pool.size() > 1)measure("surface",std::string("1080p ")+f.name+", "+std::to_string(pool.size())+" threads",0,(size_t)width*height,[&]{
+      copyToSDLSurface(surface,color.data(),width,height,&pool);
+    });
+    SDL_FreeSurface(surface);
+  }
+}
+
+void benchmarkDrawTriangles(){
+  uint32_t const width = 1024,height = 1024;
+  Framebuffer framebuffer(width,height);
+  struct{char const*name;std::vector<glm::vec4>vertices;}const cases[] = {
+    {"1M 1-pixel triangles"     ,tinyTriangles(width,height)},
+    {"100 full-screen triangles",fullScreenTriangles(100)   },
+  };
+  for(auto const&c:cases){
+    GPUContext ctx;
+    ctx.frame = framebuffer.getFrame();
+    ctx.prg.vertexShader   = passThroughVS;
+    ctx.prg.fragmentShader = constantFS;
+    ctx.vao.vertexAttrib[0].bufferData = c.vertices.data();
+    ctx.vao.vertexAttrib[0].stride     = sizeof(glm::vec4);
+    ctx.vao.vertexAttrib[0].type       = AttributeType::VEC4;
+    fragments = 0;
+    clear(ctx,0.f,0.f,0.f,1.f);
+    drawTriangles(ctx,(uint32_t)c.vertices.size());
+    size_t const covered = fragments;
+    measure("drawTriangles",c.name,c.vertices.size()/3,covered,[&]{
+      clear(ctx,0.f,0.f,0.f,1.f);
+      drawTriangles(ctx,(uint32_t)c.vertices.size());
+    });
+  }
+}
+
+}
+
+using namespace stageBenchmark;
+
+/**
+ * @brief Stage micro-benchmarks, every stage of rendering is measured on generated workload.
+ * Optional argument selects stages that contain it (e.g. "coverage"),
+ * --perf-counters adds IPC and instructions, cache misses and branch misses per primitive (or pixel).
+ */
+int main(int argc,char*argv[]){
+  for(int i=1;i<argc;++i){
+    if(std::string(argv[i]) == "--perf-counters")counters = std::make_unique<PerfCounters>();
+    else filter = argv[i];
+  }
+  if(counters && !counters->available()){
+    std::cout << "hardware counters are not available (" << counters->getError() << "), only times are measured" << std::endl;
+    counters = nullptr;
+  }else if(counters && !counters->getError().empty()){
+    std::cout << "some hardware counters are not available (" << counters->getError() << ")" << std::endl;
+  }
+  std::cout << std::left  << std::setw(14) << "stage" << std::setw(32) << "workload"
+            << std::right << std::setw(14) << "best time" << std::setw(12) << "prims/s" << std::setw(12) << "pixels/s";
+  if(counters)
+    std::cout << std::setw(7) << "IPC" << std::setw(11) << "instr/item" << std::setw(11) << "LLC miss" << std::setw(11) << "br miss";
+  std::cout << std::endl;
+  benchmarkVertexPulling();
+  benchmarkClipping();
+  benchmarkSetup();
+  benchmarkCoverage();
+  benchmarkInterpolation();
+  benchmarkTextures();
+  benchmarkPerFragment();
+  benchmarkClear();
+  benchmarkSurfaceCopy();
+  benchmarkDrawTriangles();
+  return 0;
+}
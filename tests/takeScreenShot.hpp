@@ -2,5 +2,9 @@
 
 #include <iostream>
 
-void takeScreenShot(std::string const&file,std::string const&modelFile);
+#include <framework/imageWriter.hpp>
+#include <framework/model.hpp>
+#include <student/drawModel.hpp>
+
+void takeScreenShot(std::string const&file,std::string const&modelFile,DrawSettings const&drawSettings = DrawSettings{},ModelLoadOptions const&loadOptions = ModelLoadOptions{},ImageWriterOptions const&imageOptions = ImageWriterOptions{});
 